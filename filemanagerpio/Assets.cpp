@@ -0,0 +1,193 @@
+#include "Global.h"
+
+// ============ STATIC ASSETS ============
+// The web UI (filemanager.html, app.js, style.css, login.html) used to be
+// read from LittleFS on every page load with no validator, after an exists()
+// and a chain of endsWith() for its content type. At boot every file with a
+// web extension is read once and gets a strong ETag from its CRC-32 and
+// length; browsers revalidate and mostly get a 304 back.
+//
+// A "<file>.gz" next to a file is sent to clients that accept gzip, but only
+// when its trailer (CRC-32 and length of what it inflates to) matches the
+// file: a .gz left behind after the file was changed is ignored. Build them
+// with `gzip -9 -n -k` from the littlefs/ directory before uploading it.
+//
+// The manifest is changed only by uploads and deletes, which run on the
+// async_tcp task like every request that reads it.
+
+struct AssetType {
+  const char *extension;
+  const char *contentType;
+};
+
+static const AssetType ASSET_TYPES[] = {
+    {".html", "text/html"},
+    {".css", "text/css"},
+    {".js", "application/javascript"},
+    {".png", "image/png"},
+    {".jpg", "image/jpeg"},
+    {".jpeg", "image/jpeg"},
+    {".gif", "image/gif"},
+    {".svg", "image/svg+xml"},
+    {".ico", "image/x-icon"},
+};
+
+static Asset assets[ASSET_MAX];
+static int assetCount = 0;
+
+static const char *ContentType(const char *path) {
+  size_t len = strlen(path);
+  for (const AssetType &type : ASSET_TYPES) {
+    size_t ext = strlen(type.extension);
+    if (len > ext && strcasecmp(path + len - ext, type.extension) == 0)
+      return type.contentType;
+  }
+  return nullptr;
+}
+
+// CRC-32 as in gzip (reflected, 0xEDB88320), a nibble at a time
+static uint32_t Crc32(uint32_t crc, const uint8_t *data, size_t len) {
+  static const uint32_t TABLE[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+      0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ TABLE[crc & 15];
+    crc = (crc >> 4) ^ TABLE[crc & 15];
+  }
+  return ~crc;
+}
+
+static bool Checksum(const char *path, uint32_t &crc, uint32_t &size) {
+  File file = LittleFS.open(path, "r");
+  if (!file || file.isDirectory())
+    return false;
+  uint8_t buffer[512];
+  crc = 0;
+  size = 0;
+  int n;
+  while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+    crc = Crc32(crc, buffer, n);
+    size += n;
+  }
+  file.close();
+  return true;
+}
+
+// CRC-32 and length (mod 2^32) of what a gzip file inflates to
+static bool GzipTrailer(const char *path, uint32_t &crc, uint32_t &length,
+                        uint32_t &size) {
+  if (!LittleFS.exists(path))
+    return false;
+  File file = LittleFS.open(path, "r");
+  if (!file)
+    return false;
+  size = file.size();
+  uint8_t magic[2];
+  uint8_t trailer[8];
+  bool ok = size >= 18 && file.read(magic, 2) == 2 && magic[0] == 0x1F &&
+            magic[1] == 0x8B && file.seek(size - 8) &&
+            file.read(trailer, 8) == 8;
+  file.close();
+  if (!ok)
+    return false;
+  crc = trailer[0] | trailer[1] << 8 | trailer[2] << 16 |
+        (uint32_t)trailer[3] << 24;
+  length = trailer[4] | trailer[5] << 8 | trailer[6] << 16 |
+           (uint32_t)trailer[7] << 24;
+  return true;
+}
+
+static bool Load(Asset &asset, const char *path) {
+  const char *type = ContentType(path);
+  uint32_t crc, size;
+  if (!type || strlen(path) >= ASSET_PATH_MAX || !Checksum(path, crc, size))
+    return false;
+  asset = {};
+  strcpy(asset.path, path);
+  asset.contentType = type;
+  asset.size = size;
+  snprintf(asset.etag, sizeof(asset.etag), "\"%08lx-%lx\"",
+           (unsigned long)crc, (unsigned long)size);
+
+  char gzPath[ASSET_PATH_MAX + 3];
+  snprintf(gzPath, sizeof(gzPath), "%s.gz", path);
+  uint32_t gzCrc, gzLength, gzSize;
+  if (!GzipTrailer(gzPath, gzCrc, gzLength, gzSize))
+    return true;
+  if (gzCrc != crc || gzLength != size) {
+    Serial.printf("⚠️ %s does not match %s, sent uncompressed\n", gzPath,
+                  path);
+    return true;
+  }
+  asset.gzSize = gzSize;
+  snprintf(asset.gzEtag, sizeof(asset.gzEtag), "\"%08lx-%lx-gz%lx\"",
+           (unsigned long)crc, (unsigned long)size, (unsigned long)gzSize);
+  return true;
+}
+
+static int IndexOf(const char *path) {
+  for (int i = 0; i < assetCount; i++)
+    if (strcmp(assets[i].path, path) == 0)
+      return i;
+  return -1;
+}
+
+int Assets_Init() {
+  assetCount = 0;
+  File root = LittleFS.open("/");
+  if (!root) {
+    Serial.println("❌ Assets: cannot list LittleFS");
+    return 0;
+  }
+  int compressed = 0;
+  for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+    if (file.isDirectory())
+      continue;
+    char path[ASSET_PATH_MAX + 1];
+    const char *name = file.name();
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+    file.close();
+    if (!ContentType(path))
+      continue; // settings, logs, the .gz variants
+    if (assetCount >= ASSET_MAX) {
+      Serial.printf("⚠️ Assets: more than %d, %s not cached\n", ASSET_MAX,
+                    path);
+      break;
+    }
+    if (Load(assets[assetCount], path)) {
+      if (assets[assetCount].gzSize)
+        compressed++;
+      assetCount++;
+    }
+  }
+  Serial.printf("🗂️ %d web assets, %d with gzip\n", assetCount, compressed);
+  return assetCount;
+}
+
+const Asset *Assets_Find(const char *path) {
+  int index = IndexOf(path);
+  return index >= 0 ? &assets[index] : nullptr;
+}
+
+void Assets_Refresh(const char *path) {
+  // "/app.js.gz" changes what "/app.js" sends
+  char base[ASSET_PATH_MAX + 3];
+  snprintf(base, sizeof(base), "%s", path);
+  size_t len = strlen(base);
+  if (len > 3 && strcmp(base + len - 3, ".gz") == 0)
+    base[len - 3] = '\0';
+
+  int index = IndexOf(base);
+  Asset asset;
+  if (Load(asset, base)) {
+    if (index < 0 && assetCount < ASSET_MAX)
+      index = assetCount++;
+    if (index >= 0)
+      assets[index] = asset;
+  } else if (index >= 0) {
+    assets[index] = assets[--assetCount];
+  }
+}
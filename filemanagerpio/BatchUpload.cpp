@@ -0,0 +1,400 @@
+#include "Global.h"
+
+// ============ MULTI-LOCATION BATCH UPLOAD ============
+// Changed fields of many flights go out as one PATCH at /flights/Islamabad
+// whose keys are full child paths:
+//
+//   {"Departure/2601310810_PK300/bre1":"Boarding",
+//    "Departure/2601310810_PK300/ckco":{"12":["Open",""]}, ...}
+//
+// The RTDB applies each path as its own field-level update, so flights keep
+// exactly the merge behaviour of one PATCH per flight (ckco is replaced as a
+// whole, as before). The payload is written straight from the flight store
+// into one preallocated buffer - no JsonDocument, no growing String - and is
+// cut into chunks of at most Batch_GetBudget() bytes. Chunks are submitted
+// into the RTDB write window without waiting; the snapshot is committed for a
+// chunk's flights when its result comes back.
+//
+// Runs on the uploader task. Batch_Add() reads the flight store, so callers
+// hold FlightStore_Lock() around it; this file takes the lock itself where it
+// reads flights later on.
+
+struct PendingFlight {
+  int16_t rec;
+  FieldMask fields;
+};
+
+// Where the JSON writers below append; the batch buffer, or a caller's
+// buffer in Batch_FormatValue()
+struct JsonOut {
+  char *data;
+  size_t used;
+  size_t limit;
+  bool overflow;
+};
+
+static char *buffer = nullptr;
+static JsonOut out = {};
+static size_t budget = BATCH_DEFAULT_BUDGET;
+static PendingFlight pending[BATCH_MAX_FLIGHTS];
+static int pendingCount = 0;
+static int pendingPaths = 0; // Batch_AddPath() entries, no flight behind them
+
+// Chunks on the wire, by write window slot
+struct ChunkInFlight {
+  PendingFlight flights[BATCH_MAX_FLIGHTS];
+  int count;
+  bool active;
+};
+static ChunkInFlight inFlight[RTDB_MAX_WINDOW];
+static int flightsWritten = 0;
+static int chunksFailed = 0;
+static int lastChunksFailed = 0;
+
+bool Batch_Init() {
+  if (buffer)
+    return true;
+  buffer = (char *)ps_malloc(BATCH_BUFFER_BYTES);
+  if (!buffer)
+    buffer = (char *)malloc(BATCH_BUFFER_BYTES);
+  if (!buffer) {
+    Serial.printf("❌ Batch upload: cannot allocate %d bytes\n",
+                  BATCH_BUFFER_BYTES);
+    return false;
+  }
+  out.data = buffer;
+  out.used = 0;
+  return true;
+}
+
+void Batch_SetBudget(size_t bytes) {
+  budget = min(max(bytes, (size_t)BATCH_MIN_BUDGET),
+               (size_t)BATCH_BUFFER_BYTES);
+}
+
+size_t Batch_GetBudget() { return budget; }
+
+int Batch_Pending() { return pendingCount + pendingPaths; }
+
+static void Put(JsonOut &o, const char *text, size_t len) {
+  if (o.overflow || o.used + len > o.limit) {
+    o.overflow = true;
+    return;
+  }
+  memcpy(o.data + o.used, text, len);
+  o.used += len;
+}
+
+static void PutText(JsonOut &o, const char *text) {
+  Put(o, text, strlen(text));
+}
+
+// JSON string with the same escapes ArduinoJson's serializer uses
+static void PutString(JsonOut &o, const char *text) {
+  Put(o, "\"", 1);
+  const char *run = text;
+  for (const char *p = text; *p; p++) {
+    const char *escape = nullptr;
+    char unicode[7];
+    switch (*p) {
+    case '"':
+      escape = "\\\"";
+      break;
+    case '\\':
+      escape = "\\\\";
+      break;
+    case '\b':
+      escape = "\\b";
+      break;
+    case '\f':
+      escape = "\\f";
+      break;
+    case '\n':
+      escape = "\\n";
+      break;
+    case '\r':
+      escape = "\\r";
+      break;
+    case '\t':
+      escape = "\\t";
+      break;
+    default:
+      if ((uint8_t)*p < 0x20) {
+        snprintf(unicode, sizeof(unicode), "\\u%04x", (uint8_t)*p);
+        escape = unicode;
+      }
+    }
+    if (!escape)
+      continue;
+    Put(o, run, p - run);
+    PutText(o, escape);
+    run = p + 1;
+  }
+  PutText(o, run);
+  Put(o, "\"", 1);
+}
+
+static bool SameCounter(const CounterEntry *a, const CounterEntry *b) {
+  return a->counter == b->counter ||
+         strcmp(FlightStore_Text(a->counter), FlightStore_Text(b->counter)) ==
+             0;
+}
+
+// {"<counter>":[crem,crem_lu,...]}, counters in first-seen order
+static void PutCounters(JsonOut &o, const FlightRecord &flight) {
+  Put(o, "{", 1);
+  bool first = true;
+  for (const CounterEntry *entry = FlightStore_GetCounter(flight.ckcoHead);
+       entry; entry = FlightStore_GetCounter(entry->next)) {
+    // Repeated counters were already written with the first one
+    bool seen = false;
+    for (const CounterEntry *prior = FlightStore_GetCounter(flight.ckcoHead);
+         prior != entry; prior = FlightStore_GetCounter(prior->next)) {
+      if (SameCounter(prior, entry)) {
+        seen = true;
+        break;
+      }
+    }
+    if (seen)
+      continue;
+
+    if (!first)
+      Put(o, ",", 1);
+    first = false;
+    PutString(o, FlightStore_Text(entry->counter));
+    Put(o, ":[", 2);
+    bool firstRemark = true;
+    for (const CounterEntry *same = entry; same;
+         same = FlightStore_GetCounter(same->next)) {
+      if (!SameCounter(same, entry))
+        continue;
+      if (!firstRemark)
+        Put(o, ",", 1);
+      firstRemark = false;
+      PutString(o, FlightStore_Text(same->remark));
+      Put(o, ",", 1);
+      PutString(o, FlightStore_Text(same->remarkLu));
+    }
+    Put(o, "]", 1);
+  }
+  Put(o, "}", 1);
+}
+
+// A field's value as JSON: a string, or the grouped counter object for ckco
+static void PutValue(JsonOut &o, const FlightRecord &flight, int id) {
+  if (id == FIELD_CKCO)
+    PutCounters(o, flight);
+  else
+    PutString(o, FlightStore_Text(flight.value[id]));
+}
+
+// Fields Batch_Add() sends: present and, except ckco, not empty
+static bool Sendable(const FlightRecord &flight, int id) {
+  return (flight.present & FIELD_BIT(id)) &&
+         (id == FIELD_CKCO || *FlightStore_Text(flight.value[id]) != '\0');
+}
+
+// Starts an entry; a chunk may run over the budget only for its first one
+static void BeginEntry() {
+  out.limit = out.used ? budget : BATCH_BUFFER_BYTES;
+  out.limit -= 2; // room for the closing brace and NUL
+  out.overflow = false;
+}
+
+bool Batch_Add(int rec, FieldMask fields) {
+  const FlightRecord *flight = FlightStore_Get(rec);
+  if (!buffer || !flight || pendingCount >= BATCH_MAX_FLIGHTS)
+    return false;
+
+  size_t mark = out.used;
+  BeginEntry();
+
+  char prefix[48];
+  char flightKey[FLIGHT_KEY_TEXT_MAX];
+  FlightKey_Format(flight->key, flightKey, sizeof(flightKey));
+  int prefixLen = snprintf(prefix, sizeof(prefix), "\"%s/%s/",
+                           FLIGHT_CATEGORY_NAMES[flight->category], flightKey);
+
+  FieldMask written = 0;
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (!(fields & FIELD_BIT(id)) || !Sendable(*flight, id))
+      continue; // never overwrite with an empty value
+
+    Put(out, out.used ? "," : "{", 1);
+    Put(out, prefix, prefixLen);
+    PutText(out, FIELD_NAMES[id]);
+    Put(out, "\":", 2);
+    PutValue(out, *flight, id);
+    written |= FIELD_BIT(id);
+  }
+
+  if (out.overflow) {
+    out.used = mark;
+    return false;
+  }
+  if (written) {
+    pending[pendingCount].rec = rec;
+    pending[pendingCount].fields = written;
+    pendingCount++;
+    Snapshot_Stage(*flight, written);
+  }
+  return true;
+}
+
+bool Batch_AddPath(const char *path, const char *json, size_t length) {
+  if (!buffer)
+    return false;
+  size_t mark = out.used;
+  BeginEntry();
+  Put(out, out.used ? "," : "{", 1);
+  PutString(out, path);
+  Put(out, ":", 1);
+  Put(out, json, length);
+  if (out.overflow) {
+    out.used = mark;
+    return false;
+  }
+  pendingPaths++;
+  return true;
+}
+
+int Batch_FormatValue(const FlightRecord &flight, int id, char *dst,
+                      size_t size) {
+  if (id < 0 || id >= FIELD_COUNT || !Sendable(flight, id))
+    return -1;
+  JsonOut value = {dst, 0, size, false};
+  PutValue(value, flight, id);
+  return value.overflow ? -1 : (int)value.used;
+}
+
+// Flights whose write did not go through are kept in the write-ahead log
+// until a later cycle replays them
+static void Batch_Buffer(const PendingFlight *flights, int count) {
+  FlightStore_Lock();
+  for (int i = 0; i < count; i++)
+    Wal_Append(*FlightStore_Get(flights[i].rec), flights[i].fields);
+  FlightStore_Unlock();
+}
+
+// Picks up finished chunks; a chunk counts only when its write succeeded
+static void Batch_Collect() {
+  for (int slot = 0; slot < RTDB_MAX_WINDOW; slot++) {
+    ChunkInFlight &chunk = inFlight[slot];
+    RtdbWriteSlot result;
+    if (!chunk.active || !Firebase_TakeWrite(slot, result))
+      continue;
+    chunk.active = false;
+    Health_Feed(); // an answer, even a failure, is progress
+    if (!result.ok) {
+      TRACE(TRACE_BATCH_DONE, chunk.count, 0);
+      LOG_ERROR("❌ Batch of %d flights failed (%s)\n", chunk.count,
+                result.uid);
+      Batch_Buffer(chunk.flights, chunk.count);
+      chunksFailed++;
+      continue;
+    }
+    FlightStore_Lock();
+    for (int i = 0; i < chunk.count; i++)
+      Snapshot_Commit(*FlightStore_Get(chunk.flights[i].rec),
+                      chunk.flights[i].fields);
+    FlightStore_Unlock();
+    flightsWritten += chunk.count;
+    TRACE(TRACE_BATCH_DONE, chunk.count, 1);
+    LOG_DEBUG("✅ Batch of %d flights written (%s)\n", chunk.count,
+              result.uid);
+  }
+}
+
+bool Batch_Flush() {
+  if (out.used == 0)
+    return true;
+  buffer[out.used++] = '}';
+  buffer[out.used] = '\0';
+  int flights = pendingCount;
+  int entries = pendingCount + pendingPaths;
+  size_t length = out.used;
+  out.used = 0;
+  pendingCount = 0;
+  pendingPaths = 0;
+
+  if (!Firebase_IsReady()) {
+    // Attempt to recover automatically
+    if (!Firebase_EnsureReady(10000)) {
+      Serial.println("❌ Firebase not ready. Call Firebase_Init() first.");
+      Batch_Buffer(pending, flights);
+      chunksFailed++;
+      return false;
+    }
+  }
+
+  // The client library copies the body, so the buffer is free once queued
+  object_t body((String(buffer)));
+  int slot;
+  while ((slot = Firebase_SubmitWrite(RTDB_WRITE_UPDATE, "/flights/Islamabad",
+                                      body)) < 0) {
+    Firebase_PollWrites();
+    Batch_Collect();
+    delay(10);
+  }
+
+  ChunkInFlight &chunk = inFlight[slot];
+  memcpy(chunk.flights, pending, flights * sizeof(PendingFlight));
+  chunk.count = flights;
+  chunk.active = true;
+  TRACE(TRACE_BATCH_SENT, entries, length);
+  LOG_DEBUG("📦 Sending %d entries (%u bytes) to /flights/Islamabad, %d in "
+            "flight\n",
+            entries, (unsigned)length, Firebase_WritesInFlight());
+  return true;
+}
+
+int Batch_Drain() {
+  for (;;) {
+    Batch_Collect();
+    bool active = false;
+    for (int slot = 0; slot < RTDB_MAX_WINDOW; slot++)
+      active |= inFlight[slot].active;
+    if (!active)
+      break;
+    Firebase_PollWrites();
+    delay(10);
+  }
+  int written = flightsWritten;
+  flightsWritten = 0;
+  lastChunksFailed = chunksFailed;
+  chunksFailed = 0;
+  return written;
+}
+
+int Batch_FailedChunks() { return lastChunksFailed; }
+
+void Batch_Poll() {
+  Firebase_PollWrites();
+  Batch_Collect();
+}
+
+static bool InFlight(int rec) {
+  for (int slot = 0; slot < RTDB_MAX_WINDOW; slot++) {
+    const ChunkInFlight &chunk = inFlight[slot];
+    for (int i = 0; chunk.active && i < chunk.count; i++) {
+      if (chunk.flights[i].rec == rec)
+        return true;
+    }
+  }
+  return false;
+}
+
+// Writes on different connections may be applied in any order, so a flight
+// queued again waits for its earlier write before it is diffed and sent
+void Batch_Settle(int rec) {
+  for (int i = 0; i < pendingCount; i++) {
+    if (pending[i].rec == rec) {
+      Batch_Flush();
+      break;
+    }
+  }
+  while (InFlight(rec)) {
+    Batch_Poll();
+    delay(10);
+  }
+}
@@ -0,0 +1,139 @@
+#include "Global.h"
+
+// ============ DATE/TIME KERNEL ============
+// WebDavis sends times as ISO "YYYY-MM-DD HH:MM:SS", as YYYYMMDDHHMM, or
+// already as YYMMDDHHMM. Everything here works in place on the cell's char
+// span and never allocates. It yields the compact YYMMDDHHMM text the RTDB
+// uses plus minutes since 2000-01-01 00:00 (local time) for keys and
+// arithmetic. Day math is table driven; two digit years cover 2000-2099.
+
+static const uint16_t DAYS_BEFORE_MONTH[2][13] = {
+    {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365},
+    {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366}};
+
+#define MINUTES_PER_DAY 1440UL
+#define UNIX_TIME_2000 946684800UL // 2000-01-01 00:00 UTC
+
+static bool IsLeapYear(int yy) { return (yy & 3) == 0; }
+static uint32_t DaysBeforeYear(int yy) { return 365UL * yy + (yy + 3) / 4; }
+
+static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+static int TwoDigits(const char *p) {
+  if (!IsDigit(p[0]) || !IsDigit(p[1]))
+    return -1;
+  return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+static bool IsISO(const char *v, size_t len) {
+  return len == 19 && v[4] == '-' && v[7] == '-' && v[10] == ' ' &&
+         v[13] == ':' && v[16] == ':';
+}
+
+// YYYYMMDDHHMM with a plausible year; mirrors the old toInt() > 1999 check
+static bool IsYear4Compact(const char *v, size_t len) {
+  if (len != 12)
+    return false;
+  for (int i = 0; i < 4; i++)
+    if (!IsDigit(v[i]))
+      return false;
+  int year = (v[0] - '0') * 1000 + (v[1] - '0') * 100 + (v[2] - '0') * 10 +
+             (v[3] - '0');
+  return year > 1999;
+}
+
+uint32_t DateTime_CompactMinutes(const char *text, size_t len) {
+  if (len != 10)
+    return DATETIME_INVALID;
+  int yy = TwoDigits(text);
+  int mm = TwoDigits(text + 2);
+  int dd = TwoDigits(text + 4);
+  int hh = TwoDigits(text + 6);
+  int mi = TwoDigits(text + 8);
+  if (yy < 0 || mm < 1 || mm > 12 || dd < 1 || hh < 0 || hh > 23 || mi < 0 ||
+      mi > 59)
+    return DATETIME_INVALID;
+  const uint16_t *days = DAYS_BEFORE_MONTH[IsLeapYear(yy)];
+  if (dd > days[mm] - days[mm - 1])
+    return DATETIME_INVALID;
+
+  return (DaysBeforeYear(yy) + days[mm - 1] + (dd - 1)) * MINUTES_PER_DAY +
+         hh * 60 + mi;
+}
+
+DateTimeShape DateTime_Normalize(char *text, uint8_t &len, bool stm,
+                                 uint32_t *minutes) {
+  DateTimeShape shape = DATETIME_OTHER;
+
+  if (IsISO(text, len)) {
+    // 2026-01-31 08:10:00 -> 2601310810
+    char compact[10] = {text[2],  text[3],  text[5],  text[6],  text[8],
+                        text[9],  text[11], text[12], text[14], text[15]};
+    memcpy(text, compact, sizeof(compact));
+    len = 10;
+    shape = DATETIME_ISO;
+  } else if (stm && IsYear4Compact(text, len)) {
+    memmove(text, text + 2, 10);
+    len = 10;
+    shape = DATETIME_FROM_YEAR4;
+  } else if (stm && len > 10) {
+    // Any other layout: keep the first 12 digits and hope for a date
+    char digits[12];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < len && count < sizeof(digits); i++) {
+      if (IsDigit(text[i]))
+        digits[count++] = text[i];
+    }
+    if (count == 12) {
+      memcpy(text, digits + 2, 10);
+      shape = DATETIME_FROM_DIGITS12;
+    } else if (count == 10) {
+      memcpy(text, digits, 10);
+      shape = DATETIME_FROM_DIGITS10;
+    } else {
+      if (minutes)
+        *minutes = DATETIME_INVALID;
+      return DATETIME_BAD;
+    }
+    len = 10;
+  }
+  text[len] = '\0';
+
+  uint32_t parsed = DateTime_CompactMinutes(text, len);
+  if (shape == DATETIME_OTHER && parsed != DATETIME_INVALID)
+    shape = DATETIME_COMPACT;
+  if (minutes)
+    *minutes = parsed;
+  return shape;
+}
+
+void DateTime_FormatCompact(uint32_t minutes, char *out) {
+  uint32_t day = minutes / MINUTES_PER_DAY;
+  uint32_t minuteOfDay = minutes % MINUTES_PER_DAY;
+
+  int yy = day / 366; // never past the real year, walk forward
+  while (DaysBeforeYear(yy + 1) <= day)
+    yy++;
+  uint32_t dayOfYear = day - DaysBeforeYear(yy);
+  const uint16_t *days = DAYS_BEFORE_MONTH[IsLeapYear(yy)];
+  int mm = 1;
+  while (days[mm] <= dayOfYear)
+    mm++;
+  int dd = dayOfYear - days[mm - 1] + 1;
+  int hh = minuteOfDay / 60;
+  int mi = minuteOfDay % 60;
+
+  const int parts[5] = {yy, mm, dd, hh, mi};
+  for (int i = 0; i < 5; i++) {
+    out[i * 2] = '0' + parts[i] / 10;
+    out[i * 2 + 1] = '0' + parts[i] % 10;
+  }
+  out[10] = '\0';
+}
+
+// WebDavis times are local (GMT_OFFSET_SEC); the result is a Unix timestamp
+time_t DateTime_MinutesToEpoch(uint32_t minutes) {
+  if (minutes == DATETIME_INVALID)
+    return 0;
+  return (time_t)(UNIX_TIME_2000 + (uint64_t)minutes * 60 - GMT_OFFSET_SEC);
+}
@@ -0,0 +1,82 @@
+#include "Global.h"
+
+// ============ BINARY FLIGHT KEY ============
+// A flight is identified by its scheduled time and designator. Both are
+// packed into one uint64 so the store can hash and compare keys as integers:
+//
+//   bits 63..38  minutes since 2000-01-01 00:00 (26 bits, ~127 years)
+//   bits 37..0   designator, base 37, 7 chars, right padded
+//                (0 = pad, 1..10 = '0'..'9', 11..36 = 'A'..'Z')
+//
+// Right padding keeps integer order equal to text order, so sorting keys
+// sorts flights by scheduled time, then flight number. The text form
+// "YYMMDDHHMM_FLNR" is only produced when an RTDB path is built.
+
+#define DESIGNATOR_BITS 38
+#define DESIGNATOR_MASK ((1ULL << DESIGNATOR_BITS) - 1)
+
+static uint8_t DesignatorCode(char c) {
+  if (c >= '0' && c <= '9')
+    return 1 + (c - '0');
+  if (c >= 'A' && c <= 'Z')
+    return 11 + (c - 'A');
+  if (c >= 'a' && c <= 'z')
+    return 11 + (c - 'a');
+  return 0xFF;
+}
+
+static char DesignatorChar(uint8_t code) {
+  return code <= 10 ? '0' + (code - 1) : 'A' + (code - 11);
+}
+
+FlightKey FlightKey_Make(uint32_t minutes, const char *flnr) {
+  // Minutes come from DateTime_Normalize() on the stm cell
+  if (minutes == DATETIME_INVALID || minutes >> (64 - DESIGNATOR_BITS))
+    return FLIGHT_KEY_NONE;
+
+  // Designator: spaces dropped, as in the old text key
+  uint64_t designator = 0;
+  int length = 0;
+  for (const char *p = flnr; *p; p++) {
+    if (*p == ' ')
+      continue;
+    uint8_t code = DesignatorCode(*p);
+    if (code == 0xFF || length == FLIGHT_DESIGNATOR_MAX)
+      return FLIGHT_KEY_NONE;
+    designator = designator * 37 + code;
+    length++;
+  }
+  if (length == 0)
+    return FLIGHT_KEY_NONE;
+  for (; length < FLIGHT_DESIGNATOR_MAX; length++)
+    designator *= 37;
+
+  return ((uint64_t)minutes << DESIGNATOR_BITS) | designator;
+}
+
+uint32_t FlightKey_Minutes(FlightKey key) {
+  return (uint32_t)(key >> DESIGNATOR_BITS);
+}
+
+size_t FlightKey_Format(FlightKey key, char *out, size_t size) {
+  if (size < FLIGHT_KEY_TEXT_MAX || key == FLIGHT_KEY_NONE) {
+    if (size)
+      out[0] = '\0';
+    return 0;
+  }
+
+  DateTime_FormatCompact(FlightKey_Minutes(key), out);
+  size_t n = 10;
+  out[n++] = '_';
+
+  char designator[FLIGHT_DESIGNATOR_MAX];
+  uint64_t packed = key & DESIGNATOR_MASK;
+  for (int i = FLIGHT_DESIGNATOR_MAX - 1; i >= 0; i--) {
+    designator[i] = packed % 37;
+    packed /= 37;
+  }
+  for (int i = 0; i < FLIGHT_DESIGNATOR_MAX && designator[i]; i++)
+    out[n++] = DesignatorChar(designator[i]);
+  out[n] = '\0';
+  return n;
+}
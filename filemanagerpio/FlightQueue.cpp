@@ -0,0 +1,88 @@
+#include "Global.h"
+
+#include <atomic>
+
+// ============ FLIGHT QUEUE ============
+// Bounded single-producer / single-consumer ring of flight store records,
+// from the scraper task to the uploader task. Lock-free: the producer owns
+// `tail`, the consumer owns `head`, each reads the other's index with
+// acquire ordering. The producer publishes a page's records at once, so the
+// uploader batches a whole page instead of one flight at a time.
+//
+// Neither side spins: the consumer waits for a task notification when the
+// ring is empty, the producer when it is full.
+
+static int16_t ring[FLIGHT_QUEUE_SLOTS];
+static std::atomic<uint32_t> head(0); // next slot to pop
+static std::atomic<uint32_t> tail(0); // slots published to the consumer
+static uint32_t written = 0;          // producer: slots filled, maybe unpublished
+static std::atomic<bool> closed(false);
+static std::atomic<bool> producerWaiting(false);
+static TaskHandle_t producer = nullptr;
+static TaskHandle_t consumer = nullptr;
+
+void FlightQueue_Begin() {
+  head.store(0);
+  tail.store(0);
+  written = 0;
+  closed.store(false);
+  producerWaiting.store(false);
+  producer = nullptr;
+  consumer = xTaskGetCurrentTaskHandle();
+}
+
+void FlightQueue_Publish() {
+  if (tail.load(std::memory_order_relaxed) == written)
+    return;
+  tail.store(written, std::memory_order_release);
+  xTaskNotifyGive(consumer);
+}
+
+void FlightQueue_Push(int16_t rec) {
+  if (!producer)
+    producer = xTaskGetCurrentTaskHandle();
+
+  while (written - head.load(std::memory_order_acquire) >=
+         FLIGHT_QUEUE_SLOTS) {
+    // Full: hand over what is written and wait for the uploader to pop.
+    // The flag is set before checking again, so a pop in between still
+    // sends the notification.
+    FlightQueue_Publish();
+    producerWaiting.store(true);
+    if (written - head.load(std::memory_order_acquire) >= FLIGHT_QUEUE_SLOTS)
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    producerWaiting.store(false);
+  }
+  ring[written & (FLIGHT_QUEUE_SLOTS - 1)] = rec;
+  written++;
+}
+
+void FlightQueue_Close() {
+  FlightQueue_Publish();
+  closed.store(true, std::memory_order_release);
+  xTaskNotifyGive(consumer);
+}
+
+bool FlightQueue_Pop(int16_t &rec) {
+  uint32_t at = head.load(std::memory_order_relaxed);
+  if (at == tail.load(std::memory_order_acquire))
+    return false;
+  rec = ring[at & (FLIGHT_QUEUE_SLOTS - 1)];
+  head.store(at + 1, std::memory_order_release);
+  if (producerWaiting.exchange(false))
+    xTaskNotifyGive(producer);
+  return true;
+}
+
+bool FlightQueue_Wait() {
+  for (;;) {
+    // Closed is read first: records published before closing are visible
+    bool done = closed.load(std::memory_order_acquire);
+    if (head.load(std::memory_order_relaxed) !=
+        tail.load(std::memory_order_acquire))
+      return true;
+    if (done)
+      return false;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
@@ -0,0 +1,284 @@
+#include "Global.h"
+
+// ============ FLIGHT STORE ============
+// Holds every flight of the current sync cycle (departures and arrivals
+// together) in one fixed arena, allocated once in PSRAM:
+//   - records are packed structs indexed by FieldId, values are uint16 offsets
+//     into a string pool
+//   - repeated values (cities, statuses, SubCat, counters) are interned so
+//     they are stored once
+//   - an open-addressing table maps category + FlightKey to a record
+// Nothing is freed per flight; FlightStore_Clear() resets the whole arena.
+// When a limit is hit the row/value is dropped and counted, never silently.
+//
+// The scraper task writes and the uploader task reads the store at the same
+// time; both hold FlightStore_Lock() around each row / flight. Records that
+// changed are collected in a dirty list the scraper hands on per page.
+
+const char *FLIGHT_CATEGORY_NAMES[CATEGORY_COUNT] = {"Departure", "Arrival"};
+
+struct FlightStoreArena {
+  FlightRecord flights[FLIGHT_STORE_CAPACITY];
+  CounterEntry counters[FLIGHT_STORE_COUNTERS];
+  uint16_t index[FLIGHT_INDEX_SLOTS];   // record + 1, 0 = empty
+  uint16_t intern[FLIGHT_INTERN_SLOTS]; // pool offset, 0 = empty
+  char pool[FLIGHT_STORE_POOL_BYTES];   // offset 0 is always ""
+};
+
+static FlightStoreArena *store = nullptr;
+static FlightStoreStats stats = {};
+static SemaphoreHandle_t storeLock = nullptr;
+
+// Records changed since the last FlightStore_TakeDirty()
+static uint8_t dirtyBits[(FLIGHT_STORE_CAPACITY + 7) / 8];
+static int16_t dirtyList[FLIGHT_STORE_CAPACITY];
+static int dirtyCount = 0;
+
+static void MarkDirty(int rec) {
+  if (dirtyBits[rec >> 3] & (1 << (rec & 7)))
+    return;
+  dirtyBits[rec >> 3] |= 1 << (rec & 7);
+  dirtyList[dirtyCount++] = rec;
+}
+
+static uint32_t HashText(const char *text, size_t len, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed; // FNV-1a
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (uint8_t)text[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Copies text into the pool; returns its offset or 0 when the pool is full
+static uint16_t Pool_Append(const char *text, size_t len) {
+  if (stats.poolUsed + len + 1 > FLIGHT_STORE_POOL_BYTES)
+    return 0;
+  uint16_t offset = stats.poolUsed;
+  memcpy(store->pool + offset, text, len);
+  store->pool[offset + len] = '\0';
+  stats.poolUsed += len + 1;
+  return offset;
+}
+
+// Offset of an identical string already in the pool, or a new copy. Once the
+// intern table is 3/4 full new values are appended without interning.
+static uint16_t Pool_Intern(const char *text, size_t len) {
+  if (len == 0)
+    return 0;
+  uint32_t slot = HashText(text, len, 0) & (FLIGHT_INTERN_SLOTS - 1);
+  for (int probe = 0; probe < FLIGHT_INTERN_SLOTS; probe++) {
+    uint16_t offset = store->intern[slot];
+    if (offset == 0)
+      break;
+    const char *existing = store->pool + offset;
+    if (strncmp(existing, text, len) == 0 && existing[len] == '\0')
+      return offset;
+    slot = (slot + 1) & (FLIGHT_INTERN_SLOTS - 1);
+  }
+
+  uint16_t offset = Pool_Append(text, len);
+  if (offset != 0 && stats.interned < FLIGHT_INTERN_SLOTS * 3 / 4) {
+    store->intern[slot] = offset;
+    stats.interned++;
+  }
+  return offset;
+}
+
+bool FlightStore_Init() {
+  if (store)
+    return true;
+  // PSRAM first; internal RAM only as a fallback on boards without it
+  store = (FlightStoreArena *)ps_calloc(1, sizeof(FlightStoreArena));
+  if (!store)
+    store = (FlightStoreArena *)calloc(1, sizeof(FlightStoreArena));
+  if (!store) {
+    Serial.printf("❌ Flight store: cannot allocate %u bytes\n",
+                  (unsigned)sizeof(FlightStoreArena));
+    return false;
+  }
+  storeLock = xSemaphoreCreateRecursiveMutex();
+  FlightStore_Clear();
+  Serial.printf("📦 Flight store: %d flights, %d counters, %d byte pool "
+                "(%u bytes)\n",
+                FLIGHT_STORE_CAPACITY, FLIGHT_STORE_COUNTERS,
+                FLIGHT_STORE_POOL_BYTES, (unsigned)sizeof(FlightStoreArena));
+  return true;
+}
+
+void FlightStore_Clear() {
+  stats = {};
+  stats.poolUsed = 1; // offset 0 = ""
+  if (!store)
+    return;
+  memset(store->index, 0, sizeof(store->index));
+  memset(store->intern, 0, sizeof(store->intern));
+  store->pool[0] = '\0';
+  memset(dirtyBits, 0, sizeof(dirtyBits));
+  dirtyCount = 0;
+}
+
+void FlightStore_Lock() {
+  if (storeLock)
+    xSemaphoreTakeRecursive(storeLock, portMAX_DELAY);
+}
+
+void FlightStore_Unlock() {
+  if (storeLock)
+    xSemaphoreGiveRecursive(storeLock);
+}
+
+// 64-bit mix of the key (and category) down to an index slot
+static uint32_t HashKey(FlightKey key, FlightCategory category) {
+  uint64_t x = key ^ ((uint64_t)category << 63);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  return (uint32_t)x;
+}
+
+// Record of the flight, or -1 with slot set to the empty index slot for it
+static int FindSlot(FlightCategory category, FlightKey key, uint32_t &slot) {
+  slot = HashKey(key, category) & (FLIGHT_INDEX_SLOTS - 1);
+  for (int probe = 0; probe < FLIGHT_INDEX_SLOTS; probe++) {
+    uint16_t entry = store->index[slot];
+    if (entry == 0)
+      break;
+    FlightRecord &existing = store->flights[entry - 1];
+    if (existing.key == key && existing.category == category)
+      return entry - 1;
+    slot = (slot + 1) & (FLIGHT_INDEX_SLOTS - 1);
+  }
+  return -1;
+}
+
+int FlightStore_Find(FlightCategory category, FlightKey key) {
+  uint32_t slot;
+  return store ? FindSlot(category, key, slot) : -1;
+}
+
+int FlightStore_FindOrAdd(FlightCategory category, FlightKey key) {
+  if (!store)
+    return -1;
+  uint32_t slot;
+  int found = FindSlot(category, key, slot);
+  if (found >= 0)
+    return found;
+
+  if (stats.flights >= FLIGHT_STORE_CAPACITY) {
+    char text[FLIGHT_KEY_TEXT_MAX];
+    FlightKey_Format(key, text, sizeof(text));
+    stats.droppedFlights++;
+    Serial.printf("⚠️ Flight store full (%d flights), dropped %s\n",
+                  FLIGHT_STORE_CAPACITY, text);
+    return -1;
+  }
+
+  int rec = stats.flights++;
+  FlightRecord &record = store->flights[rec];
+  memset(&record, 0, sizeof(record));
+  record.key = key;
+  record.category = category;
+  store->index[slot] = rec + 1;
+  return rec;
+}
+
+bool FlightStore_SetField(int rec, FieldId id, const char *value, size_t len) {
+  if (!store || rec < 0 || rec >= stats.flights || id >= FIELD_COUNT)
+    return false;
+  uint16_t offset = Pool_Intern(value, len);
+  if (offset == 0 && len > 0) {
+    stats.droppedValues++;
+    return false;
+  }
+  FlightRecord &record = store->flights[rec];
+  if (record.value[id] == offset && (record.present & FIELD_BIT(id)))
+    return true; // same (interned) value, nothing to upload again
+  record.value[id] = offset;
+  record.present |= FIELD_BIT(id);
+  MarkDirty(rec);
+  return true;
+}
+
+bool FlightStore_AddCounter(int rec, const char *counter, const char *remark,
+                            const char *remarkLu) {
+  if (!store || rec < 0 || rec >= stats.flights)
+    return false;
+  if (stats.counters >= FLIGHT_STORE_COUNTERS) {
+    stats.droppedCounters++;
+    return false;
+  }
+  uint16_t counterOffset = Pool_Intern(counter, strlen(counter));
+  uint16_t remarkOffset = Pool_Intern(remark, strlen(remark));
+  uint16_t remarkLuOffset = Pool_Intern(remarkLu, strlen(remarkLu));
+  if (counterOffset == 0 || (remarkOffset == 0 && *remark) ||
+      (remarkLuOffset == 0 && *remarkLu)) {
+    stats.droppedCounters++;
+    return false;
+  }
+
+  uint16_t entry = stats.counters++;
+  CounterEntry &counterEntry = store->counters[entry];
+  counterEntry.counter = counterOffset;
+  counterEntry.remark = remarkOffset;
+  counterEntry.remarkLu = remarkLuOffset;
+  counterEntry.next = 0;
+
+  // Appended at the tail so uploads keep the order rows arrived in
+  FlightRecord &record = store->flights[rec];
+  if (record.ckcoTail)
+    store->counters[record.ckcoTail - 1].next = entry + 1;
+  else
+    record.ckcoHead = entry + 1;
+  record.ckcoTail = entry + 1;
+  record.present |= FIELD_BIT(FIELD_CKCO);
+  MarkDirty(rec);
+  return true;
+}
+
+int FlightStore_TakeDirty(int16_t *recs, int max) {
+  int count = min(dirtyCount, max);
+  for (int i = 0; i < count; i++) {
+    int16_t rec = dirtyList[i];
+    dirtyBits[rec >> 3] &= ~(1 << (rec & 7));
+    recs[i] = rec;
+  }
+  // Whatever did not fit stays for the next call
+  memmove(dirtyList, dirtyList + count, (dirtyCount - count) * sizeof(int16_t));
+  dirtyCount -= count;
+  return count;
+}
+
+int FlightStore_Count() { return stats.flights; }
+
+const FlightRecord *FlightStore_Get(int rec) {
+  if (!store || rec < 0 || rec >= stats.flights)
+    return nullptr;
+  return &store->flights[rec];
+}
+
+const CounterEntry *FlightStore_GetCounter(uint16_t entry) {
+  if (!store || entry == 0 || entry > stats.counters)
+    return nullptr;
+  return &store->counters[entry - 1];
+}
+
+const char *FlightStore_Text(uint16_t offset) {
+  return store ? store->pool + offset : "";
+}
+
+FlightStoreStats FlightStore_GetStats() { return stats; }
+
+void FlightStore_PrintStats() {
+  Serial.printf("📦 Flight store: %u/%d flights, %u/%d counters, pool "
+                "%u/%d bytes\n",
+                stats.flights, FLIGHT_STORE_CAPACITY, stats.counters,
+                FLIGHT_STORE_COUNTERS, (unsigned)stats.poolUsed,
+                FLIGHT_STORE_POOL_BYTES);
+  if (stats.droppedFlights || stats.droppedValues || stats.droppedCounters) {
+    Serial.printf("⚠️ Flight store overflow: dropped %u flights, %u values, "
+                  "%u counters\n",
+                  (unsigned)stats.droppedFlights, (unsigned)stats.droppedValues,
+                  (unsigned)stats.droppedCounters);
+  }
+}
@@ -36,6 +36,109 @@
 #define NTP_SERVER "pool.ntp.org"
 #define GMT_OFFSET_SEC 18000  // GMT+5 (Pakistan: 5 * 3600)
 #define DAYLIGHT_OFFSET_SEC 0 // No daylight saving
+// ============ LOGGING (Trace.cpp) ============
+// Serial output by level, fixed at compile time: a disabled level's LOG_*
+// calls and their arguments compile to nothing. Override with e.g.
+// -DLOG_LEVEL=4 in build.extra_flags (platform.local.txt).
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3    // cycle and config summaries
+#define LOG_LEVEL_DEBUG 4   // per page, chunk and write
+#define LOG_LEVEL_VERBOSE 5 // per row and flight, payloads
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#define LOG_ENABLED(level) (LOG_LEVEL >= LOG_LEVEL_##level)
+#define LOG_AT(level, ...)                                                     \
+  do {                                                                         \
+    if (LOG_ENABLED(level))                                                    \
+      Serial.printf(__VA_ARGS__);                                              \
+  } while (0)
+#define LOG_ERROR(...) LOG_AT(ERROR, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(WARN, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(DEBUG, __VA_ARGS__)
+#define LOG_VERBOSE(...) LOG_AT(VERBOSE, __VA_ARGS__)
+
+// Binary trace: event id and two integers per record in a RAM ring, cheap
+// enough for the hot path and dumped at /api/trace. TRACE_ENABLED 0 removes
+// every TRACE() call.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+#define TRACE_RING_SIZE 1024 // records, power of two (16 KB)
+
+enum TraceEvent : uint16_t {
+  TRACE_CYCLE_BEGIN,   // full sync, 0
+  TRACE_CYCLE_END,     // ms, success
+  TRACE_PAGE,          // page, bytes
+  TRACE_PAGE_FAILED,   // HTTP code, page
+  TRACE_PAGE_CUT,      // bytes missing, Content-Length
+  TRACE_PAGE_SKIPPED,  // page, rows carried over
+  TRACE_QUEUED,        // flights queued after a page, 0
+  TRACE_BATCH_SENT,    // entries, bytes
+  TRACE_BATCH_DONE,    // flights, ok
+  TRACE_WRITE_SENT,    // slot, attempt
+  TRACE_WRITE_OK,      // slot, round trip ms
+  TRACE_WRITE_ERROR,   // slot, code
+  TRACE_WRITE_TIMEOUT, // slot, timeout ms
+  TRACE_WAL_APPEND,    // category, fields
+  TRACE_EVENT_COUNT
+};
+extern const char *TRACE_EVENT_NAMES[TRACE_EVENT_COUNT];
+
+struct TraceRecord {
+  uint32_t ms;
+  uint16_t event; // TraceEvent
+  uint16_t core;
+  int32_t a;
+  int32_t b;
+};
+
+#if TRACE_ENABLED
+#define TRACE(event, a, b) Trace_Record(event, a, b)
+#else
+#define TRACE(event, a, b)                                                     \
+  do {                                                                         \
+  } while (0)
+#endif
+
+bool Trace_Init();
+void Trace_Record(TraceEvent event, int32_t a, int32_t b);
+// Oldest first; records written since boot (may exceed the ring)
+size_t Trace_Snapshot(TraceRecord *out, size_t max, uint32_t &total);
+int Trace_Format(const TraceRecord &record, char *dst, size_t size);
+
+// ============ METRICS FUNCTIONS (Metrics.cpp) ============
+// Counters and fixed-bucket histograms since boot, served by /metrics in the
+// Prometheus text format. Recording is an atomic add, so any task may record
+// while a scrape reads them.
+#define METRICS_BUCKETS 10          // finite ones; +Inf comes on top
+#define METRICS_TEXT_BYTES (8 * 1024) // one scrape, formatted in PSRAM
+
+enum MetricCounter : uint8_t {
+  METRIC_PAGES,            // WebDavis pages read in full
+  METRIC_PAGE_ERRORS,      // failed or cut off
+  METRIC_ROWS,             // table rows tokenized
+  METRIC_FLIGHTS_UPLOADED, // in successful RTDB writes
+  METRIC_FLIGHTS_SKIPPED,  // unchanged since their last upload
+  METRIC_FLIGHTS_FAILED,   // went to the write-ahead log instead
+  METRIC_COUNTER_COUNT
+};
+
+enum MetricHistogram : uint8_t {
+  METRIC_PAGE_SCAN,  // us, pager scan and row hashing of a held page
+  METRIC_PAGE_PARSE, // us, tokenizing a page's rows into the store
+  METRIC_RTDB_RTT,   // ms, RTDB write round trip
+  METRIC_CYCLE,      // ms, one sync cycle
+  METRIC_HISTOGRAM_COUNT
+};
+
+void Metrics_Add(MetricCounter counter, uint32_t n);
+void Metrics_Observe(MetricHistogram histogram, uint32_t value);
+size_t Metrics_Format(char *dst, size_t size); // length, cut at size - 1
+
 // ============ GLOBAL SERVER OBJECT ============
 extern AsyncWebServer server;
 extern UserAuth user_auth;
@@ -66,9 +169,6 @@ enum FlightDataState {
 extern FlightDataState flightDataState;
 extern Session sessions[5];
 
-// Increased sizes for more flight data capacity
-extern StaticJsonDocument<32768> allData; // 32KB - temporary scratchpad
-
 // Flight data state
 extern const char *url;
 extern int Page;
@@ -83,11 +183,299 @@ extern const char *MANAGED_FIELDS[];
 extern const int MANAGED_FIELDS_COUNT;
 extern bool Start;
 
+// ============ FIELD IDS ============
+// Managed field names are mapped to a small integer once, while parsing.
+// Everything after that (filtering, empty checks, ckco/crem pairing) works on
+// FieldId and FieldMask. Order here is the order of MANAGED_FIELDS.
+#define MANAGED_FIELD_LIST(X)                                                  \
+  X(STM, "stm")         /* Time */                                             \
+  X(FLNR, "flnr")       /* Flight No */                                        \
+  X(ECT, "ect")         /* Estimated Time */                                   \
+  X(ATT, "att")         /* Actual Time */                                      \
+  X(BLT1, "blt1")       /* Belt */                                             \
+  X(BRE1, "bre1")       /* Status */                                           \
+  X(CITY_LU, "city_lu") /* City */                                             \
+  X(VIA1_LU, "via1_lu") /* Via */                                              \
+  X(PREM_LU, "prem_lu") /* Remark */                                           \
+  X(FSTA_LU, "fsta_lu") /* FSTA */                                             \
+  X(CRO1, "cro1")       /* Zone */                                             \
+  X(CCTF, "cctf")       /* Check-In From */                                    \
+  X(CCTT, "cctt")       /* Check-In To */                                      \
+  X(GAT1, "gat1")       /* Gate */                                             \
+  X(CROW, "crow")       /* Row */                                              \
+  X(CKCO, "ckco")       /* Counter */                                          \
+  X(AOPN, "aopn")       /* Open */                                             \
+  X(ACLO, "aclo")       /* Close */                                            \
+  X(CREM, "crem")       /* Remark */                                           \
+  X(CREM_LU, "crem_lu") /* Remark */                                           \
+  X(SUBCAT, "SubCat")   /* Category */
+
+#define FIELD_ENUM_ENTRY(id, name) FIELD_##id,
+enum FieldId : uint8_t {
+  MANAGED_FIELD_LIST(FIELD_ENUM_ENTRY) FIELD_COUNT,
+  FIELD_UNKNOWN = 0xFF
+};
+#undef FIELD_ENUM_ENTRY
+
+typedef uint32_t FieldMask; // bit n set = FieldId n present
+#define FIELD_BIT(id) ((FieldMask)1 << (id))
+
+#define FIELD_NAME_ENTRY(id, name) name,
+constexpr const char *FIELD_NAMES[FIELD_COUNT] = {
+    MANAGED_FIELD_LIST(FIELD_NAME_ENTRY)};
+#undef FIELD_NAME_ENTRY
+
+// Perfect hash over the managed names: first, second and last character plus
+// length, into 32 slots. The static_assert below fails the build if a field
+// is added that collides, so the multipliers must be re-tuned with it.
+#define FIELD_HASH_SLOTS 32
+constexpr uint8_t FieldHash(const char *name, size_t len) {
+  return (uint8_t)(((uint8_t)name[0] * 9u + (uint8_t)name[1] * 12u +
+                    (uint8_t)name[len - 1] * 15u + len) &
+                   (FIELD_HASH_SLOTS - 1));
+}
+constexpr size_t FieldNameLength(const char *name) {
+  return *name ? 1 + FieldNameLength(name + 1) : 0;
+}
+constexpr uint8_t FieldSlot(int id) {
+  return FieldHash(FIELD_NAMES[id], FieldNameLength(FIELD_NAMES[id]));
+}
+constexpr bool FieldSlotUnique(int id, int other) {
+  return other >= FIELD_COUNT ? true
+         : (other != id && FieldSlot(id) == FieldSlot(other))
+             ? false
+             : FieldSlotUnique(id, other + 1);
+}
+constexpr bool FieldSlotsUnique(int id) {
+  return id >= FIELD_COUNT ? true
+                           : FieldSlotUnique(id, 0) && FieldSlotsUnique(id + 1);
+}
+static_assert(FIELD_COUNT <= 32, "FieldMask holds at most 32 fields");
+static_assert(FieldSlotsUnique(0), "FieldHash collision between managed fields");
+
+FieldId Field_Lookup(const char *name, size_t len); // FIELD_UNKNOWN if unmanaged
+size_t Field_FormatList(FieldMask mask, char *out, size_t size); // "stm, flnr"
+
+// ============ DATE/TIME FUNCTIONS (DateTime.cpp) ============
+// In-place normalization of WebDavis time values to YYMMDDHHMM plus minutes
+// since 2000-01-01 00:00 local time (DATETIME_INVALID when not a real date)
+#define DATETIME_INVALID 0xFFFFFFFFUL
+
+enum DateTimeShape : uint8_t {
+  DATETIME_OTHER,         // not a date/time, left as is
+  DATETIME_COMPACT,       // already YYMMDDHHMM
+  DATETIME_ISO,           // YYYY-MM-DD HH:MM:SS, compacted
+  DATETIME_FROM_YEAR4,    // stm YYYYMMDDHHMM, year digits dropped
+  DATETIME_FROM_DIGITS12, // stm, 12 digits pulled out of another layout
+  DATETIME_FROM_DIGITS10, // stm, 10 digits pulled out of another layout
+  DATETIME_BAD            // stm that cannot be turned into YYMMDDHHMM
+};
+
+DateTimeShape DateTime_Normalize(char *text, uint8_t &len, bool stm,
+                                 uint32_t *minutes);
+uint32_t DateTime_CompactMinutes(const char *text, size_t len);
+void DateTime_FormatCompact(uint32_t minutes, char *out); // 11 bytes
+time_t DateTime_MinutesToEpoch(uint32_t minutes);
+
+// ============ FLIGHT KEY FUNCTIONS (FlightKey.cpp) ============
+// Scheduled minute (since 2000-01-01) above a base-37 packed designator;
+// integer order is scheduled-time order. Text form only for RTDB paths.
+typedef uint64_t FlightKey;
+#define FLIGHT_KEY_NONE 0
+#define FLIGHT_DESIGNATOR_MAX 7 // "PK300", "PIA6123"
+#define FLIGHT_KEY_TEXT_MAX 20  // "YYMMDDHHMM_" + designator + NUL
+
+FlightKey FlightKey_Make(uint32_t minutes, const char *flnr); // NONE if invalid
+uint32_t FlightKey_Minutes(FlightKey key);
+size_t FlightKey_Format(FlightKey key, char *out, size_t size);
+
+// ============ FLIGHT STORE FUNCTIONS (FlightStore.cpp) ============
+#define FLIGHT_STORE_CAPACITY 512    // flights, departures + arrivals
+#define FLIGHT_STORE_COUNTERS 1024   // ckco entries
+#define FLIGHT_STORE_POOL_BYTES 65535 // string pool, uint16 offsets
+#define FLIGHT_INDEX_SLOTS 1024      // power of two, >= 2x capacity
+#define FLIGHT_INTERN_SLOTS 2048     // power of two
+
+enum FlightCategory : uint8_t {
+  CATEGORY_DEPARTURE,
+  CATEGORY_ARRIVAL,
+  CATEGORY_COUNT
+};
+extern const char *FLIGHT_CATEGORY_NAMES[CATEGORY_COUNT];
+
+struct FlightRecord {
+  FlightKey key;
+  uint16_t value[FIELD_COUNT]; // pool offset per FieldId, 0 = ""
+  FieldMask present;           // FieldIds that have been set
+  uint16_t ckcoHead;           // first CounterEntry + 1, 0 = none
+  uint16_t ckcoTail;           // last CounterEntry + 1
+  uint8_t category;            // FlightCategory
+};
+
+// One check-in counter row: ckco plus the crem / crem_lu of that row
+struct CounterEntry {
+  uint16_t counter;
+  uint16_t remark;
+  uint16_t remarkLu;
+  uint16_t next; // next CounterEntry + 1, 0 = end
+};
+
+struct FlightStoreStats {
+  uint16_t flights;
+  uint16_t counters;
+  uint16_t interned;
+  uint32_t poolUsed;
+  uint32_t droppedFlights; // store or pool full
+  uint32_t droppedValues;
+  uint32_t droppedCounters;
+};
+
+bool FlightStore_Init();
+void FlightStore_Clear();
+int FlightStore_Find(FlightCategory category, FlightKey key); // -1 none
+int FlightStore_FindOrAdd(FlightCategory category, FlightKey key); // -1 full
+bool FlightStore_SetField(int rec, FieldId id, const char *value, size_t len);
+bool FlightStore_AddCounter(int rec, const char *counter, const char *remark,
+                            const char *remarkLu);
+int FlightStore_Count();
+// Scraper and uploader tasks share the store; hold the lock per row / flight
+void FlightStore_Lock();
+void FlightStore_Unlock();
+int FlightStore_TakeDirty(int16_t *recs, int max); // changed since last call
+const FlightRecord *FlightStore_Get(int rec);
+const CounterEntry *FlightStore_GetCounter(uint16_t entry);
+const char *FlightStore_Text(uint16_t offset);
+FlightStoreStats FlightStore_GetStats();
+void FlightStore_PrintStats();
+
+// ============ FLIGHT QUEUE FUNCTIONS (FlightQueue.cpp) ============
+// Lock-free single-producer/single-consumer ring of flight store records,
+// scraper task -> uploader task; a side only blocks when it is full / empty
+#define FLIGHT_QUEUE_SLOTS 256 // power of two
+
+void FlightQueue_Begin(); // consumer, before the producer starts
+void FlightQueue_Push(int16_t rec); // producer; waits while the ring is full
+void FlightQueue_Publish();         // producer; makes pushed records visible
+void FlightQueue_Close();           // producer; no more records this cycle
+bool FlightQueue_Pop(int16_t &rec); // consumer; false when nothing published
+bool FlightQueue_Wait(); // consumer; false once closed and empty
+
+// ============ SNAPSHOT FUNCTIONS (Snapshot.cpp) ============
+// Per-field hashes of the last successful RTDB write of every flight, kept on
+// LittleFS so unchanged flights/fields are not uploaded again
+#define SNAPSHOT_PATH "/snapshot.bin"
+#define SNAPSHOT_TEMP_PATH "/snapshot.tmp"
+#define SNAPSHOT_CAPACITY FLIGHT_STORE_CAPACITY
+#define SNAPSHOT_FULL_SYNC_CYCLES 12 // send everything every Nth cycle
+#define SNAPSHOT_WRITE_ATTEMPTS 2    // file writes per save before giving up
+
+enum SnapshotChange : uint8_t {
+  SNAPSHOT_NEW,       // not in the snapshot, all fields sent
+  SNAPSHOT_CHANGED,   // some fields differ, only those sent
+  SNAPSHOT_UNCHANGED, // nothing to send
+  SNAPSHOT_CHANGE_COUNT
+};
+
+struct SnapshotStats {
+  uint16_t flights[SNAPSHOT_CHANGE_COUNT]; // this cycle, by SnapshotChange
+  uint16_t fieldsChanged;
+  uint16_t stored; // flights in the baseline of the next cycle
+  bool fullSync;   // this cycle sends every field regardless
+};
+
+bool Snapshot_Init(); // after LittleFS_Init()
+void Snapshot_BeginCycle();
+SnapshotChange Snapshot_Diff(const FlightRecord &flight, FieldMask &changed);
+bool Snapshot_Has(FlightCategory category, FlightKey key); // last cycle
+bool Snapshot_Carry(FlightCategory category, FlightKey key); // unchanged page
+void Snapshot_Stage(const FlightRecord &flight, FieldMask fields); // as sent
+void Snapshot_Commit(const FlightRecord &flight, FieldMask written);
+bool Snapshot_Save(); // false: baseline kept in RAM, file not written
+SnapshotStats Snapshot_GetStats();
+void Snapshot_PrintStats();
+
+// ============ BATCH UPLOAD FUNCTIONS (BatchUpload.cpp) ============
+// Multi-location PATCH at /flights/Islamabad with "<category>/<key>/<field>"
+// keys, written into one preallocated buffer and cut by a byte budget
+#define BATCH_BUFFER_BYTES 32768  // payload buffer, the largest single chunk
+#define BATCH_DEFAULT_BUDGET 8192 // bytes per request
+#define BATCH_MIN_BUDGET 512
+#define BATCH_MAX_FLIGHTS 128 // flights per request
+
+bool Batch_Init();
+void Batch_SetBudget(size_t bytes);
+size_t Batch_GetBudget();
+bool Batch_Add(int rec, FieldMask fields); // false: flush, then add again
+bool Batch_AddPath(const char *path, const char *json, size_t length);
+bool Batch_Flush(); // submits the chunk into the RTDB write window
+int Batch_Drain();  // waits for every chunk; flights written since last drain
+void Batch_Poll();  // services the write window without waiting
+void Batch_Settle(int rec); // waits until no write of this flight is pending
+int Batch_FailedChunks(); // chunks that failed before the last drain
+int Batch_Pending();
+// JSON of one field as Batch_Add() sends it; -1 if empty or larger than size
+int Batch_FormatValue(const FlightRecord &flight, int id, char *dst,
+                      size_t size);
+
+// ============ WRITE-AHEAD LOG FUNCTIONS (WriteAheadLog.cpp) ============
+// Field-level updates that could not be written, kept on LittleFS and
+// replayed (newest value per flight and field) once the RTDB is reachable
+#define WAL_PATH "/wal.log"
+#define WAL_TEMP_PATH "/wal.tmp"
+#define WAL_MAX_BYTES (256 * 1024) // of the 1.4 MB partition
+#define WAL_COMPACT_TARGET (WAL_MAX_BYTES * 3 / 4) // after evicting
+#define WAL_VALUE_MAX 2048 // largest value logged (ckco JSON)
+#define WAL_REOPEN_MS 60000 // unindexed log: appends retry indexing this often
+
+struct WalStats {
+  uint32_t bytes;
+  uint32_t records; // in the log, before compaction
+  uint32_t appended; // totals since boot
+  uint32_t replayed;
+  uint32_t evicted;
+};
+
+bool Wal_Init(); // after LittleFS_Init()
+bool Wal_Append(const FlightRecord &flight, FieldMask fields);
+bool Wal_HasPending();
+int Wal_Replay(); // updates written; the log is removed when all succeed
+WalStats Wal_GetStats();
+
 // ============ ESP32 STATUS VARIABLES ============
-extern String esp32Status;
-extern String esp32StatusIcon;
 extern unsigned long esp32UptimeStart;
 
+// ============ STATUS FUNCTIONS (Status.cpp) ============
+// What the device is doing, for the web UI. A change is pushed as a
+// "status" event to the /api/events subscribers; setting the same status
+// again sends nothing. Progress (page n of m, chunks sent) goes out as
+// "progress" events and is not kept.
+#define STATUS_ICON_MAX 8      // bytes, one emoji
+#define STATUS_MESSAGE_MAX 80
+#define STATUS_EVENT_MAX 160   // one event's JSON
+#define STATUS_HEARTBEAT_MS 30000
+#define STATUS_QUEUE_LENGTH 16 // events waiting for the sender task
+#define STATUS_SENDER_STACK 4096
+#define STATUS_SENDER_PRIORITY 1
+
+struct StatusInfo {
+  char icon[STATUS_ICON_MAX];
+  char message[STATUS_MESSAGE_MAX];
+  uint32_t seq;       // changes since boot, the SSE event id
+  uint32_t changedMs; // millis() of the last change
+};
+
+// Called with "status" or "progress" and the event's JSON, from whichever
+// task set it and without the status lock held; id 0 for progress
+typedef void (*StatusListener)(const char *event, const char *json,
+                               uint32_t id);
+
+void Status_Init();
+void Status_SetListener(StatusListener listener);
+void Status_Set(const char *icon, const char *message);
+void Status_Progress(const char *stage, int done, int total);
+StatusInfo Status_Get();
+int Status_FormatJson(const StatusInfo &status, char *dst, size_t size);
+
 // ============ NTP TIME FUNCTIONS ============
 void NTP_Init();
 String NTP_GetTimeString();
@@ -111,9 +499,34 @@ bool LittleFS_FileExists(String path);
 bool LittleFS_DeleteFile(String path);
 File LittleFS_OpenFile(String path, String mode);
 
+// ============ STATIC ASSET FUNCTIONS (Assets.cpp) ============
+// The web UI files in LittleFS, found once at boot: content type, a strong
+// ETag and whether an up-to-date "<path>.gz" can be sent instead
+#define ASSET_MAX 16
+#define ASSET_PATH_MAX 32
+#define ASSET_ETAG_MAX 32
+#define ASSET_CACHE_CONTROL "private, no-cache" // always revalidated: 304
+
+struct Asset {
+  char path[ASSET_PATH_MAX]; // "/app.js"
+  const char *contentType;
+  uint32_t size;
+  uint32_t gzSize; // 0: no .gz, or it holds other content
+  char etag[ASSET_ETAG_MAX];   // quoted, of the plain file
+  char gzEtag[ASSET_ETAG_MAX]; // quoted, of the .gz
+};
+
+int Assets_Init(); // after LittleFS_Init(); assets found
+const Asset *Assets_Find(const char *path);
+void Assets_Refresh(const char *path); // a file was uploaded or deleted
+
 // ============ SERVER HANDLER FUNCTIONS ============
+#define FILES_MAX_DEPTH 6   // /api/files: deeper directories are not listed
+#define FILES_ENTRY_MAX 320 // one listing entry, path escaped
+
 void Server_Setup();
 void Server_HandleRoot(AsyncWebServerRequest *request);
+bool Server_SendAsset(AsyncWebServerRequest *request, const char *path);
 void Server_HandleListFiles(AsyncWebServerRequest *request);
 void Server_HandleStorageInfo(AsyncWebServerRequest *request);
 void Server_HandleFileUpload(AsyncWebServerRequest *request,
@@ -124,6 +537,9 @@ void Server_HandleDeleteFile(AsyncWebServerRequest *request);
 void Server_HandleDownloadFile(AsyncWebServerRequest *request);
 void Server_HandleGetSettings(AsyncWebServerRequest *request);
 void Server_HandleSaveSettings(AsyncWebServerRequest *request);
+void Server_HandleTrace(AsyncWebServerRequest *request); // trace ring, text
+void Server_HandleMetrics(AsyncWebServerRequest *request); // Prometheus text
+void Server_SetupEvents(); // /api/events (SSE) and the status heartbeat
 
 // ============ OTA FIRMWARE UPDATE FUNCTIONS ============
 void OTA_HandleFileUpload(AsyncWebServerRequest *request,
@@ -146,12 +562,85 @@ void Auth_CleanupExpiredSessions();
 void Firebase_Init();
 bool Firebase_IsReady();
 bool Firebase_ResetConnection();
+bool Firebase_EnsureReady(unsigned long maxWaitMs);
 void Firebase_UploadFlightData(JsonObject flightData);
 void Firebase_PrintResult(AsyncResult &aResult);
 bool Firebase_VerifyUser(const String &apiKey, const String &email,
                          const String &password);
 void Firebase_UpdateLastSyncTime(); // Update Esp33Update timestamp
 
+// RTDB write window: each write gets a slot, matched to its result by task
+// UID; slot i uses its own async client, so writes overlap on the wire
+#define RTDB_MAX_WINDOW 4 // async clients / TLS connections
+#define RTDB_DEFAULT_WINDOW 3
+// Internal RAM per TLS session: 16 KB in + 4 KB out record buffers, the
+// context and, during the handshake, the certificate chain
+#define RTDB_TLS_SESSION_BYTES (32 * 1024)
+#define RTDB_TLS_BUFFER_BYTES (16 * 1024) // largest single allocation
+#define RTDB_UID_MAX 16
+
+enum RtdbWriteKind : uint8_t { RTDB_WRITE_UPDATE, RTDB_WRITE_SET };
+enum RtdbSlotState : uint8_t {
+  RTDB_SLOT_FREE,
+  RTDB_SLOT_PENDING,
+  RTDB_SLOT_BACKOFF, // failed, waiting to be sent again
+  RTDB_SLOT_DONE
+};
+
+#define RTDB_MAX_ATTEMPTS 3 // first try + jittered retries
+
+struct RtdbWriteSlot {
+  char uid[RTDB_UID_MAX];
+  unsigned long startMs;   // current attempt
+  unsigned long timeoutMs; // Rtt_Timeout() when the attempt was sent
+  unsigned long retryAtMs; // RTDB_SLOT_BACKOFF: when to send again
+  RtdbSlotState state;
+  uint8_t attempts;
+  bool ok;
+  bool timedOut; // last attempt got no answer
+};
+
+bool Firebase_WriteWindowInit();
+void Firebase_SetWriteWindow(int window); // 1..what the heap allows
+int Firebase_GetWriteWindow();
+int Firebase_SubmitWrite(RtdbWriteKind kind, const String &path,
+                         const object_t &body); // slot, -1 if window full
+void Firebase_PollWrites(); // app.loop() + timeouts; call while waiting
+bool Firebase_TakeWrite(int slot, RtdbWriteSlot &result); // frees when done
+int Firebase_WritesInFlight();
+
+// ============ RTT ESTIMATOR FUNCTIONS (RttEstimator.cpp) ============
+// Smoothed RTT / variance over completed RTDB writes; write timeouts and
+// retry backoff are derived from it
+#define RTT_INITIAL_TIMEOUT 10000 // ms, until the first sample
+#define RTT_MIN_TIMEOUT 3000      // a reconnect + TLS handshake fits
+#define RTT_MAX_TIMEOUT 60000
+#define RTT_CLOCK_GRANULARITY 10 // ms, the write window poll interval
+#define RTT_BACKOFF_BASE 250     // ms, retry delay ceiling doubles per try
+#define RTT_BACKOFF_CAP 8000
+#define RTT_HISTORY 64 // samples kept for percentiles
+
+struct RttStats {
+  uint32_t srtt;
+  uint32_t rttvar;
+  uint32_t timeout;
+  uint32_t p50;
+  uint32_t p90;
+  uint32_t p99;
+  uint32_t max;
+  uint32_t samples; // totals since boot
+  uint32_t timeouts;
+  uint32_t retries;
+};
+
+void Rtt_AddSample(uint32_t ms);
+void Rtt_OnTimeout();
+void Rtt_OnRetry();
+void Rtt_ResetBackoff();
+uint32_t Rtt_Timeout();
+uint32_t Rtt_BackoffDelay(uint8_t attempt);
+RttStats Rtt_GetStats();
+
 // ============ WEB PAGE & JAVASCRIPT ============
 String GetWebPage();
 String GetAppScript();
@@ -162,23 +651,248 @@ extern String uploadFilename;
 extern size_t uploadTotalSize;
 
 //=============Web Parser Variables=============
+// All WebDavis requests share one keep-alive connection and one session
+#define WEBDAVIS_SESSION_IDLE_MS (20UL * 60 * 1000) // PHP expires at 24 min
+// index.php only pages forward: a page cut off is fetched again by starting
+// its config over, this many times per config
+#define WEBDAVIS_MAX_RESTARTS 1
+
+struct WebDavisStats { // totals since boot
+  uint32_t requests;
+  uint32_t connections; // TCP connections opened
+  uint32_t sessions;    // PHPSESSID fetched with a GET
+  uint32_t rotations;   // the server handed out a new PHPSESSID on a page
+  uint32_t truncated;   // pages that ended before their Content-Length
+};
+
+WebDavisStats WebDavis_GetStats();
+
 // Web scraping helper functions (implemented in websraper.cpp)
 void Fetch(String line, String category, String subCategory);
 void fetchPHPSESSID();
 bool extractPageInfo(String line);
 bool CheckSession(String line);
-void ExtractTDInfoJSON(String trHtml, JsonDocument &doc, String Category,
-                       String subCategory);
-void postRequest(String cnfg, int pg, int pgs, String category,
-                 String subCategory);
+// One <td> reduced to its Field:/Value: pair, in a preallocated slot
+#define CELL_NAME_MAX 16
+#define CELL_VALUE_MAX 64
+#define ROW_MAX_CELLS 32
+
+struct CellField {
+  char name[CELL_NAME_MAX];
+  char value[CELL_VALUE_MAX];
+  uint8_t nameLen;
+  uint8_t valueLen;
+  FieldId id;     // set by the caller once the cell is accepted
+  bool truncated; // value longer than CELL_VALUE_MAX - 1
+};
+
+struct RowFields {
+  CellField cells[ROW_MAX_CELLS];
+  uint8_t count;
+  FieldMask present; // ids of the accepted cells
+};
+
+bool ExtractCellField(const char *cell, size_t len, CellField &out);
+void CommitRowFields(RowFields &row, const String &category,
+                     const String &subCategory);
+int postRequest(String cnfg, int pg, int pgs, String category,
+                String subCategory); // HTTP status or HTTPC_ERROR_*
 
 // HTML Parsing & JSON Extraction
 void parseFlightTableRow(String tableRowHtml, JsonDocument &doc,
                          String category, String subCategory);
 
+// Flight field helpers (websraper.cpp / Globals.cpp)
+size_t SanitizeFlightNumber(char *flnr, size_t len); // in place
+time_t ParseKeySTMTime(String keySTM);
+bool IsFieldManaged(const String &key);
+
 void WiFi_STA_Reconnect_Handler();
 bool UpdateFlight(String category, String flightKey,
                   const JsonDocument &fieldsToUpdate);
-bool UpdateFlightsBatch(String category, JsonObject flightsToUpdate);
-DynamicJsonDocument *CreateFilteredFlightDoc(JsonObject source);
+DynamicJsonDocument *CreateFilteredFlightDoc(const FlightRecord &flight,
+                                             FieldMask fields);
+
+// ============ ROW TOKENIZER FUNCTIONS (RowTokenizer.cpp) ============
+#define TOKENIZER_ROW_BUFFER 4096 // longest <tr>..</tr> kept, lines trimmed
+#define TOKENIZER_LINE_BUFFER 512 // text outside rows, for page/session markers
+#define TOKENIZER_CHUNK_SIZE 512  // bytes pulled from the WiFiClient per read
+
+enum TokenizerEvent {
+  TOKEN_LINE,       // trimmed line outside any row
+  TOKEN_ROW_BEGIN,  // <tr class='row_0|1'> seen
+  TOKEN_CELL,       // one complete <td ...>...</td>
+  TOKEN_ROW_END,    // </tr> seen, data is the whole NUL-terminated row
+  TOKEN_ROW_DROPPED // row overflowed the buffer or page ended mid-row
+};
+
+typedef void (*TokenizerCallback)(TokenizerEvent event, const char *data,
+                                  size_t len, void *context);
+
+struct RowTokenizer {
+  char row[TOKENIZER_ROW_BUFFER];
+  char line[TOKENIZER_LINE_BUFFER];
+  char tail[20]; // last bytes seen, for tags split across chunks
+  size_t rowLen;
+  size_t lineLen;
+  size_t tailLen;
+  size_t cellStart; // offset of the open <td in row
+  bool inRow;
+  bool rowOverflow;
+  bool atLineStart;
+  uint32_t rowsDropped;
+  TokenizerCallback callback;
+  void *context;
+};
+
+void Tokenizer_Begin(RowTokenizer &tok, TokenizerCallback callback,
+                     void *context);
+void Tokenizer_Feed(RowTokenizer &tok, const char *data, size_t len);
+void Tokenizer_End(RowTokenizer &tok);
+
+// ============ PAGE PACING FUNCTIONS (Pacing.cpp) ============
+// Gap between WebDavis page requests: the configured rate, backed off on slow
+// or failed pages; page counts and timings per config plan the next cycle
+#define PACING_DEFAULT_RATE 20 // page requests per minute
+#define PACING_MIN_GAP_MS 250  // idle time after every request
+#define PACING_MAX_INTERVAL_MS 30000
+#define PACING_STEP_MS 500  // recovery per good page
+#define PACING_SLOW_MS 5000 // a slower page backs off
+#define PACING_SLOW_FACTOR 3 // ... and so does one 3x the usual latency
+#define PACING_SLOW_FLOOR_MS 1000 // ... if also slower than this (LAN jitter)
+#define PACING_MAX_ERRORS 5 // failed pages in a row: the config is dropped
+#define PACING_MAX_CONFIGS 8
+#define PACING_CONFIG_NAME_MAX 40
+
+struct PacingConfigStats {
+  char config[PACING_CONFIG_NAME_MAX];
+  uint16_t pages;    // last fetch
+  uint16_t errors;
+  uint32_t latency;  // ms, smoothed page response time
+  uint32_t interval; // ms from request start to request start, at the end
+  uint32_t duration; // ms, whole config
+};
+
+struct PacingStats {
+  uint32_t rate;    // target, requests per minute
+  uint32_t planned; // ms of fetching expected this cycle
+  uint32_t fetched; // ms the last fetch of every config took
+  uint32_t backoffs; // totals since boot
+  uint32_t errors;
+};
+
+void Pacing_SetRate(uint32_t perMinute);
+uint32_t Pacing_PlanCycle(); // ms, from the configs fetched so far
+void Pacing_Begin(const char *config);
+// After each page; waitMs is the pause before the next request. False when
+// the config failed PACING_MAX_ERRORS times in a row.
+bool Pacing_PageDone(uint32_t latencyMs, bool ok, uint32_t &waitMs);
+void Pacing_End(int pages);
+PacingStats Pacing_GetStats();
+int Pacing_GetConfigs(PacingConfigStats *out, int max);
+
+// ============ PAGE CACHE FUNCTIONS (PageCache.cpp) ============
+// xxHash32 of the rows of every WebDavis page, per config and page number; a
+// page that hashes as it did last cycle is not parsed and its flights are
+// carried over in the snapshot
+#define PAGE_CACHE_ARENA_BYTES (256 * 1024) // PSRAM, bodies not decided yet
+#define PAGE_CACHE_MAX_PAGES 64   // pages remembered, all configs
+#define PAGE_CACHE_MAX_KEYS 1024  // flights on those pages
+#define PAGE_CACHE_MAX_PENDING 16 // pages of one config held in the arena
+
+struct PageCacheStats {
+  uint16_t hits;     // this cycle: pages skipped
+  uint16_t misses;   // pages parsed: new, changed or not comparable
+  uint16_t forced;   // unchanged, parsed anyway: a flight on it was parsed
+  uint16_t carried;  // rows of skipped pages, their flights carried over
+  uint32_t skippedBytes;
+  bool enabled;      // off on full syncs and after a failed cycle
+  uint32_t totalHits; // since boot
+  uint32_t totalMisses;
+};
+
+// Parses one held page body with its rows; see PageCache_AddPage()
+typedef void (*PageCacheParser)(const char *body, size_t len, void *context);
+
+bool PageCache_Init(); // PSRAM arena; without it every page is parsed
+void PageCache_BeginCycle(bool enabled); // after Snapshot_BeginCycle()
+// Pages of a config whose flights merge across pages (check-in counters) are
+// skipped all together or not at all
+void PageCache_BeginConfig(const char *config, bool wholeConfig);
+char *PageCache_Reserve(size_t &capacity); // nullptr: parse while reading
+void PageCache_HashRow(const char *row, size_t len); // rows of that body
+// Body read into the reserved room: parsed now, held, or skipped
+void PageCache_AddPage(int page, size_t len, PageCacheParser parser,
+                       void *context);
+void PageCache_Overflow(PageCacheParser parser, void *context); // body > room
+void PageCache_NoteFlight(FlightCategory category, FlightKey key); // parsed
+void PageCache_EndConfig(PageCacheParser parser, void *context);
+void PageCache_EndCycle(bool clean); // false: no hits next cycle
+PageCacheStats PageCache_GetStats();
+
+// ============ SYNC CYCLE FUNCTIONS (Sync.cpp) ============
+// A scraper task on the other core fetches and parses pages; the calling
+// (loop) task uploads each page's flights while the next page is fetched
+#define SYNC_SCRAPER_CORE 0
+#define SYNC_SCRAPER_STACK 16384
+#define SYNC_SCRAPER_PRIORITY 1
+
+bool Sync_RunCycle(); // false: nothing scraped or updates had to be logged
+void Sync_PageParsed(); // scraper, after each page: queue changed flights
+// Off: one UpdateFlight() per changed flight, each waited for, as before
+// batching; for comparing round trips (host harness)
+void Sync_SetBatching(bool enabled);
+
+// ============ HEALTH FUNCTIONS (Health.cpp) ============
+// Cycles run back to back on a timer; the device restarts only when a health
+// indicator crosses its threshold, and the reason is kept in NVS
+#define HEALTH_MIN_LARGEST_BLOCK (24 * 1024) // bytes, TLS needs ~20 KB
+#define HEALTH_MAX_FAILED_CYCLES 3           // in a row
+#define HEALTH_STALL_MS 180000 // no progress: one watchdog miss; a write
+                               // with all its retries fits
+#define HEALTH_MAX_WATCHDOG_MISSES 2 // in a row
+#define HEALTH_WATCHDOG_PERIOD_MS 10000
+#define HEALTH_WATCHDOG_CORE 0
+#define HEALTH_WATCHDOG_STACK 4096
+#define HEALTH_WATCHDOG_PRIORITY 1
+#define HEALTH_HISTORY 8 // restart records kept in NVS
+
+enum HealthReason : uint8_t {
+  HEALTH_OK,
+  HEALTH_LOW_HEAP,        // largest free block below the threshold
+  HEALTH_FAILED_CYCLES,   // too many failed cycles in a row
+  HEALTH_WATCHDOG,        // sync made no progress
+  HEALTH_FIRMWARE_UPDATE, // OTA
+  HEALTH_CRASH,           // panic, hardware watchdog or brownout
+  HEALTH_REASON_COUNT
+};
+extern const char *HEALTH_REASON_NAMES[HEALTH_REASON_COUNT];
+
+struct HealthRestart {
+  uint8_t reason; // HealthReason
+  uint8_t reserved[3];
+  uint32_t value;  // what crossed the threshold (bytes, cycles, s, reset code)
+  uint32_t uptime; // s
+  uint32_t cycles; // since that boot
+};
+
+struct HealthStats {
+  uint32_t cycles; // since boot
+  uint16_t failedCycles;
+  uint16_t watchdogMisses;
+  uint32_t largestBlock; // after the last cycle
+  uint32_t minLargestBlock;
+  uint32_t heartbeatAge; // ms since the last progress
+  uint32_t restarts;     // recorded in NVS, all boots
+  uint32_t restartsByReason[HEALTH_REASON_COUNT];
+};
+
+void Health_Init(); // records a crash, starts the watchdog task
+void Health_Feed(); // sync or loop() made progress
+void Health_CycleDone(bool ok);
+HealthReason Health_Check(uint32_t &value); // after a cycle
+void Health_Record(HealthReason reason, uint32_t value); // before a restart
+void Health_Restart(HealthReason reason, uint32_t value); // records, restarts
+HealthStats Health_GetStats();
+int Health_GetHistory(HealthRestart *out, int max); // newest first
 #endif
@@ -2,129 +2,149 @@
 #include "Global.h"
 
 unsigned long lastFetchTime = 0;
-const unsigned long FETCH_INTERVAL = 300000; // 10 minutes in milliseconds
+const unsigned long FETCH_INTERVAL = 300000; // 5 min from one cycle's end to the next
 bool Start = true;
 
 // ============ ESP32 STATUS VARIABLES ============
-String esp32Status = "System starting...";
-String esp32StatusIcon = "🚀";
 unsigned long esp32UptimeStart = 0;
 
 // ============ HELPER FUNCTIONS ============
 // ESP32-MANAGED FIELDS: All fields that ESP32 is responsible for updating
+// (the list itself is MANAGED_FIELD_LIST in Global.h)
 const char *MANAGED_FIELDS[] = {
-    "stm",     // Time
-    "flnr",    // Flight No
-    "ect",     // Estimated Time
-    "att",     // Actual Time
-    "blt1",    // Belt
-    "bre1",    // Status
-    "city_lu", // City
-    "via1_lu", // Via
-    "prem_lu", // Remark
-    "fsta_lu", // FSTA
-    "cro1",    // Zone
-    "cctf",    // Check-In From
-    "cctt",    // Check-In To
-    "gat1",    // Gate
-    "crow",    // Row
-    "ckco",    // Counter
-    "aopn",    // Open
-    "aclo",    // Close
-    "crem",    // Remark
-    "crem_lu", // Remark
-    "SubCat"   // Category
+#define FIELD_NAME_ENTRY(id, name) name,
+    MANAGED_FIELD_LIST(FIELD_NAME_ENTRY)
+#undef FIELD_NAME_ENTRY
 };
-const int MANAGED_FIELDS_COUNT = 21;
+const int MANAGED_FIELDS_COUNT = FIELD_COUNT;
 
-// Helper function to check if a field is managed by ESP32
-bool IsFieldManaged(const String &key) {
-  for (int i = 0; i < MANAGED_FIELDS_COUNT; i++) {
-    if (key == MANAGED_FIELDS[i]) {
-      return true;
-    }
-  }
-  return false;
+// Slot -> FieldId table for FieldHash, filled at compile time
+constexpr uint8_t FieldIdForSlot(int slot, int id) {
+  return id >= FIELD_COUNT      ? (uint8_t)FIELD_UNKNOWN
+         : FieldSlot(id) == slot ? (uint8_t)id
+                                 : FieldIdForSlot(slot, id + 1);
+}
+#define FIELD_SLOT_4(n)                                                        \
+  FieldIdForSlot(n, 0), FieldIdForSlot(n + 1, 0), FieldIdForSlot(n + 2, 0),    \
+      FieldIdForSlot(n + 3, 0)
+static constexpr uint8_t FIELD_SLOT_TABLE[FIELD_HASH_SLOTS] = {
+    FIELD_SLOT_4(0),  FIELD_SLOT_4(4),  FIELD_SLOT_4(8),  FIELD_SLOT_4(12),
+    FIELD_SLOT_4(16), FIELD_SLOT_4(20), FIELD_SLOT_4(24), FIELD_SLOT_4(28)};
+#undef FIELD_SLOT_4
+
+// Hash to the only candidate, then one length + memcmp check to reject names
+// that are not managed
+FieldId Field_Lookup(const char *name, size_t len) {
+  if (len == 0)
+    return FIELD_UNKNOWN;
+  uint8_t id = FIELD_SLOT_TABLE[FieldHash(name, len)];
+  if (id == FIELD_UNKNOWN)
+    return FIELD_UNKNOWN;
+  const char *candidate = FIELD_NAMES[id];
+  if (strlen(candidate) != len || memcmp(candidate, name, len) != 0)
+    return FIELD_UNKNOWN;
+  return (FieldId)id;
 }
 
-// Helper function to check if a value is empty, null, or just whitespace
-bool IsValueEmpty(JsonVariant value) {
-  if (value.isNull()) {
-    return true;
-  }
-
-  // For strings, check if empty or just whitespace
-  if (value.is<String>()) {
-    String strValue = value.as<String>();
-    strValue.trim();
-    if (strValue.length() == 0) {
-      return true;
-    }
-  }
-
-  // For objects (like ckco), check if it's empty
-  if (value.is<JsonObject>()) {
-    JsonObject obj = value.as<JsonObject>();
-    if (obj.size() == 0) {
-      return true;
-    }
-  }
-
-  // For arrays, check if empty
-  if (value.is<JsonArray>()) {
-    JsonArray arr = value.as<JsonArray>();
-    if (arr.size() == 0) {
-      return true;
-    }
+// Comma separated names of the fields in mask, in FieldId order
+size_t Field_FormatList(FieldMask mask, char *out, size_t size) {
+  size_t used = 0;
+  if (size == 0)
+    return 0;
+  out[0] = '\0';
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (!(mask & FIELD_BIT(id)))
+      continue;
+    int n = snprintf(out + used, size - used, "%s%s", used ? ", " : "",
+                     FIELD_NAMES[id]);
+    if (n < 0 || (size_t)n >= size - used)
+      break;
+    used += n;
   }
+  return used;
+}
 
-  return false;
+// Helper function to check if a field is managed by ESP32
+bool IsFieldManaged(const String &key) {
+  return Field_Lookup(key.c_str(), key.length()) != FIELD_UNKNOWN;
 }
 
 // Create filtered flight document for Firebase upload
 // IMPORTANT: Only includes fields that:
 // 1. Are in MANAGED_FIELDS (ESP32 managed)
-// 2. Have actual values (not empty, null, or whitespace)
+// 2. Have actual values (not empty)
+// 3. Are in fields (the ones the snapshot says changed)
 // This ensures we don't overwrite existing data with empty values
-DynamicJsonDocument *CreateFilteredFlightDoc(JsonObject source) {
-  DynamicJsonDocument *filteredDoc = new DynamicJsonDocument(512);
+// Values point into the flight store's pool; the document must be used
+// before the store is cleared.
+// Store text goes in as const char *, which ArduinoJson links instead of
+// copying, so the document needs only its slots: one per field, one per
+// counter and two remarks per check-in row
+static size_t FilteredDocCapacity(const FlightRecord &flight,
+                                  FieldMask fields) {
+  size_t rows = 0;
+  if (flight.present & fields & FIELD_BIT(FIELD_CKCO)) {
+    for (const CounterEntry *entry = FlightStore_GetCounter(flight.ckcoHead);
+         entry; entry = FlightStore_GetCounter(entry->next))
+      rows++;
+  }
+  return JSON_OBJECT_SIZE(FIELD_COUNT) + JSON_OBJECT_SIZE(rows) +
+         JSON_ARRAY_SIZE(2 * rows);
+}
+
+// Check overflowed() on the result: a document that could not be
+// allocated in full is missing fields
+DynamicJsonDocument *CreateFilteredFlightDoc(const FlightRecord &flight,
+                                             FieldMask fields) {
+  DynamicJsonDocument *filteredDoc =
+      new DynamicJsonDocument(FilteredDocCapacity(flight, fields));
   JsonObject destObj = filteredDoc->to<JsonObject>();
 
-  int fieldCount = 0;
-  int skippedCount = 0;
-  String fieldsList = "";
-  String skippedList = "";
-
-  for (JsonPair p : source) {
-    String key = String(p.key().c_str());
-
-    // Only process managed fields
-    if (IsFieldManaged(key)) {
-      // Check if value is empty/null
-      if (IsValueEmpty(p.value())) {
-        skippedCount++;
-        if (skippedList.length() > 0)
-          skippedList += ", ";
-        skippedList += key;
-        continue; // Skip this field - don't send empty values
+  FieldMask included = 0;
+  FieldMask skipped = 0;
+
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (!(flight.present & fields & FIELD_BIT(id)))
+      continue;
+
+    if (id == FIELD_CKCO) {
+      // { "<counter>": [crem, crem_lu, ...] } in the order rows arrived
+      JsonObject counters = destObj.createNestedObject(FIELD_NAMES[id]);
+      for (const CounterEntry *entry = FlightStore_GetCounter(flight.ckcoHead);
+           entry; entry = FlightStore_GetCounter(entry->next)) {
+        const char *counter = FlightStore_Text(entry->counter);
+        JsonArray remarks = counters[counter].as<JsonArray>();
+        if (remarks.isNull())
+          remarks = counters.createNestedArray(counter);
+        remarks.add(FlightStore_Text(entry->remark));
+        remarks.add(FlightStore_Text(entry->remarkLu));
       }
+      included |= FIELD_BIT(id);
+      continue;
+    }
 
-      // Field has a valid value, include it
-      destObj[key] = p.value();
-      fieldCount++;
-      if (fieldsList.length() > 0)
-        fieldsList += ", ";
-      fieldsList += key;
+    const char *value = FlightStore_Text(flight.value[id]);
+    if (*value == '\0') {
+      skipped |= FIELD_BIT(id);
+      continue; // Skip this field - don't send empty values
     }
+
+    destObj[FIELD_NAMES[id]] = value;
+    included |= FIELD_BIT(id);
   }
 
   // Log what fields we're including and skipping
-  Serial.printf("  📋 Including %d fields: %s\n", fieldCount,
-                fieldsList.c_str());
-  if (skippedCount > 0) {
-    Serial.printf("  ⏭️  Skipped %d empty fields: %s\n", skippedCount,
-                  skippedList.c_str());
+  if (LOG_ENABLED(VERBOSE)) {
+    char list[160];
+    Field_FormatList(included, list, sizeof(list));
+    LOG_VERBOSE("  📋 Including %d fields: %s\n", __builtin_popcount(included),
+                list);
+    if (skipped) {
+      Field_FormatList(skipped, list, sizeof(list));
+      LOG_VERBOSE("  ⏭️  Skipped %d empty fields: %s\n",
+                  __builtin_popcount(skipped), list);
+    }
   }
 
   return filteredDoc;
-}
\ No newline at end of file
+}
@@ -0,0 +1,189 @@
+#include "Global.h"
+
+#include <Preferences.h>
+
+// ============ HEALTH ============
+// The device used to restart after every cycle. It now stays up and
+// restarts only when one of these crosses its threshold:
+//
+//   largest free heap block   checked after every cycle; a TLS handshake
+//                             needs one contiguous block
+//   consecutive failed cycles nothing scraped, or updates had to be logged
+//   watchdog misses           no sync progress for HEALTH_STALL_MS, counted
+//                             by a task of its own so a hung cycle is seen
+//
+// Every restart is recorded in NVS before it happens, and so is a crash,
+// found from the reset reason at the next boot. The last HEALTH_HISTORY
+// records are kept, and a count per reason over all boots.
+
+#define HEALTH_NVS_NAMESPACE "health"
+
+const char *HEALTH_REASON_NAMES[HEALTH_REASON_COUNT] = {
+    "none", "low heap", "failed cycles", "watchdog", "firmware update",
+    "crash"};
+
+static volatile uint32_t heartbeat = 0; // millis() of the last progress
+static uint32_t cycles = 0;
+static uint16_t failedCycles = 0;
+static volatile uint16_t watchdogMisses = 0;
+static uint32_t largestBlock = 0;
+static uint32_t minLargestBlock = 0xFFFFFFFF;
+static uint32_t restartCount = 0; // all boots, from NVS
+static uint32_t reasonCounts[HEALTH_REASON_COUNT] = {};
+static HealthRestart history[HEALTH_HISTORY];
+static uint8_t historyCount = 0;
+
+static void Health_Load() {
+  Preferences prefs;
+  if (!prefs.begin(HEALTH_NVS_NAMESPACE, true))
+    return; // first boot: nothing stored yet
+  restartCount = prefs.getUInt("count", 0);
+  size_t size = prefs.getBytesLength("history");
+  if (size <= sizeof(history) && size % sizeof(HealthRestart) == 0) {
+    prefs.getBytes("history", history, size);
+    historyCount = size / sizeof(HealthRestart);
+  }
+  // Stored since the counts were added; before that only the history tells
+  if (prefs.getBytesLength("reasons") == sizeof(reasonCounts)) {
+    prefs.getBytes("reasons", reasonCounts, sizeof(reasonCounts));
+  } else {
+    for (int i = 0; i < historyCount; i++)
+      if (history[i].reason < HEALTH_REASON_COUNT)
+        reasonCounts[history[i].reason]++;
+  }
+  prefs.end();
+}
+
+// Newest first, so the record that is dropped is always the oldest
+void Health_Record(HealthReason reason, uint32_t value) {
+  if (historyCount < HEALTH_HISTORY)
+    historyCount++;
+  memmove(&history[1], &history[0],
+          (historyCount - 1) * sizeof(HealthRestart));
+  history[0] = {};
+  history[0].reason = reason;
+  history[0].value = value;
+  history[0].uptime = millis() / 1000;
+  history[0].cycles = cycles;
+  restartCount++;
+  reasonCounts[reason]++;
+
+  Preferences prefs;
+  if (!prefs.begin(HEALTH_NVS_NAMESPACE, false)) {
+    Serial.println("❌ Cannot open NVS, restart reason not saved");
+    return;
+  }
+  prefs.putUInt("count", restartCount);
+  prefs.putBytes("history", history, historyCount * sizeof(HealthRestart));
+  prefs.putBytes("reasons", reasonCounts, sizeof(reasonCounts));
+  prefs.end();
+}
+
+static void Health_WatchdogTask(void *parameters) {
+  (void)parameters;
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(HEALTH_WATCHDOG_PERIOD_MS));
+    uint32_t age = millis() - heartbeat;
+    if (age < HEALTH_STALL_MS)
+      continue;
+    // Counted once per stall period, so misses measure how long it hangs
+    heartbeat = millis();
+    watchdogMisses++;
+    Serial.printf("⚠️ Watchdog: no sync progress for %lu s (miss %u of %d)\n",
+                  (unsigned long)(age / 1000), watchdogMisses,
+                  HEALTH_MAX_WATCHDOG_MISSES);
+    if (watchdogMisses >= HEALTH_MAX_WATCHDOG_MISSES)
+      Health_Restart(HEALTH_WATCHDOG, watchdogMisses * (HEALTH_STALL_MS / 1000));
+  }
+}
+
+void Health_Init() {
+  Health_Load();
+
+  // A software restart was recorded by whoever asked for it
+  esp_reset_reason_t reset = esp_reset_reason();
+  if (reset == ESP_RST_PANIC || reset == ESP_RST_INT_WDT ||
+      reset == ESP_RST_TASK_WDT || reset == ESP_RST_WDT ||
+      reset == ESP_RST_BROWNOUT) {
+    Health_Record(HEALTH_CRASH, reset);
+    history[0].uptime = 0; // unknown, the crashed boot could not say
+  }
+
+  if (historyCount) {
+    Serial.printf("🩺 %lu restart(s) recorded, last: %s (value %lu, after "
+                  "%lu s and %lu cycles)\n",
+                  (unsigned long)restartCount,
+                  HEALTH_REASON_NAMES[history[0].reason],
+                  (unsigned long)history[0].value,
+                  (unsigned long)history[0].uptime,
+                  (unsigned long)history[0].cycles);
+  }
+
+  heartbeat = millis();
+  if (xTaskCreatePinnedToCore(Health_WatchdogTask, "watchdog",
+                              HEALTH_WATCHDOG_STACK, nullptr,
+                              HEALTH_WATCHDOG_PRIORITY, nullptr,
+                              HEALTH_WATCHDOG_CORE) != pdPASS)
+    Serial.println("❌ Cannot start the watchdog task");
+}
+
+void Health_Feed() {
+  heartbeat = millis();
+  watchdogMisses = 0;
+}
+
+void Health_CycleDone(bool ok) {
+  cycles++;
+  failedCycles = ok ? 0 : failedCycles + 1;
+  largestBlock = ESP.getMaxAllocHeap();
+  if (largestBlock < minLargestBlock)
+    minLargestBlock = largestBlock;
+  Serial.printf("🩺 Cycle %lu %s, %u failed in a row, largest free block "
+                "%lu bytes\n",
+                (unsigned long)cycles, ok ? "ok" : "failed", failedCycles,
+                (unsigned long)largestBlock);
+}
+
+HealthReason Health_Check(uint32_t &value) {
+  if (largestBlock && largestBlock < HEALTH_MIN_LARGEST_BLOCK) {
+    value = largestBlock;
+    return HEALTH_LOW_HEAP;
+  }
+  if (failedCycles >= HEALTH_MAX_FAILED_CYCLES) {
+    value = failedCycles;
+    return HEALTH_FAILED_CYCLES;
+  }
+  value = 0;
+  return HEALTH_OK;
+}
+
+void Health_Restart(HealthReason reason, uint32_t value) {
+  Serial.printf("\n🔄 RESTARTING: %s (value %lu)\n", HEALTH_REASON_NAMES[reason],
+                (unsigned long)value);
+  char message[STATUS_MESSAGE_MAX];
+  snprintf(message, sizeof(message), "Restarting: %s",
+           HEALTH_REASON_NAMES[reason]);
+  Status_Set("🔄", message);
+  Health_Record(reason, value);
+  delay(500);
+  ESP.restart();
+}
+
+HealthStats Health_GetStats() {
+  HealthStats stats = {};
+  stats.cycles = cycles;
+  stats.failedCycles = failedCycles;
+  stats.watchdogMisses = watchdogMisses;
+  stats.largestBlock = largestBlock;
+  stats.minLargestBlock = minLargestBlock == 0xFFFFFFFF ? 0 : minLargestBlock;
+  stats.heartbeatAge = millis() - heartbeat;
+  stats.restarts = restartCount;
+  memcpy(stats.restartsByReason, reasonCounts, sizeof(reasonCounts));
+  return stats;
+}
+
+int Health_GetHistory(HealthRestart *out, int max) {
+  int count = historyCount < max ? historyCount : max;
+  memcpy(out, history, count * sizeof(HealthRestart));
+  return count;
+}
@@ -0,0 +1,191 @@
+#include "Global.h"
+
+#include <stdarg.h>
+
+// ============ METRICS ============
+// Totals since boot for the monitoring box, which scrapes /metrics every
+// 15 s. Recording is one relaxed atomic add per counter or bucket, taken on
+// whichever core the event happens; a scrape reads the values while a sync
+// runs, so a histogram's buckets and its sum may be one observation apart.
+// Formatting goes to a caller's buffer with snprintf, no String is built.
+//
+// Histograms keep their own units (us or ms) and are exposed in seconds,
+// Prometheus' base unit. The bucket bounds are fixed; the +Inf bucket is
+// the observation count.
+
+struct CounterInfo {
+  const char *name;
+  const char *help;
+};
+
+struct HistogramInfo {
+  const char *name;
+  const char *help;
+  uint32_t perSecond; // 1000000 for us, 1000 for ms
+  uint32_t bounds[METRICS_BUCKETS];
+};
+
+static const CounterInfo COUNTERS[METRIC_COUNTER_COUNT] = {
+    {"wfs_pages_fetched_total", "WebDavis pages read in full"},
+    {"wfs_page_errors_total", "WebDavis pages that failed or were cut off"},
+    {"wfs_rows_parsed_total", "Flight table rows tokenized"},
+    {"wfs_flights_uploaded_total", "Flights in successful RTDB writes"},
+    {"wfs_flights_skipped_total", "Flights unchanged since their last upload"},
+    {"wfs_flights_failed_total",
+     "Flights written to the write-ahead log instead of the RTDB"},
+};
+
+static const HistogramInfo HISTOGRAMS[METRIC_HISTOGRAM_COUNT] = {
+    {"wfs_page_scan_seconds",
+     "Pager scan and row hashing of a page held in the page cache",
+     1000000,
+     {250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000}},
+    {"wfs_page_parse_seconds", "Tokenizing one page's rows into the store",
+     1000000,
+     {500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000, 500000}},
+    {"wfs_rtdb_rtt_seconds", "RTDB write round trip",
+     1000,
+     {50, 100, 200, 300, 500, 750, 1000, 2000, 5000, 10000}},
+    {"wfs_cycle_seconds", "Duration of one sync cycle",
+     1000,
+     {10000, 20000, 30000, 45000, 60000, 90000, 120000, 180000, 300000,
+      600000}},
+};
+
+struct HistogramData {
+  uint32_t buckets[METRICS_BUCKETS + 1]; // not cumulative; last is +Inf
+  uint64_t sum;
+};
+
+static uint32_t counters[METRIC_COUNTER_COUNT];
+static HistogramData histograms[METRIC_HISTOGRAM_COUNT];
+
+void Metrics_Add(MetricCounter counter, uint32_t n) {
+  __atomic_fetch_add(&counters[counter], n, __ATOMIC_RELAXED);
+}
+
+void Metrics_Observe(MetricHistogram histogram, uint32_t value) {
+  const uint32_t *bounds = HISTOGRAMS[histogram].bounds;
+  int bucket = 0;
+  while (bucket < METRICS_BUCKETS && value > bounds[bucket])
+    bucket++;
+  HistogramData &data = histograms[histogram];
+  __atomic_fetch_add(&data.buckets[bucket], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&data.sum, (uint64_t)value, __ATOMIC_RELAXED);
+}
+
+// ============ TEXT FORMAT ============
+struct MetricsText {
+  char *dst;
+  size_t size;
+  size_t used;
+};
+
+static void Append(MetricsText &out, const char *format, ...) {
+  if (out.used + 1 >= out.size)
+    return;
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(out.dst + out.used, out.size - out.used, format, args);
+  va_end(args);
+  if (n > 0)
+    out.used = min(out.used + n, out.size - 1);
+}
+
+static void AppendHeader(MetricsText &out, const char *name, const char *type,
+                         const char *help) {
+  Append(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void AppendValue(MetricsText &out, const char *name, const char *type,
+                        const char *help, unsigned long long value) {
+  AppendHeader(out, name, type, help);
+  Append(out, "%s %llu\n", name, value);
+}
+
+// value / perSecond with exact decimals: 1500 ms -> "1.500"
+static void AppendSeconds(MetricsText &out, uint64_t value,
+                          uint32_t perSecond) {
+  int digits = perSecond == 1000000 ? 6 : 3;
+  Append(out, "%llu.%0*llu", (unsigned long long)(value / perSecond), digits,
+         (unsigned long long)(value % perSecond));
+}
+
+static void AppendHistogram(MetricsText &out, MetricHistogram histogram) {
+  const HistogramInfo &info = HISTOGRAMS[histogram];
+  const HistogramData &data = histograms[histogram];
+  AppendHeader(out, info.name, "histogram", info.help);
+  uint32_t cumulative = 0;
+  for (int i = 0; i <= METRICS_BUCKETS; i++) {
+    cumulative += __atomic_load_n(&data.buckets[i], __ATOMIC_RELAXED);
+    Append(out, "%s_bucket{le=\"", info.name);
+    if (i < METRICS_BUCKETS)
+      AppendSeconds(out, info.bounds[i], info.perSecond);
+    else
+      Append(out, "+Inf");
+    Append(out, "\"} %lu\n", (unsigned long)cumulative);
+  }
+  Append(out, "%s_sum ", info.name);
+  AppendSeconds(out, __atomic_load_n(&data.sum, __ATOMIC_RELAXED),
+                info.perSecond);
+  Append(out, "\n%s_count %lu\n", info.name, (unsigned long)cumulative);
+}
+
+size_t Metrics_Format(char *dst, size_t size) {
+  MetricsText out = {dst, size, 0};
+  if (size)
+    dst[0] = '\0';
+
+  for (int i = 0; i < METRIC_COUNTER_COUNT; i++)
+    AppendValue(out, COUNTERS[i].name, "counter", COUNTERS[i].help,
+                __atomic_load_n(&counters[i], __ATOMIC_RELAXED));
+  for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++)
+    AppendHistogram(out, (MetricHistogram)i);
+
+  // Totals the other modules already keep
+  PageCacheStats pages = PageCache_GetStats();
+  AppendValue(out, "wfs_pages_skipped_total", "counter",
+              "Pages not parsed because their rows did not change",
+              pages.totalHits);
+  WebDavisStats webdavis = WebDavis_GetStats();
+  AppendValue(out, "wfs_webdavis_requests_total", "counter",
+              "Requests sent to WebDavis", webdavis.requests);
+  AppendValue(out, "wfs_webdavis_connections_total", "counter",
+              "TCP connections opened to WebDavis", webdavis.connections);
+  RttStats rtt = Rtt_GetStats();
+  AppendValue(out, "wfs_rtdb_timeouts_total", "counter",
+              "RTDB writes that timed out", rtt.timeouts);
+  AppendValue(out, "wfs_rtdb_retries_total", "counter",
+              "RTDB writes sent again", rtt.retries);
+  AppendValue(out, "wfs_rtdb_timeout_milliseconds", "gauge",
+              "Current RTDB write timeout", rtt.timeout);
+  WalStats wal = Wal_GetStats();
+  AppendValue(out, "wfs_wal_bytes", "gauge",
+              "Size of the write-ahead log", wal.bytes);
+
+  HealthStats health = Health_GetStats();
+  AppendValue(out, "wfs_cycles_total", "counter", "Sync cycles since boot",
+              health.cycles);
+  AppendValue(out, "wfs_failed_cycles", "gauge", "Failed sync cycles in a row",
+              health.failedCycles);
+  AppendHeader(out, "wfs_restarts_total", "counter",
+               "Restarts recorded in NVS over all boots, by reason");
+  for (int i = HEALTH_OK + 1; i < HEALTH_REASON_COUNT; i++)
+    Append(out, "wfs_restarts_total{reason=\"%s\"} %lu\n",
+           HEALTH_REASON_NAMES[i], (unsigned long)health.restartsByReason[i]);
+
+  AppendValue(out, "wfs_uptime_seconds", "gauge", "Seconds since boot",
+              millis() / 1000);
+  AppendValue(out, "wfs_heap_free_bytes", "gauge", "Free internal heap",
+              ESP.getFreeHeap());
+  AppendValue(out, "wfs_heap_largest_block_bytes", "gauge",
+              "Largest free internal heap block", ESP.getMaxAllocHeap());
+  AppendValue(out, "wfs_heap_min_largest_block_bytes", "gauge",
+              "Smallest largest free block seen after a cycle",
+              health.minLargestBlock);
+  AppendValue(out, "wfs_psram_size_bytes", "gauge", "PSRAM size",
+              ESP.getPsramSize());
+  AppendValue(out, "wfs_psram_used_bytes", "gauge", "PSRAM in use",
+              ESP.getPsramSize() - ESP.getFreePsram());
+  return out.used;
+}
@@ -9,13 +9,35 @@ AsyncClientClass aClient(ssl_client);
 RealtimeDatabase Database;
 bool firebaseReady = false;
 
-volatile bool completed = false;
-bool success = false;
+// ============ WRITE WINDOW ============
+// Every RTDB write gets a slot, matched to its result by task UID. Slot i is
+// sent on its own async client (and TLS connection), so up to writeWindow
+// writes are on the wire at once instead of one at a time. A slot keeps its
+// request so a timed out or transiently failed write can be sent again after
+// a jittered backoff, with a new UID.
+//
+// Each client that has sent a write holds an mbedTLS session in internal
+// RAM, RTDB_TLS_SESSION_BYTES on top of the auth client's. The window is
+// capped at boot to the sessions the free heap holds with the health
+// threshold still met; Firebase_SetWriteWindow() cannot go past that.
+//
+// A client whose write timed out may still be waiting for the answer, and
+// would queue the retry behind it. The timed out request is cancelled on
+// that client first, which closes its connection, so the retry goes out on
+// a fresh one.
+static WiFiClientSecure *writeSsl[RTDB_MAX_WINDOW];
+static AsyncClientClass *writeClients[RTDB_MAX_WINDOW];
+static RtdbWriteSlot writeSlots[RTDB_MAX_WINDOW];
+static RtdbWriteKind writeKinds[RTDB_MAX_WINDOW];
+static String writePaths[RTDB_MAX_WINDOW];
+static object_t writeBodies[RTDB_MAX_WINDOW];
+static int writeWindow = RTDB_DEFAULT_WINDOW;
+static int maxWriteWindow = RTDB_MAX_WINDOW; // what the heap allows
+static unsigned long writeSequence = 0;
+static unsigned long resetCount = 0;
 
 // ============ TIMEOUT MANAGEMENT VARIABLES ============
-int currentTimeout = 10000;  // Start with 10 seconds
-int maxTimeout = 120000;     // Maximum 120 seconds
-int timeoutIncrement = 5000; // Increase by 5 seconds each time
+// Write timeouts come from the RTT estimator (RttEstimator.cpp)
 int consecutiveTimeouts = 0;
 int maxConsecutiveTimeouts = 2;
 long lastResetTime = 0;
@@ -23,17 +45,266 @@ bool connectionResetInProgress = false;
 unsigned long nextReconnectAttempt = 0;
 
 // ============ FIREBASE CALLBACK FUNCTIONS ============
-void Firebase_PrintResult(AsyncResult &aResult) {
+static RtdbWriteSlot *FindWriteSlot(const String &uid) {
+  for (int i = 0; i < RTDB_MAX_WINDOW; i++) {
+    if (writeSlots[i].state == RTDB_SLOT_PENDING && uid == writeSlots[i].uid)
+      return &writeSlots[i];
+  }
+  return nullptr;
+}
+
+// Send again later, or give up after RTDB_MAX_ATTEMPTS
+static void RetryOrFail(RtdbWriteSlot &slot) {
+  if (slot.attempts >= RTDB_MAX_ATTEMPTS) {
+    slot.state = RTDB_SLOT_DONE;
+    return;
+  }
+  uint32_t wait = Rtt_BackoffDelay(slot.attempts);
+  slot.retryAtMs = millis() + wait;
+  slot.state = RTDB_SLOT_BACKOFF;
+  LOG_WARN("🔁 Retrying %s in %u ms (attempt %d/%d)\n", slot.uid,
+           (unsigned)wait, slot.attempts + 1, RTDB_MAX_ATTEMPTS);
+}
+
+// Network errors, throttling and server errors are worth another attempt;
+// a rejected request (400, 401, ...) is not
+static bool IsRetryable(int code) {
+  return code < 0 || code == 429 || code >= 500;
+}
 
+void Firebase_PrintResult(AsyncResult &aResult) {
+  bool ok;
   if (aResult.isError()) {
-    Serial.printf("❌ Firebase Error: %s (Code: %d)\n",
-                  aResult.error().message().c_str(), aResult.error().code());
-    success = false;
+    LOG_ERROR("❌ Firebase Error: %s (Code: %d)\n",
+              aResult.error().message().c_str(), aResult.error().code());
+    ok = false;
   } else if (aResult.available()) {
-    Serial.printf("✅ Firebase Success: %s\n", aResult.c_str());
-    success = true;
+    LOG_DEBUG("✅ Firebase Success: %s\n", aResult.uid().c_str());
+    LOG_VERBOSE("  📥 %s\n", aResult.c_str());
+    ok = true;
+  } else {
+    return; // debug / event callbacks do not finish a request
+  }
+
+  // Results for a slot that already timed out have no slot any more
+  RtdbWriteSlot *slot = FindWriteSlot(aResult.uid());
+  if (!slot)
+    return;
+  slot->ok = ok;
+  slot->timedOut = false;
+  int index = slot - writeSlots;
+
+  if (!ok) {
+    TRACE(TRACE_WRITE_ERROR, index, aResult.error().code());
+    if (IsRetryable(aResult.error().code()))
+      RetryOrFail(*slot);
+    else
+      slot->state = RTDB_SLOT_DONE;
+    return;
+  }
+
+  // Karn: only first attempts give an unambiguous round-trip time
+  TRACE(TRACE_WRITE_OK, index, millis() - slot->startMs);
+  if (slot->attempts == 1)
+    Rtt_AddSample(millis() - slot->startMs);
+  consecutiveTimeouts = 0;
+  slot->state = RTDB_SLOT_DONE;
+}
+
+// ============ WRITE WINDOW FUNCTIONS ============
+// Sessions the heap can hold next to the auth client's, leaving
+// HEALTH_MIN_LARGEST_BLOCK free; at least one, or nothing is written
+static int AffordableWriteWindow() {
+  uint32_t reserve = HEALTH_MIN_LARGEST_BLOCK + RTDB_TLS_SESSION_BYTES;
+  uint32_t freeHeap = ESP.getFreeHeap();
+  int sessions =
+      freeHeap > reserve ? (freeHeap - reserve) / RTDB_TLS_SESSION_BYTES : 0;
+  // One session's largest buffer has to fit in one block as well
+  if (ESP.getMaxAllocHeap() < HEALTH_MIN_LARGEST_BLOCK + RTDB_TLS_BUFFER_BYTES)
+    sessions = 1;
+  return constrain(sessions, 1, RTDB_MAX_WINDOW);
+}
+
+bool Firebase_WriteWindowInit() {
+  if (!writeClients[0]) {
+    maxWriteWindow = AffordableWriteWindow();
+    if (writeWindow > maxWriteWindow) {
+      Serial.printf("⚠️ RTDB write window %d -> %d: heap for %d TLS "
+                    "sessions (%u bytes free, largest block %u)\n",
+                    writeWindow, maxWriteWindow, maxWriteWindow,
+                    (unsigned)ESP.getFreeHeap(),
+                    (unsigned)ESP.getMaxAllocHeap());
+      writeWindow = maxWriteWindow;
+    }
+  }
+  for (int i = 0; i < RTDB_MAX_WINDOW; i++) {
+    if (writeClients[i])
+      continue;
+    writeSsl[i] = new WiFiClientSecure();
+    writeSsl[i]->setInsecure();
+    writeClients[i] = new AsyncClientClass(*writeSsl[i]);
+    writeSlots[i].state = RTDB_SLOT_FREE;
+  }
+  return true;
+}
+
+void Firebase_SetWriteWindow(int window) {
+  writeWindow = constrain(window, 1, maxWriteWindow);
+}
+
+int Firebase_GetWriteWindow() { return writeWindow; }
+
+static int CountWriteSlots(RtdbSlotState state) {
+  int count = 0;
+  for (int i = 0; i < RTDB_MAX_WINDOW; i++) {
+    if (writeSlots[i].state == state)
+      count++;
+  }
+  return count;
+}
+
+// Requests holding a slot: on the wire or waiting to be sent again
+int Firebase_WritesInFlight() {
+  return CountWriteSlots(RTDB_SLOT_PENDING) +
+         CountWriteSlots(RTDB_SLOT_BACKOFF);
+}
+
+static void SendWrite(int i) {
+  RtdbWriteSlot &slot = writeSlots[i];
+  snprintf(slot.uid, sizeof(slot.uid), "rtdb_%lu", ++writeSequence);
+  slot.state = RTDB_SLOT_PENDING;
+  slot.attempts++;
+  slot.startMs = millis();
+  slot.timeoutMs = Rtt_Timeout();
+  TRACE(TRACE_WRITE_SENT, i, slot.attempts);
+  if (writeKinds[i] == RTDB_WRITE_SET)
+    Database.set<object_t>(*writeClients[i], writePaths[i], writeBodies[i],
+                           Firebase_PrintResult, slot.uid);
+  else
+    Database.update<object_t>(*writeClients[i], writePaths[i], writeBodies[i],
+                              Firebase_PrintResult, slot.uid);
+}
+
+int Firebase_SubmitWrite(RtdbWriteKind kind, const String &path,
+                         const object_t &body) {
+  if (!writeClients[0])
+    Firebase_WriteWindowInit();
+
+  for (int i = 0; i < writeWindow; i++) {
+    RtdbWriteSlot &slot = writeSlots[i];
+    if (slot.state != RTDB_SLOT_FREE)
+      continue;
+    slot.attempts = 0;
+    slot.ok = false;
+    slot.timedOut = false;
+    writeKinds[i] = kind;
+    writePaths[i] = path;
+    writeBodies[i] = body;
+    SendWrite(i);
+    return i;
+  }
+  return -1; // window full
+}
+
+// Services the clients, expires slots that ran past their RTT-derived
+// timeout and sends due retries
+void Firebase_PollWrites() {
+  app.loop();
+
+  for (int i = 0; i < RTDB_MAX_WINDOW; i++) {
+    RtdbWriteSlot &slot = writeSlots[i];
+    if (slot.state == RTDB_SLOT_BACKOFF &&
+        (long)(millis() - slot.retryAtMs) >= 0) {
+      Rtt_OnRetry();
+      SendWrite(i);
+      continue;
+    }
+    if (slot.state != RTDB_SLOT_PENDING ||
+        millis() - slot.startMs < slot.timeoutMs)
+      continue;
+
+    consecutiveTimeouts++;
+    Rtt_OnTimeout();
+    TRACE(TRACE_WRITE_TIMEOUT, i, slot.timeoutMs);
+    LOG_WARN("⏳ Timeout while waiting for Firebase response! (Timeout #%d, "
+             "%lu ms, next timeout %u ms)\n",
+             consecutiveTimeouts, slot.timeoutMs, (unsigned)Rtt_Timeout());
+    slot.ok = false;
+    slot.timedOut = true;
+    writeClients[i]->stopAsync(slot.uid); // a late answer has no slot now
+    RetryOrFail(slot);
+  }
+
+  // Too many timeouts in a row: reset once nothing is on the wire
+  if (consecutiveTimeouts >= maxConsecutiveTimeouts &&
+      CountWriteSlots(RTDB_SLOT_PENDING) == 0 && !connectionResetInProgress &&
+      millis() >= nextReconnectAttempt) {
+    Serial.println(
+        "🔧 Too many consecutive timeouts, attempting connection reset...");
+    Serial.printf("   - Free heap before reset: %d bytes\n", ESP.getFreeHeap());
+    if (!Firebase_ResetConnection())
+      nextReconnectAttempt = millis() + 30000;
+  }
+}
+
+bool Firebase_TakeWrite(int slot, RtdbWriteSlot &result) {
+  if (slot < 0 || slot >= RTDB_MAX_WINDOW ||
+      writeSlots[slot].state != RTDB_SLOT_DONE)
+    return false;
+  result = writeSlots[slot];
+  writeSlots[slot].state = RTDB_SLOT_FREE;
+  writeBodies[slot] = object_t(); // release the payload copy
+  return true;
+}
+
+// Submit and wait for one write (window slot free, then its result)
+static RtdbWriteSlot Firebase_WriteAndWait(RtdbWriteKind kind,
+                                           const String &path,
+                                           const object_t &body) {
+  int slot;
+  while ((slot = Firebase_SubmitWrite(kind, path, body)) < 0) {
+    Firebase_PollWrites();
+    delay(10);
+  }
+  RtdbWriteSlot result;
+  while (!Firebase_TakeWrite(slot, result)) {
+    Firebase_PollWrites();
+    delay(10);
+  }
+  return result;
+}
+
+// Blocking write with one retry after a connection reset
+static bool Firebase_WriteBlocking(RtdbWriteKind kind, const String &path,
+                                   const object_t &body) {
+  if (!Firebase_IsReady()) {
+    // Attempt to recover automatically
+    if (!Firebase_EnsureReady(10000)) {
+      Serial.println("❌ Firebase not ready. Call Firebase_Init() first.");
+      return false;
+    }
+  }
+
+  unsigned long resetsBefore = resetCount;
+  RtdbWriteSlot result = Firebase_WriteAndWait(kind, path, body);
+  if (!result.timedOut)
+    return result.ok;
+
+  // Let the poll loop reset the connection if this was one timeout too many
+  Firebase_PollWrites();
+  if (resetCount == resetsBefore)
+    return false;
+
+  Serial.println("✅ Connection reset successful, retrying operation...");
+  result = Firebase_WriteAndWait(kind, path, body);
+  if (result.timedOut) {
+    Serial.println("❌ Operation failed even after connection reset");
+    nextReconnectAttempt = millis() + 30000;
+    return false;
   }
-  completed = true;
+  if (result.ok)
+    Serial.println("✅ Operation succeeded after connection reset");
+  return result.ok;
 }
 
 // ============ VERIFY USER WITH GOOGLE IDENTITY TOOLKIT ============
@@ -80,6 +351,7 @@ bool Firebase_VerifyUser(const String &apiKey, const String &email,
 // ============ INITIALIZE FIREBASE ============
 void Firebase_Init() {
   ssl_client.setInsecure();
+  Firebase_WriteWindowInit();
 
   Serial.println("\n🔐 Initializing Firebase...");
   Serial.print("   - Verifying user credentials... ");
@@ -134,7 +406,7 @@ bool Firebase_ResetConnection() {
 
   // Check available memory
   size_t freeHeap = ESP.getFreeHeap();
-  Serial.printf("   - Free heap: %d bytes\n", freeHeap);
+  Serial.printf("   - Free heap: %u bytes\n", (unsigned)freeHeap);
 
   // If memory is critically low, recommend restart instead
   if (freeHeap < 30000) {
@@ -156,11 +428,15 @@ bool Firebase_ResetConnection() {
     }
   }
 
-  // Stop current SSL connection
+  // Stop current SSL connections
   if (ssl_client.connected()) {
     ssl_client.stop();
     Serial.println("   - SSL connection stopped");
   }
+  for (int i = 0; i < RTDB_MAX_WINDOW; i++) {
+    if (writeSsl[i] && writeSsl[i]->connected())
+      writeSsl[i]->stop();
+  }
 
   // No direct public stop/deinit; rely on re-init after TLS stop
 
@@ -205,8 +481,9 @@ bool Firebase_ResetConnection() {
   if (firebaseReady) {
     Serial.println("\n✅ Firebase connection reset successful!");
     consecutiveTimeouts = 0; // Reset timeout counter
-    currentTimeout = 10000;  // Reset to initial timeout
+    Rtt_ResetBackoff();      // New connection, undo the timeout backoff
     lastResetTime = millis();
+    resetCount++;
     return true;
   } else {
     Serial.println("\n❌ Firebase connection reset failed!");
@@ -271,18 +548,6 @@ bool Firebase_EnsureReady(unsigned long maxWaitMs) {
 // }
 bool UpdateFlight(String category, String flightKey,
                   const JsonDocument &fieldsToUpdate) {
-  if (!Firebase_IsReady()) {
-    // Attempt to recover automatically
-    if (!Firebase_EnsureReady(10000)) {
-      Serial.println("❌ Firebase not ready. Call Firebase_Init() first.");
-      return false;
-    }
-  }
-
-  // Reset flags before each call
-  completed = false;
-  success = false;
-
   String path = "/flights/Islamabad/" + category + "/" + flightKey;
 
   // Serialize JSON to string
@@ -290,213 +555,10 @@ bool UpdateFlight(String category, String flightKey,
   serializeJson(fieldsToUpdate, jsonStr);
 
   // Log what we're sending to Firebase
-  Serial.printf("  🔥 Firebase UPDATE to %s\n", path.c_str());
-  Serial.printf("  📤 Payload: %s\n", jsonStr.c_str());
-
-  // Async request
-  Database.update<object_t>(aClient, path, object_t(jsonStr),
-                            Firebase_PrintResult);
-
-  // Blocking wait with current timeout
-  unsigned long start = millis();
-  while (!completed && millis() - start < currentTimeout) {
-    app.loop();
-    delay(10);
-  }
-
-  if (!completed) {
-    consecutiveTimeouts++;
-    Serial.printf(
-        "⏳ Timeout while waiting for Firebase response! (Timeout #%d, %ds)\n",
-        consecutiveTimeouts, currentTimeout / 1000);
-
-    // If we've had multiple consecutive timeouts, try to reset connection
-    if (consecutiveTimeouts >= maxConsecutiveTimeouts) {
-      Serial.println(
-          "🔧 Too many consecutive timeouts, attempting connection reset...");
-
-      // DON'T clear allData here - it causes crashes when iterating
-      // The reset itself will free SSL buffers which is sufficient
-      Serial.printf("   - Free heap before reset: %d bytes\n",
-                    ESP.getFreeHeap());
-
-      if (Firebase_ResetConnection()) {
-        Serial.println("✅ Connection reset successful, retrying operation...");
-
-        // Retry the operation once after reset
-        completed = false;
-        success = false;
-        Database.update<object_t>(aClient, path, object_t(jsonStr),
-                                  Firebase_PrintResult);
-
-        start = millis();
-        while (!completed && millis() - start < currentTimeout) {
-          app.loop();
-          delay(10);
-        }
-
-        if (!completed) {
-          Serial.println("❌ Operation failed even after connection reset");
-          // Increase timeout for next operations
-          if (currentTimeout < maxTimeout) {
-            currentTimeout += timeoutIncrement;
-            Serial.printf("⏰ Increasing timeout to %d seconds\n",
-                          currentTimeout / 1000);
-          }
-          nextReconnectAttempt = millis() + 30000;
-          return false;
-        } else {
-          Serial.println("✅ Operation succeeded after connection reset");
-          return success;
-        }
-      } else {
-        Serial.println("❌ Connection reset failed, increasing timeout");
-        if (currentTimeout < maxTimeout) {
-          currentTimeout += timeoutIncrement;
-          Serial.printf("⏰ Timeout increased to %d seconds\n",
-                        currentTimeout / 1000);
-        }
-        nextReconnectAttempt = millis() + 30000;
-        return false;
-      }
-    } else {
-      // Just increase timeout gradually
-      if (currentTimeout < maxTimeout) {
-        currentTimeout += timeoutIncrement;
-        Serial.printf(
-            "⏰ Increasing timeout to %d seconds for next operations\n",
-            currentTimeout / 1000);
-      }
-      return false;
-    }
-  }
+  LOG_DEBUG("  🔥 Firebase UPDATE to %s\n", path.c_str());
+  LOG_VERBOSE("  📤 Payload: %s\n", jsonStr.c_str());
 
-  // Reset consecutive timeout counter on success
-  if (success) {
-    consecutiveTimeouts = 0;
-    // Gradually reduce timeout back to normal if it was increased
-    if (currentTimeout > 10000) {
-      currentTimeout = max(10000, currentTimeout - 1000);
-      Serial.printf("⏰ Reducing timeout to %d seconds\n",
-                    currentTimeout / 1000);
-    }
-  }
-
-  return success;
-}
-
-// ============ BATCH UPDATE MULTIPLE FLIGHTS AT ONCE (FIELD-LEVEL) ============
-bool UpdateFlightsBatch(String category, JsonObject flightsToUpdate) {
-  if (!Firebase_IsReady()) {
-    // Attempt to recover automatically
-    if (!Firebase_EnsureReady(10000)) {
-      Serial.println("❌ Firebase not ready. Call Firebase_Init() first.");
-      return false;
-    }
-  }
-
-  // Reset flags before each call
-  completed = false;
-  success = false;
-
-  // Use simple whole-object updates (ESP32 is the authoritative source)
-  // Field-level updates cause memory fragmentation crashes
-  String path = "/flights/Islamabad/" + category;
-
-  // Serialize the flight objects directly
-  String jsonStr;
-  serializeJson(flightsToUpdate, jsonStr);
-
-  Serial.printf("📦 Sending %d flights to %s\n", flightsToUpdate.size(),
-                path.c_str());
-
-  // Async request for batch update
-  Database.update<object_t>(aClient, path.c_str(), object_t(jsonStr),
-                            Firebase_PrintResult);
-
-  // Blocking wait with current timeout
-  unsigned long start = millis();
-  while (!completed && millis() - start < currentTimeout) {
-    app.loop();
-    delay(10);
-  }
-
-  if (!completed) {
-    consecutiveTimeouts++;
-    Serial.printf(
-        "⏳ Timeout while waiting for batch update! (Timeout #%d, %ds)\n",
-        consecutiveTimeouts, currentTimeout / 1000);
-
-    // If we've had multiple consecutive timeouts, try to reset connection
-    if (consecutiveTimeouts >= maxConsecutiveTimeouts) {
-      Serial.println(
-          "🔧 Too many consecutive timeouts, attempting connection reset...");
-
-      if (Firebase_ResetConnection()) {
-        Serial.println(
-            "✅ Connection reset successful, retrying batch update...");
-
-        // Retry the operation once after reset
-        completed = false;
-        success = false;
-        Database.update<object_t>(aClient, path.c_str(), object_t(jsonStr),
-                                  Firebase_PrintResult);
-
-        start = millis();
-        while (!completed && millis() - start < currentTimeout) {
-          app.loop();
-          delay(10);
-        }
-
-        if (!completed) {
-          Serial.println("❌ Batch update failed even after connection reset");
-          if (currentTimeout < maxTimeout) {
-            currentTimeout += timeoutIncrement;
-            Serial.printf("⏰ Increasing timeout to %d seconds\n",
-                          currentTimeout / 1000);
-          }
-          nextReconnectAttempt = millis() + 30000;
-          return false;
-        } else {
-          Serial.println("✅ Batch update succeeded after connection reset");
-          return success;
-        }
-      } else {
-        Serial.println("❌ Connection reset failed, increasing timeout");
-        if (currentTimeout < maxTimeout) {
-          currentTimeout += timeoutIncrement;
-          Serial.printf("⏰ Timeout increased to %d seconds\n",
-                        currentTimeout / 1000);
-        }
-        nextReconnectAttempt = millis() + 30000;
-        return false;
-      }
-    } else {
-      // Just increase timeout gradually
-      if (currentTimeout < maxTimeout) {
-        currentTimeout += timeoutIncrement;
-        Serial.printf(
-            "⏰ Increasing timeout to %d seconds for next operations\n",
-            currentTimeout / 1000);
-      }
-      return false;
-    }
-  }
-
-  // Reset consecutive timeout counter on success
-  if (success) {
-    consecutiveTimeouts = 0;
-    // Gradually reduce timeout back to normal if it was increased
-    if (currentTimeout > 10000) {
-      currentTimeout = max(10000, currentTimeout - 1000);
-      Serial.printf("⏰ Reducing timeout to %d seconds\n",
-                    currentTimeout / 1000);
-    }
-    Serial.printf("✅ Successfully updated %d %s flights!\n",
-                  flightsToUpdate.size(), category.c_str());
-  }
-
-  return success;
+  return Firebase_WriteBlocking(RTDB_WRITE_UPDATE, path, object_t(jsonStr));
 }
 
 // ============ UPDATE LAST SYNC TIMESTAMP IN FIREBASE ============
@@ -517,10 +579,6 @@ void Firebase_UpdateLastSyncTime() {
 
   Serial.printf("📅 Updating Esp33Update timestamp: %s\n", timestamp.c_str());
 
-  // Reset flags
-  completed = false;
-  success = false;
-
   // Update the timestamp at ROOT level: /Esp33Update
   String path = "/Esp33Update";
 
@@ -528,17 +586,10 @@ void Firebase_UpdateLastSyncTime() {
   String jsonValue = "\"" + timestamp + "\"";
   object_t timestampObj(jsonValue);
 
-  Database.set<object_t>(aClient, path.c_str(), timestampObj,
-                         Firebase_PrintResult);
-
-  // Wait for completion with 10 second timeout
-  unsigned long start = millis();
-  while (!completed && millis() - start < 10000) {
-    app.loop();
-    delay(10);
-  }
+  RtdbWriteSlot result =
+      Firebase_WriteAndWait(RTDB_WRITE_SET, path, timestampObj);
 
-  if (completed && success) {
+  if (result.ok) {
     Serial.println("✅ Timestamp updated successfully");
   } else {
     Serial.println("❌ Failed to update timestamp");
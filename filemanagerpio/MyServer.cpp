@@ -1,5 +1,7 @@
 #include "Global.h"
 
+#include <freertos/timers.h>
+
 // Static variables for file upload
 File fsUploadFile;
 String uploadFilename;
@@ -156,6 +158,43 @@ bool ValidateIPFromRequest(AsyncWebServerRequest *request) {
   return true;
 }
 
+// ============ STATIC ASSETS ============
+// Sends a file from the asset manifest: 304 when the client's copy has the
+// same ETag, the .gz when the client accepts gzip. False when the path is
+// not an asset.
+bool Server_SendAsset(AsyncWebServerRequest *request, const char *path) {
+  const Asset *asset = Assets_Find(path);
+  if (!asset)
+    return false;
+
+  bool gzip = false;
+  if (asset->gzSize && request->hasHeader("Accept-Encoding")) {
+    const String &accept = request->getHeader("Accept-Encoding")->value();
+    gzip = accept.indexOf("gzip") >= 0;
+  }
+  const char *etag = gzip ? asset->gzEtag : asset->etag;
+
+  AsyncWebServerResponse *response;
+  if (request->hasHeader("If-None-Match") &&
+      request->getHeader("If-None-Match")->value().indexOf(etag) >= 0) {
+    response = request->beginResponse(304);
+  } else {
+    // A File named "*.gz" under the plain path gets Content-Encoding: gzip
+    // from the library; no exists() needed
+    String filePath = String(asset->path) + (gzip ? ".gz" : "");
+    File file = LittleFS.open(filePath, "r");
+    if (!file)
+      return false;
+    response = request->beginResponse(file, asset->path, asset->contentType);
+  }
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", ASSET_CACHE_CONTROL);
+  if (asset->gzSize)
+    response->addHeader("Vary", "Accept-Encoding");
+  request->send(response);
+  return true;
+}
+
 void Server_HandleRoot(AsyncWebServerRequest *request) {
   String clientIP = String(request->client()->remoteIP());
 
@@ -164,22 +203,14 @@ void Server_HandleRoot(AsyncWebServerRequest *request) {
     // IP is authenticated - serve filemanager
     Auth_UpdateActivity(clientIP); // Update activity timestamp
 
-    if (LittleFS.exists("/filemanager.html")) {
-      AsyncWebServerResponse *response =
-          request->beginResponse(LittleFS, "/filemanager.html", "text/html");
-      request->send(response);
-    } else {
+    if (!Server_SendAsset(request, "/filemanager.html")) {
       String html = GetBasicPage();
       request->send(200, "text/html", html);
     }
   } else {
     // IP not authenticated - serve login page
 
-    if (LittleFS.exists("/login.html")) {
-      AsyncWebServerResponse *response =
-          request->beginResponse(LittleFS, "/login.html", "text/html");
-      request->send(response);
-    } else {
+    if (!Server_SendAsset(request, "/login.html")) {
       // Fallback minimal login
       String html = GetBasicPage();
       request->send(200, "text/html", html);
@@ -187,6 +218,82 @@ void Server_HandleRoot(AsyncWebServerRequest *request) {
   }
 }
 
+// ============ FILE LISTING ============
+// /api/files walks LittleFS depth first and streams one JSON entry at a
+// time into the chunked response. The state is one open directory per
+// level and one formatted entry, however many files the partition holds.
+// ?offset=N skips the first N files of the walk, ?limit=M stops after M.
+struct FileListing {
+  File dirs[FILES_MAX_DEPTH]; // the directory being read at each level
+  int depth = 0;
+  uint32_t seen = 0; // files walked past, for offset
+  uint32_t sent = 0;
+  uint32_t offset = 0;
+  uint32_t limit = 0; // 0 = all
+  bool started = false;
+  bool finished = false;
+  char entry[FILES_ENTRY_MAX];
+  size_t entryLen = 0;
+  size_t entryPos = 0;
+};
+
+// Quotes and backslashes escaped; control characters dropped
+static size_t Server_JsonEscape(const char *text, char *dst, size_t size) {
+  size_t used = 0;
+  for (; *text && used + 2 < size; text++) {
+    if ((uint8_t)*text < 0x20)
+      continue;
+    if (*text == '"' || *text == '\\')
+      dst[used++] = '\\';
+    dst[used++] = *text;
+  }
+  dst[used] = '\0';
+  return used;
+}
+
+// Next piece of the array into listing.entry: "[", ",{...}" or "]"
+static void Server_NextFileEntry(FileListing &listing) {
+  listing.entryPos = 0;
+  if (!listing.started) {
+    listing.started = true;
+    listing.entry[0] = '[';
+    listing.entryLen = 1;
+    return;
+  }
+  while (listing.depth > 0 &&
+         (listing.limit == 0 || listing.sent < listing.limit)) {
+    File file = listing.dirs[listing.depth - 1].openNextFile();
+    if (!file) {
+      listing.dirs[--listing.depth].close();
+      continue;
+    }
+    if (file.isDirectory()) {
+      if (listing.depth < FILES_MAX_DEPTH)
+        listing.dirs[listing.depth++] = file;
+      continue;
+    }
+    if (listing.seen++ < listing.offset)
+      continue;
+
+    // Without the leading "/", as download and delete expect it
+    const char *path = file.path();
+    char name[FILES_ENTRY_MAX / 2];
+    Server_JsonEscape(path[0] == '/' ? path + 1 : path, name, sizeof(name));
+    int n = snprintf(listing.entry, sizeof(listing.entry),
+                     "%s{\"name\":\"%s\",\"size\":%lu,\"mtime\":%lu}",
+                     listing.sent ? "," : "", name, (unsigned long)file.size(),
+                     (unsigned long)file.getLastWrite());
+    listing.entryLen = min((size_t)n, sizeof(listing.entry) - 1);
+    listing.sent++;
+    return;
+  }
+  while (listing.depth > 0)
+    listing.dirs[--listing.depth].close();
+  listing.entry[0] = ']';
+  listing.entryLen = 1;
+  listing.finished = true;
+}
+
 void Server_HandleListFiles(AsyncWebServerRequest *request) {
   // Check authentication (IP-only)
   if (!ValidateIPFromRequest(request)) {
@@ -194,35 +301,36 @@ void Server_HandleListFiles(AsyncWebServerRequest *request) {
     return;
   }
 
-  String json = "[";
-
-  File root = LittleFS.open("/");
-  if (!root) {
+  std::shared_ptr<FileListing> listing = std::make_shared<FileListing>();
+  listing->dirs[0] = LittleFS.open("/");
+  if (!listing->dirs[0] || !listing->dirs[0].isDirectory()) {
     request->send(500, "application/json", "[]");
     return;
   }
-
-  bool first = true;
-  File file = root.openNextFile();
-
-  while (file) {
-    if (!file.isDirectory()) {
-      if (!first)
-        json += ",";
-
-      json += "{\"name\":\"";
-      json += file.name();
-      json += "\",\"size\":";
-      json += file.size();
-      json += "}";
-
-      first = false;
-    }
-    file = root.openNextFile();
-  }
-
-  json += "]";
-  request->send(200, "application/json", json);
+  listing->depth = 1;
+  if (request->hasParam("offset"))
+    listing->offset = request->getParam("offset")->value().toInt();
+  if (request->hasParam("limit"))
+    listing->limit = request->getParam("limit")->value().toInt();
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      "application/json",
+      [listing](uint8_t *buffer, size_t maxLen, size_t index) {
+        size_t used = 0;
+        while (used < maxLen) {
+          if (listing->entryPos == listing->entryLen) {
+            if (listing->finished)
+              break;
+            Server_NextFileEntry(*listing);
+          }
+          size_t n = min(maxLen - used, listing->entryLen - listing->entryPos);
+          memcpy(buffer + used, listing->entry + listing->entryPos, n);
+          listing->entryPos += n;
+          used += n;
+        }
+        return used;
+      });
+  request->send(response);
 }
 
 void Server_HandleStorageInfo(AsyncWebServerRequest *request) {
@@ -279,6 +387,7 @@ void Server_HandleFileUpload(AsyncWebServerRequest *request,
 
     if (final) {
       fsUploadFile.close();
+      Assets_Refresh(uploadFilename.c_str()); // new ETag, or a new .gz
       Serial.print("Upload Complete: ");
       Serial.print(uploadFilename);
       Serial.print(" Size: ");
@@ -310,6 +419,7 @@ void Server_HandleDeleteFile(AsyncWebServerRequest *request) {
 
     if (LittleFS.exists(filepath)) {
       if (LittleFS.remove(filepath)) {
+        Assets_Refresh(filepath.c_str());
         request->send(200, "text/plain", "File deleted");
         Serial.print("Deleted: ");
         Serial.println(filepath);
@@ -362,33 +472,8 @@ void Server_HandleStaticFile(AsyncWebServerRequest *request) {
 
   String path = request->url();
 
-  // Determine MIME type based on file extension
-  String contentType = "text/plain";
-  if (path.endsWith(".css")) {
-    contentType = "text/css";
-  } else if (path.endsWith(".js")) {
-    contentType = "application/javascript";
-  } else if (path.endsWith(".html")) {
-    contentType = "text/html";
-  } else if (path.endsWith(".json")) {
-    contentType = "application/json";
-  } else if (path.endsWith(".png")) {
-    contentType = "image/png";
-  } else if (path.endsWith(".jpg") || path.endsWith(".jpeg")) {
-    contentType = "image/jpeg";
-  } else if (path.endsWith(".gif")) {
-    contentType = "image/gif";
-  } else if (path.endsWith(".svg")) {
-    contentType = "image/svg+xml";
-  }
-
-  // Check if file exists in LittleFS
-  if (LittleFS.exists(path)) {
-    AsyncWebServerResponse *response =
-        request->beginResponse(LittleFS, path, contentType);
-    request->send(response);
-    // Serial.println(path);
-  } else {
+  // Content type, ETag and .gz come from the manifest built at boot
+  if (!Server_SendAsset(request, path.c_str())) {
     request->send(404, "text/plain", "File not found");
     Serial.print("Static file not found: ");
     Serial.println(path);
@@ -425,6 +510,175 @@ void Server_HandleSaveSettings(AsyncWebServerRequest *request) {
   // This function is kept for compatibility but not actively used
 }
 
+// ============ TRACE DUMP ============
+// The trace ring as text, oldest record first. It is copied when the request
+// comes in and formatted a line at a time as the client reads it; a line
+// that does not fit the chunk is continued in the next one.
+struct TraceDump {
+  TraceRecord *records = nullptr;
+  size_t count = 0;
+  size_t next = 0;
+  uint32_t total = 0;
+  bool started = false; // header line formatted
+  char line[80];
+  size_t lineLen = 0;
+  size_t linePos = 0;
+  ~TraceDump() { free(records); }
+};
+
+// Next line into dump.line; false once every record is sent
+static bool Server_NextTraceLine(TraceDump &dump) {
+  int n;
+  if (!dump.started) {
+    dump.started = true;
+    n = snprintf(dump.line, sizeof(dump.line),
+                 "# ms core event a b (%u of %lu records)\n",
+                 (unsigned)dump.count, (unsigned long)dump.total);
+  } else if (dump.next < dump.count) {
+    n = Trace_Format(dump.records[dump.next++], dump.line, sizeof(dump.line));
+  } else {
+    return false;
+  }
+  dump.lineLen = n > 0 ? min((size_t)n, sizeof(dump.line) - 1) : 0;
+  dump.linePos = 0;
+  return true;
+}
+
+void Server_HandleTrace(AsyncWebServerRequest *request) {
+  // Check authentication (IP-only)
+  if (!ValidateIPFromRequest(request)) {
+    request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+    return;
+  }
+
+  std::shared_ptr<TraceDump> dump = std::make_shared<TraceDump>();
+  dump->records =
+      (TraceRecord *)ps_malloc(TRACE_RING_SIZE * sizeof(TraceRecord));
+  if (!dump->records) {
+    request->send(503, "text/plain", "Out of memory");
+    return;
+  }
+  dump->count = Trace_Snapshot(dump->records, TRACE_RING_SIZE, dump->total);
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      "text/plain", [dump](uint8_t *buffer, size_t maxLen, size_t index) {
+        // 0 ends the response, so only once the last line is out
+        size_t used = 0;
+        while (used < maxLen) {
+          if (dump->linePos == dump->lineLen && !Server_NextTraceLine(*dump))
+            break;
+          size_t n = min(maxLen - used, dump->lineLen - dump->linePos);
+          memcpy(buffer + used, dump->line + dump->linePos, n);
+          dump->linePos += n;
+          used += n;
+        }
+        return used;
+      });
+  request->send(response);
+}
+
+// ============ METRICS ============
+// Prometheus text for the monitoring box. Formatted into PSRAM in one go,
+// so a scrape takes no String and no internal heap beyond the response.
+void Server_HandleMetrics(AsyncWebServerRequest *request) {
+  // Check authentication (IP-only)
+  if (!ValidateIPFromRequest(request)) {
+    request->send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+    return;
+  }
+
+  char *text = (char *)ps_malloc(METRICS_TEXT_BYTES);
+  if (!text) {
+    request->send(503, "text/plain", "Out of memory");
+    return;
+  }
+  std::shared_ptr<char> owner(text, free);
+  size_t length = Metrics_Format(text, METRICS_TEXT_BYTES);
+
+  AsyncWebServerResponse *response = request->beginResponse(
+      "text/plain; version=0.0.4", length,
+      [owner, length](uint8_t *buffer, size_t maxLen, size_t index) {
+        size_t n = min(maxLen, length - index);
+        memcpy(buffer, owner.get() + index, n);
+        return n;
+      });
+  request->send(response);
+}
+
+// ============ STATUS EVENTS ============
+// /api/events pushes every status change and progress step as it happens,
+// and a heartbeat with uptime and free heap every STATUS_HEARTBEAT_MS. A
+// new subscriber gets the current status first.
+//
+// The tasks that set the status only queue the event. One sender task makes
+// every events.send() call, so the scraper and the uploader never wait on a
+// slow client or hold the event source's client lock, and writes to the
+// clients come from a single task instead of three.
+struct StatusEvent {
+  char event[12]; // "status" or "progress"
+  char json[STATUS_EVENT_MAX];
+  uint32_t id;
+};
+
+static AsyncEventSource events("/api/events");
+static QueueHandle_t statusEvents = nullptr;
+
+static void Server_PushStatus(const char *event, const char *json,
+                              uint32_t id) {
+  StatusEvent message;
+  snprintf(message.event, sizeof(message.event), "%s", event);
+  snprintf(message.json, sizeof(message.json), "%s", json);
+  message.id = id;
+  // Never blocks the caller; a subscriber that missed one gets the next
+  if (xQueueSend(statusEvents, &message, 0) != pdTRUE)
+    LOG_DEBUG("⚠️ Status event queue full, %s dropped\n", event);
+}
+
+static void Server_StatusSender(void *parameter) {
+  (void)parameter;
+  StatusEvent message;
+  unsigned long lastHeartbeat = millis();
+  for (;;) {
+    if (xQueueReceive(statusEvents, &message,
+                      pdMS_TO_TICKS(STATUS_HEARTBEAT_MS)) == pdTRUE &&
+        events.count() > 0)
+      events.send(message.json, message.event, message.id);
+
+    if (millis() - lastHeartbeat < STATUS_HEARTBEAT_MS)
+      continue;
+    lastHeartbeat = millis();
+    if (events.count() == 0)
+      continue;
+    char json[64];
+    snprintf(json, sizeof(json), "{\"uptime\":%lu,\"freeHeap\":%lu}",
+             millis() / 1000, (unsigned long)ESP.getFreeHeap());
+    events.send(json, "heartbeat", 0);
+  }
+}
+
+void Server_SetupEvents() {
+  // Check authentication (IP-only); others get a 404
+  events.setFilter([](AsyncWebServerRequest *request) {
+    return ValidateIPFromRequest(request);
+  });
+  events.onConnect([](AsyncEventSourceClient *client) {
+    StatusInfo status = Status_Get();
+    char json[STATUS_EVENT_MAX];
+    Status_FormatJson(status, json, sizeof(json));
+    client->send(json, "status", status.seq, 5000); // retry after 5 s
+  });
+  server.addHandler(&events);
+
+  statusEvents = xQueueCreate(STATUS_QUEUE_LENGTH, sizeof(StatusEvent));
+  if (!statusEvents ||
+      xTaskCreate(Server_StatusSender, "sse", STATUS_SENDER_STACK, nullptr,
+                  STATUS_SENDER_PRIORITY, nullptr) != pdPASS) {
+    Serial.println("❌ Cannot start the status event sender");
+    return;
+  }
+  Status_SetListener(Server_PushStatus);
+}
+
 // ============ SERVER SETUP ============
 void Server_Setup() {
   server.on("/", HTTP_GET,
@@ -447,10 +701,7 @@ void Server_Setup() {
   server.onNotFound([](AsyncWebServerRequest *request) {
     String path = request->url();
     // Check if it's a static file request (CSS, JS, images, etc.)
-    if (path.endsWith(".css") || path.endsWith(".js") ||
-        path.endsWith(".png") || path.endsWith(".jpg") ||
-        path.endsWith(".jpeg") || path.endsWith(".gif") ||
-        path.endsWith(".svg") || path.endsWith(".ico")) {
+    if (Assets_Find(path.c_str())) {
       Server_HandleStaticFile(request);
       return;
     }
@@ -627,6 +878,17 @@ void Server_Setup() {
         }
       });
 
+  server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request) {
+    Server_HandleTrace(request);
+  });
+
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    Server_HandleMetrics(request);
+  });
+
+  // ============ STATUS EVENTS (SSE) ============
+  Server_SetupEvents();
+
   // ============ ESP32 STATUS ENDPOINT (REAL-TIME) ============
   server.on("/api/esp32status", HTTP_GET, [](AsyncWebServerRequest *request) {
     // Check authentication (IP-only)
@@ -654,12 +916,114 @@ void Server_Setup() {
     size_t freeHeap = ESP.getFreeHeap();
     String memoryStr = String(freeHeap / 1024) + " KB";
 
+    StatusInfo status = Status_Get();
+    // Delta sync counts of the last cycle
+    SnapshotStats delta = Snapshot_GetStats();
+    // Firebase write round-trip times and the timeout derived from them
+    RttStats rtt = Rtt_GetStats();
+    // Updates waiting in the write-ahead log for the RTDB to be reachable
+    WalStats wal = Wal_GetStats();
+    // Restart indicators and the reasons of earlier restarts (NVS)
+    HealthStats health = Health_GetStats();
+    HealthRestart restarts[HEALTH_HISTORY];
+    int restartCount = Health_GetHistory(restarts, HEALTH_HISTORY);
+    // WebDavis connection and session reuse
+    WebDavisStats webdavis = WebDavis_GetStats();
+    // WebDavis page rate and what each config took last time
+    PacingStats pacing = Pacing_GetStats();
+    PacingConfigStats pacingConfigs[PACING_MAX_CONFIGS];
+    int pacingCount = Pacing_GetConfigs(pacingConfigs, PACING_MAX_CONFIGS);
+    // Pages skipped because their rows hashed as in the last cycle
+    PageCacheStats pageCache = PageCache_GetStats();
+
     // Build JSON response
     String json = "{";
-    json += "\"icon\":\"" + esp32StatusIcon + "\",";
-    json += "\"message\":\"" + esp32Status + "\",";
+    json += "\"icon\":\"" + String(status.icon) + "\",";
+    json += "\"message\":\"" + String(status.message) + "\",";
     json += "\"uptime\":\"" + uptimeStr + "\",";
     json += "\"freeMemory\":\"" + memoryStr + "\",";
+    json += "\"delta\":{";
+    json += "\"changed\":" + String(delta.flights[SNAPSHOT_CHANGED]) + ",";
+    json += "\"unchanged\":" + String(delta.flights[SNAPSHOT_UNCHANGED]) + ",";
+    json += "\"new\":" + String(delta.flights[SNAPSHOT_NEW]) + ",";
+    json += "\"fieldsChanged\":" + String(delta.fieldsChanged) + ",";
+    json += "\"fullSync\":" + String(delta.fullSync ? "true" : "false");
+    json += "},";
+    json += "\"rtt\":{";
+    json += "\"srtt\":" + String(rtt.srtt) + ",";
+    json += "\"rttvar\":" + String(rtt.rttvar) + ",";
+    json += "\"timeout\":" + String(rtt.timeout) + ",";
+    json += "\"p50\":" + String(rtt.p50) + ",";
+    json += "\"p90\":" + String(rtt.p90) + ",";
+    json += "\"p99\":" + String(rtt.p99) + ",";
+    json += "\"max\":" + String(rtt.max) + ",";
+    json += "\"samples\":" + String(rtt.samples) + ",";
+    json += "\"timeouts\":" + String(rtt.timeouts) + ",";
+    json += "\"retries\":" + String(rtt.retries);
+    json += "},";
+    json += "\"wal\":{";
+    json += "\"bytes\":" + String(wal.bytes) + ",";
+    json += "\"records\":" + String(wal.records) + ",";
+    json += "\"appended\":" + String(wal.appended) + ",";
+    json += "\"replayed\":" + String(wal.replayed) + ",";
+    json += "\"evicted\":" + String(wal.evicted);
+    json += "},";
+    json += "\"health\":{";
+    json += "\"cycles\":" + String(health.cycles) + ",";
+    json += "\"failedCycles\":" + String(health.failedCycles) + ",";
+    json += "\"watchdogMisses\":" + String(health.watchdogMisses) + ",";
+    json += "\"largestBlock\":" + String(health.largestBlock) + ",";
+    json += "\"minLargestBlock\":" + String(health.minLargestBlock) + ",";
+    json += "\"heartbeatAge\":" + String(health.heartbeatAge) + ",";
+    json += "\"restarts\":" + String(health.restarts) + ",";
+    json += "\"history\":[";
+    for (int i = 0; i < restartCount; i++) {
+      if (i)
+        json += ",";
+      json += "{\"reason\":\"" +
+              String(HEALTH_REASON_NAMES[restarts[i].reason]) + "\",";
+      json += "\"value\":" + String(restarts[i].value) + ",";
+      json += "\"uptime\":" + String(restarts[i].uptime) + ",";
+      json += "\"cycles\":" + String(restarts[i].cycles) + "}";
+    }
+    json += "]";
+    json += "},";
+    json += "\"webdavis\":{";
+    json += "\"requests\":" + String(webdavis.requests) + ",";
+    json += "\"connections\":" + String(webdavis.connections) + ",";
+    json += "\"sessions\":" + String(webdavis.sessions) + ",";
+    json += "\"rotations\":" + String(webdavis.rotations) + ",";
+    json += "\"truncated\":" + String(webdavis.truncated);
+    json += "},";
+    json += "\"pacing\":{";
+    json += "\"rate\":" + String(pacing.rate) + ",";
+    json += "\"planned\":" + String(pacing.planned) + ",";
+    json += "\"fetched\":" + String(pacing.fetched) + ",";
+    json += "\"backoffs\":" + String(pacing.backoffs) + ",";
+    json += "\"errors\":" + String(pacing.errors) + ",";
+    json += "\"configs\":[";
+    for (int i = 0; i < pacingCount; i++) {
+      if (i)
+        json += ",";
+      json += "{\"config\":\"" + String(pacingConfigs[i].config) + "\",";
+      json += "\"pages\":" + String(pacingConfigs[i].pages) + ",";
+      json += "\"errors\":" + String(pacingConfigs[i].errors) + ",";
+      json += "\"latency\":" + String(pacingConfigs[i].latency) + ",";
+      json += "\"interval\":" + String(pacingConfigs[i].interval) + ",";
+      json += "\"duration\":" + String(pacingConfigs[i].duration) + "}";
+    }
+    json += "]";
+    json += "},";
+    json += "\"pageCache\":{";
+    json += "\"enabled\":" + String(pageCache.enabled ? "true" : "false") + ",";
+    json += "\"hits\":" + String(pageCache.hits) + ",";
+    json += "\"misses\":" + String(pageCache.misses) + ",";
+    json += "\"forced\":" + String(pageCache.forced) + ",";
+    json += "\"carried\":" + String(pageCache.carried) + ",";
+    json += "\"skippedBytes\":" + String(pageCache.skippedBytes) + ",";
+    json += "\"totalHits\":" + String(pageCache.totalHits) + ",";
+    json += "\"totalMisses\":" + String(pageCache.totalMisses);
+    json += "},";
     json += "\"timestamp\":\"" + NTP_GetFormattedTimestamp() + "\"";
     json += "}";
 
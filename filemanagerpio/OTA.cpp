@@ -109,6 +109,7 @@ void OTA_HandleFileUpload(AsyncWebServerRequest *request, const String& filename
     // Schedule restart
     otaInProgress = false;
     delay(4500);  // Total 5 seconds (500ms for response + 4500ms wait)
+    Health_Record(HEALTH_FIRMWARE_UPDATE, 0);
     ESP.restart();
   }
 }
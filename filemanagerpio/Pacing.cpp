@@ -0,0 +1,150 @@
+#include "Global.h"
+
+// ============ PAGE PACING ============
+// Fetch() used to sleep 8.5 s after every page, sized for 35 pages in five
+// minutes, so three pages cost 25 s of sleep as well. Pages now go out at
+// the configured rate, measured from the start of one request to the start
+// of the next, and the rate adapts to the server (AIMD):
+//
+//   slow page or error   interval doubles, up to PACING_MAX_INTERVAL_MS
+//   good page            interval shrinks by PACING_STEP_MS, down to the
+//                        target
+//
+// A page is slow when it takes longer than PACING_SLOW_MS or
+// PACING_SLOW_FACTOR times the config's smoothed latency. The relative test
+// only counts above PACING_SLOW_FLOOR_MS: on the LAN a 100 ms page that
+// takes 300 ms, or the first request on a new connection, is jitter, not a
+// server under load. Every request is followed by at least
+// PACING_MIN_GAP_MS of idle time.
+//
+// Each config keeps its page count, latency and final interval. The next
+// cycle starts from that interval and plans its fetch time from the counts.
+
+static PacingConfigStats configs[PACING_MAX_CONFIGS];
+static uint8_t configCount = 0;
+static PacingConfigStats *current = nullptr;
+static uint32_t targetInterval = 60000 / PACING_DEFAULT_RATE;
+static uint32_t interval = 60000 / PACING_DEFAULT_RATE;
+static uint16_t errorsInRow = 0;
+static unsigned long configStart = 0;
+static PacingStats stats = {PACING_DEFAULT_RATE, 0, 0, 0, 0};
+
+void Pacing_SetRate(uint32_t perMinute) {
+  if (perMinute == 0)
+    perMinute = 1;
+  stats.rate = perMinute;
+  targetInterval = 60000 / perMinute;
+}
+
+static PacingConfigStats *FindConfig(const char *config) {
+  for (int i = 0; i < configCount; i++)
+    if (strcmp(configs[i].config, config) == 0)
+      return &configs[i];
+  if (configCount == PACING_MAX_CONFIGS)
+    return nullptr;
+  PacingConfigStats *entry = &configs[configCount++];
+  *entry = {};
+  snprintf(entry->config, sizeof(entry->config), "%s", config);
+  return entry;
+}
+
+// Expected time of one config: every page waits out the larger of its
+// interval and its latency plus the idle gap, except the last
+static uint32_t PlanConfig(const PacingConfigStats &config) {
+  uint32_t start = config.interval > targetInterval ? config.interval
+                                                    : targetInterval;
+  uint32_t perPage = config.latency + PACING_MIN_GAP_MS;
+  if (perPage < start)
+    perPage = start;
+  return config.pages ? (config.pages - 1) * perPage + config.latency : 0;
+}
+
+uint32_t Pacing_PlanCycle() {
+  uint32_t planned = 0;
+  int pages = 0;
+  for (int i = 0; i < configCount; i++) {
+    planned += PlanConfig(configs[i]);
+    pages += configs[i].pages;
+  }
+  stats.planned = planned;
+  if (configCount) {
+    Serial.printf("⏱️ Fetch plan: %d pages in %d configs, ~%lu s at %lu "
+                  "pages/min\n",
+                  pages, configCount, (unsigned long)(planned / 1000),
+                  (unsigned long)stats.rate);
+  }
+  return planned;
+}
+
+void Pacing_Begin(const char *config) {
+  current = FindConfig(config);
+  // Resume where the server left us last cycle, never faster than the target
+  interval = current && current->interval > targetInterval ? current->interval
+                                                            : targetInterval;
+  errorsInRow = 0;
+  configStart = millis();
+  if (current)
+    current->errors = 0;
+}
+
+bool Pacing_PageDone(uint32_t latencyMs, bool ok, uint32_t &waitMs) {
+  uint32_t usual = current ? current->latency : 0;
+  bool slow = latencyMs > PACING_SLOW_MS ||
+              (usual && latencyMs > max(usual * PACING_SLOW_FACTOR,
+                                        (uint32_t)PACING_SLOW_FLOOR_MS));
+
+  if (!ok || slow) {
+    interval = interval * 2 < PACING_MAX_INTERVAL_MS ? interval * 2
+                                                     : PACING_MAX_INTERVAL_MS;
+    stats.backoffs++;
+    LOG_WARN("🐢 Page %s after %lu ms, next request in %lu ms\n",
+             ok ? "slow" : "failed", (unsigned long)latencyMs,
+             (unsigned long)interval);
+  } else if (interval > targetInterval) {
+    interval = interval - targetInterval > PACING_STEP_MS
+                   ? interval - PACING_STEP_MS
+                   : targetInterval;
+  }
+
+  if (ok) {
+    errorsInRow = 0;
+    if (current)
+      current->latency = usual ? (3 * usual + latencyMs) / 4 : latencyMs;
+  } else {
+    errorsInRow++;
+    stats.errors++;
+    if (current)
+      current->errors++;
+  }
+
+  waitMs = interval > latencyMs + PACING_MIN_GAP_MS ? interval - latencyMs
+                                                    : PACING_MIN_GAP_MS;
+  return errorsInRow < PACING_MAX_ERRORS;
+}
+
+void Pacing_End(int pages) {
+  if (!current)
+    return;
+  current->pages = pages > 0 ? pages : 0;
+  current->interval = interval;
+  current->duration = millis() - configStart;
+  Serial.printf("⏱️ %s: %d pages in %lu ms, latency ~%lu ms\n",
+                current->config, current->pages,
+                (unsigned long)current->duration,
+                (unsigned long)current->latency);
+  current = nullptr;
+}
+
+PacingStats Pacing_GetStats() {
+  PacingStats result = stats;
+  result.fetched = 0;
+  for (int i = 0; i < configCount; i++)
+    result.fetched += configs[i].duration;
+  return result;
+}
+
+int Pacing_GetConfigs(PacingConfigStats *out, int max) {
+  int count = configCount < max ? configCount : max;
+  memcpy(out, configs, count * sizeof(PacingConfigStats));
+  return count;
+}
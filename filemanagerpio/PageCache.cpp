@@ -0,0 +1,366 @@
+#include "Global.h"
+
+// ============ PAGE CACHE ============
+// Most of the flight board does not change between cycles. Every page body
+// is read into a PSRAM arena and only its pager and session lines are
+// scanned; the rows are hashed (xxHash32) on the way. The page is parsed only
+// when the hash differs from the same config and page number last cycle.
+// Otherwise none of its cells are extracted and the flights it had last time
+// are carried into the snapshot as unchanged, so the uploader never sees
+// them.
+//
+// Skipping is only safe when nothing parsed this cycle merges into the same
+// flight, so an unchanged page is parsed anyway ("forced") when:
+//
+//   a flight on it is already in the store   an earlier page was parsed and
+//                                            this one would overwrite it
+//   another page of a whole config changed   check-in counters (ckco) are
+//                                            collected across pages; such a
+//                                            config is held until its end
+//
+// A flight on a skipped page that is parsed again from a later page is
+// diffed against its carried entry, which is what the RTDB has.
+//
+// Hashes are trusted only after a clean cycle, one with every update written
+// to the RTDB. Full sync cycles parse everything but still record hashes.
+
+#define XXH_PRIME1 0x9E3779B1U
+#define XXH_PRIME2 0x85EBCA77U
+#define XXH_PRIME3 0xC2B2AE3DU
+#define XXH_PRIME4 0x27D4EB2FU
+#define XXH_PRIME5 0x165667B1U
+
+struct PageEntry {
+  uint32_t config; // FNV-1a of the config path
+  uint32_t hash;   // xxHash32 of the page's rows
+  uint16_t page;   // 0 = not comparable (too many flights)
+  uint16_t firstKey;
+  uint16_t keyCount;
+};
+
+struct PageFlight {
+  FlightKey key;
+  uint8_t category; // FlightCategory
+};
+
+struct PageTable {
+  PageEntry pages[PAGE_CACHE_MAX_PAGES];
+  PageFlight flights[PAGE_CACHE_MAX_KEYS];
+  uint16_t pageCount;
+  uint16_t flightCount;
+};
+
+struct HeldPage {
+  uint32_t offset; // into the arena
+  uint32_t len;
+  uint32_t hash;
+  int page;
+};
+
+struct RowHash { // streaming xxHash32, seed 0
+  uint32_t v[4];
+  uint32_t total;
+  uint8_t buffer[16];
+  uint8_t buffered;
+};
+
+static PageTable *previous = nullptr; // last clean cycle
+static PageTable *next = nullptr;     // this cycle
+static bool previousValid = false;
+static char *arena = nullptr;
+static size_t arenaUsed = 0;
+static HeldPage held[PAGE_CACHE_MAX_PENDING];
+static uint8_t heldCount = 0;
+static uint32_t config = 0;
+static bool wholeConfig = false;
+static bool streaming = false; // arena overflowed: parsed while read
+static PageEntry *recording = nullptr; // page being parsed
+static RowHash rowHash;
+static PageCacheStats stats = {};
+
+// ============ xxHash32 ============
+static uint32_t Rotl(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+static uint32_t Read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, 4); // little endian on the ESP32
+  return v;
+}
+
+static uint32_t Round(uint32_t acc, uint32_t input) {
+  acc += input * XXH_PRIME2;
+  return Rotl(acc, 13) * XXH_PRIME1;
+}
+
+static void Hash_Begin(RowHash &h) {
+  h.v[0] = XXH_PRIME1 + XXH_PRIME2;
+  h.v[1] = XXH_PRIME2;
+  h.v[2] = 0;
+  h.v[3] = 0 - XXH_PRIME1;
+  h.total = 0;
+  h.buffered = 0;
+}
+
+static void Hash_Update(RowHash &h, const uint8_t *p, size_t len) {
+  h.total += len;
+  while (len) {
+    size_t room = 16 - h.buffered;
+    size_t take = room < len ? room : len;
+    memcpy(h.buffer + h.buffered, p, take);
+    h.buffered += take;
+    p += take;
+    len -= take;
+    if (h.buffered == 16) {
+      for (int i = 0; i < 4; i++)
+        h.v[i] = Round(h.v[i], Read32(h.buffer + 4 * i));
+      h.buffered = 0;
+    }
+  }
+}
+
+static uint32_t Hash_End(const RowHash &h) {
+  uint32_t acc = h.total >= 16 ? Rotl(h.v[0], 1) + Rotl(h.v[1], 7) +
+                                     Rotl(h.v[2], 12) + Rotl(h.v[3], 18)
+                               : XXH_PRIME5;
+  acc += h.total;
+  const uint8_t *p = h.buffer;
+  const uint8_t *end = h.buffer + h.buffered;
+  for (; p + 4 <= end; p += 4)
+    acc = Rotl(acc + Read32(p) * XXH_PRIME3, 17) * XXH_PRIME4;
+  for (; p < end; p++)
+    acc = Rotl(acc + *p * XXH_PRIME5, 11) * XXH_PRIME1;
+  acc ^= acc >> 15;
+  acc *= XXH_PRIME2;
+  acc ^= acc >> 13;
+  acc *= XXH_PRIME3;
+  acc ^= acc >> 16;
+  return acc;
+}
+
+// ============ PAGE TABLES ============
+static uint32_t ConfigHash(const char *text) {
+  uint32_t hash = 2166136261u;
+  for (; *text; text++) {
+    hash ^= (uint8_t)*text;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Last cycle's entry when this page is the same and every flight on it can
+// be carried over
+static const PageEntry *Unchanged(const HeldPage &page) {
+  if (!previousValid || page.page <= 0)
+    return nullptr;
+  for (int i = 0; i < previous->pageCount; i++) {
+    const PageEntry &entry = previous->pages[i];
+    if (entry.config != config || entry.page != page.page)
+      continue;
+    if (entry.hash != page.hash)
+      return nullptr;
+    for (int k = 0; k < entry.keyCount; k++) {
+      const PageFlight &flight = previous->flights[entry.firstKey + k];
+      if (!Snapshot_Has((FlightCategory)flight.category, flight.key))
+        return nullptr;
+    }
+    return &entry;
+  }
+  return nullptr;
+}
+
+// Some flight of the page was parsed this cycle
+static bool Touched(const PageEntry &entry) {
+  bool touched = false;
+  FlightStore_Lock();
+  for (int k = 0; k < entry.keyCount && !touched; k++) {
+    const PageFlight &flight = previous->flights[entry.firstKey + k];
+    touched = FlightStore_Find((FlightCategory)flight.category, flight.key) >= 0;
+  }
+  FlightStore_Unlock();
+  return touched;
+}
+
+static PageEntry *AddEntry(const HeldPage &page) {
+  if (page.page <= 0 || next->pageCount >= PAGE_CACHE_MAX_PAGES)
+    return nullptr;
+  PageEntry *entry = &next->pages[next->pageCount++];
+  entry->config = config;
+  entry->hash = page.hash;
+  entry->page = page.page;
+  entry->firstKey = next->flightCount;
+  entry->keyCount = 0;
+  return entry;
+}
+
+static void Skip(const HeldPage &page, const PageEntry &old) {
+  PageEntry *entry = AddEntry(page);
+  if (entry && next->flightCount + old.keyCount > PAGE_CACHE_MAX_KEYS)
+    entry->page = 0;
+  FlightStore_Lock(); // the uploader diffs against the snapshot meanwhile
+  for (int k = 0; k < old.keyCount; k++) {
+    const PageFlight &flight = previous->flights[old.firstKey + k];
+    Snapshot_Carry((FlightCategory)flight.category, flight.key);
+    if (entry && entry->page)
+      next->flights[next->flightCount++] = flight;
+  }
+  FlightStore_Unlock();
+  if (entry && entry->page)
+    entry->keyCount = old.keyCount;
+  stats.hits++;
+  stats.totalHits++;
+  stats.carried += old.keyCount;
+  stats.skippedBytes += page.len;
+  TRACE(TRACE_PAGE_SKIPPED, page.page, old.keyCount);
+  LOG_DEBUG("♻️ Page %d unchanged, %u rows carried over\n", page.page,
+            old.keyCount);
+}
+
+static void Parse(const HeldPage &page, bool wasUnchanged,
+                  PageCacheParser parser, void *context) {
+  recording = AddEntry(page);
+  parser(arena + page.offset, page.len, context);
+  recording = nullptr;
+  if (wasUnchanged) {
+    stats.forced++;
+  } else {
+    stats.misses++;
+    stats.totalMisses++;
+  }
+}
+
+// Parses or skips the held pages in the order they were fetched
+static void Process(bool parseAll, PageCacheParser parser, void *context) {
+  parseAll = parseAll || !stats.enabled;
+  if (!parseAll && wholeConfig) {
+    for (int i = 0; i < heldCount && !parseAll; i++) {
+      const PageEntry *old = Unchanged(held[i]);
+      parseAll = !old || Touched(*old);
+    }
+  }
+  for (int i = 0; i < heldCount; i++) {
+    const PageEntry *old = stats.enabled ? Unchanged(held[i]) : nullptr;
+    if (old && !parseAll && !Touched(*old))
+      Skip(held[i], *old);
+    else
+      Parse(held[i], old != nullptr, parser, context);
+  }
+  heldCount = 0;
+  arenaUsed = 0;
+}
+
+bool PageCache_Init() {
+  if (arena)
+    return true;
+  arena = (char *)ps_malloc(PAGE_CACHE_ARENA_BYTES);
+  previous = (PageTable *)ps_calloc(1, sizeof(PageTable));
+  next = (PageTable *)ps_calloc(1, sizeof(PageTable));
+  if (!arena || !previous || !next) {
+    Serial.println("❌ Page cache: cannot allocate, every page is parsed");
+    free(arena);
+    free(previous);
+    free(next);
+    arena = nullptr;
+    previous = next = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void PageCache_BeginCycle(bool enabled) {
+  uint32_t totalHits = stats.totalHits;
+  uint32_t totalMisses = stats.totalMisses;
+  stats = {};
+  stats.totalHits = totalHits;
+  stats.totalMisses = totalMisses;
+  stats.enabled = enabled && arena && previousValid;
+  if (next) {
+    next->pageCount = 0;
+    next->flightCount = 0;
+  }
+}
+
+void PageCache_BeginConfig(const char *name, bool whole) {
+  config = ConfigHash(name);
+  wholeConfig = whole;
+  streaming = false;
+  heldCount = 0;
+  arenaUsed = 0;
+}
+
+char *PageCache_Reserve(size_t &capacity) {
+  if (!arena || streaming)
+    return nullptr;
+  // Full: the first byte overflows and the page is parsed while read
+  capacity = heldCount < PAGE_CACHE_MAX_PENDING
+                 ? PAGE_CACHE_ARENA_BYTES - arenaUsed
+                 : 0;
+  Hash_Begin(rowHash);
+  return arena + arenaUsed;
+}
+
+void PageCache_HashRow(const char *row, size_t len) {
+  Hash_Update(rowHash, (const uint8_t *)row, len);
+}
+
+void PageCache_AddPage(int page, size_t len, PageCacheParser parser,
+                       void *context) {
+  if (!arena || streaming) {
+    stats.misses++;
+    stats.totalMisses++;
+    return; // parsed while it was read
+  }
+  // Page numbers went back: the config started over on a new session
+  int keep = 0;
+  while (keep < heldCount && (page <= 0 || held[keep].page < page))
+    keep++;
+  heldCount = keep;
+
+  HeldPage &entry = held[heldCount++];
+  entry.offset = arenaUsed;
+  entry.len = len;
+  entry.hash = Hash_End(rowHash);
+  entry.page = page;
+  arenaUsed += len;
+  if (!wholeConfig)
+    Process(false, parser, context);
+}
+
+void PageCache_Overflow(PageCacheParser parser, void *context) {
+  Serial.println("⚠️ Page cache full, parsing the rest of this config as it "
+                 "arrives");
+  Process(true, parser, context);
+  streaming = true;
+}
+
+void PageCache_NoteFlight(FlightCategory category, FlightKey key) {
+  if (!recording)
+    return;
+  if (next->flightCount >= PAGE_CACHE_MAX_KEYS) {
+    recording->page = 0; // incomplete list: never skipped
+    recording = nullptr;
+    return;
+  }
+  next->flights[next->flightCount++] = {key, category};
+  recording->keyCount++;
+}
+
+void PageCache_EndConfig(PageCacheParser parser, void *context) {
+  if (arena && !streaming)
+    Process(false, parser, context);
+  streaming = false;
+}
+
+void PageCache_EndCycle(bool clean) {
+  if (!next)
+    return;
+  if (!clean) {
+    previousValid = false; // some flights may not be written as hashed
+    return;
+  }
+  PageTable *swap = previous;
+  previous = next;
+  next = swap;
+  previousValid = true;
+}
+
+PageCacheStats PageCache_GetStats() { return stats; }
@@ -0,0 +1,181 @@
+#include "Global.h"
+
+// ============ STREAMING ROW TOKENIZER ============
+// Consumes raw page bytes in whatever chunks WiFiClient hands out and reports
+// table rows without building a String per line or per row:
+//   - bytes inside <tr class='row_0|1'> ... </tr> are copied once into the
+//     fixed row buffer, with each line trimmed and lines joined by a single
+//     space (the same text the old readStringUntil/trim/+= loop produced)
+//   - every complete <td ...>...</td> is reported as a view into that buffer
+//   - text outside rows is reported line by line from the line buffer, for
+//     the Page: and PHPSESSID markers
+// Views are only valid for the duration of the callback.
+
+static const char ROW_OPEN_0[] = "<tr class='row_0'>";
+static const char ROW_OPEN_1[] = "<tr class='row_1'>";
+static const char ROW_CLOSE[] = "</tr>";
+static const char CELL_CLOSE[] = "</td>";
+static const size_t NO_CELL = (size_t)-1;
+
+// Bytes kept when a long line is flushed early, so a marker straddling the
+// flush point is still seen whole in the next LINE event
+static const size_t LINE_OVERLAP = 64;
+
+static bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool TailEndsWith(const RowTokenizer &tok, const char *pattern,
+                         size_t patternLen) {
+  if (tok.tailLen < patternLen)
+    return false;
+  return memcmp(tok.tail + sizeof(tok.tail) - patternLen, pattern,
+                patternLen) == 0;
+}
+
+static void PushTail(RowTokenizer &tok, char c) {
+  memmove(tok.tail, tok.tail + 1, sizeof(tok.tail) - 1);
+  tok.tail[sizeof(tok.tail) - 1] = c;
+  if (tok.tailLen < sizeof(tok.tail))
+    tok.tailLen++;
+}
+
+static void EmitLine(RowTokenizer &tok) {
+  size_t start = 0;
+  size_t end = tok.lineLen;
+  while (start < end && IsBlank(tok.line[start]))
+    start++;
+  while (end > start && IsBlank(tok.line[end - 1]))
+    end--;
+  if (end > start) {
+    tok.line[end] = '\0';
+    tok.callback(TOKEN_LINE, tok.line + start, end - start, tok.context);
+  }
+  tok.lineLen = 0;
+}
+
+static void AppendLine(RowTokenizer &tok, char c) {
+  if (tok.lineLen >= TOKENIZER_LINE_BUFFER - 1) {
+    // Flush the long line but keep its tail for markers crossing the cut
+    size_t keep = min(LINE_OVERLAP, tok.lineLen);
+    char saved[LINE_OVERLAP];
+    memcpy(saved, tok.line + tok.lineLen - keep, keep);
+    EmitLine(tok);
+    memcpy(tok.line, saved, keep);
+    tok.lineLen = keep;
+  }
+  tok.line[tok.lineLen++] = c;
+}
+
+static void AppendRow(RowTokenizer &tok, char c) {
+  if (tok.rowLen >= TOKENIZER_ROW_BUFFER - 1) {
+    tok.rowOverflow = true;
+    return;
+  }
+  tok.row[tok.rowLen++] = c;
+}
+
+static void BeginRow(RowTokenizer &tok, const char *openTag, size_t openLen) {
+  tok.inRow = true;
+  tok.rowOverflow = false;
+  tok.atLineStart = false;
+  tok.cellStart = NO_CELL;
+  memcpy(tok.row, openTag, openLen);
+  tok.rowLen = openLen;
+  tok.lineLen = 0; // the opening tag belongs to the row, not to a line
+  tok.callback(TOKEN_ROW_BEGIN, tok.row, tok.rowLen, tok.context);
+}
+
+static void EndRow(RowTokenizer &tok) {
+  tok.inRow = false;
+  tok.row[tok.rowLen] = '\0';
+  if (tok.rowOverflow) {
+    tok.rowsDropped++;
+    tok.callback(TOKEN_ROW_DROPPED, tok.row, tok.rowLen, tok.context);
+  } else {
+    tok.callback(TOKEN_ROW_END, tok.row, tok.rowLen, tok.context);
+  }
+  tok.rowLen = 0;
+  tok.cellStart = NO_CELL;
+}
+
+static void FeedRowByte(RowTokenizer &tok, char c) {
+  if (c == '\n') {
+    // Trim the line just finished; the next non-blank byte starts a new
+    // line and is preceded by exactly one space
+    while (tok.rowLen > 0 && IsBlank(tok.row[tok.rowLen - 1]))
+      tok.rowLen--;
+    tok.atLineStart = true;
+    return;
+  }
+  if (tok.atLineStart) {
+    if (IsBlank(c))
+      return;
+    AppendRow(tok, ' ');
+    tok.atLineStart = false;
+  }
+  AppendRow(tok, c);
+
+  if (c == 'd' && tok.rowLen >= 3 && tok.row[tok.rowLen - 2] == 't' &&
+      tok.row[tok.rowLen - 3] == '<') {
+    tok.cellStart = tok.rowLen - 3;
+  } else if (c == '>') {
+    if (tok.cellStart != NO_CELL &&
+        TailEndsWith(tok, CELL_CLOSE, sizeof(CELL_CLOSE) - 1)) {
+      if (!tok.rowOverflow)
+        tok.callback(TOKEN_CELL, tok.row + tok.cellStart,
+                     tok.rowLen - tok.cellStart, tok.context);
+      tok.cellStart = NO_CELL;
+    } else if (TailEndsWith(tok, ROW_CLOSE, sizeof(ROW_CLOSE) - 1)) {
+      EndRow(tok);
+    }
+  }
+}
+
+void Tokenizer_Begin(RowTokenizer &tok, TokenizerCallback callback,
+                     void *context) {
+  tok.rowLen = 0;
+  tok.lineLen = 0;
+  tok.tailLen = 0;
+  tok.cellStart = NO_CELL;
+  tok.inRow = false;
+  tok.rowOverflow = false;
+  tok.atLineStart = false;
+  tok.rowsDropped = 0;
+  tok.callback = callback;
+  tok.context = context;
+}
+
+void Tokenizer_Feed(RowTokenizer &tok, const char *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+    PushTail(tok, c);
+
+    if (tok.inRow) {
+      FeedRowByte(tok, c);
+      continue;
+    }
+
+    if (c == '\n') {
+      EmitLine(tok);
+      continue;
+    }
+    AppendLine(tok, c);
+
+    if (c == '>') {
+      if (TailEndsWith(tok, ROW_OPEN_0, sizeof(ROW_OPEN_0) - 1))
+        BeginRow(tok, ROW_OPEN_0, sizeof(ROW_OPEN_0) - 1);
+      else if (TailEndsWith(tok, ROW_OPEN_1, sizeof(ROW_OPEN_1) - 1))
+        BeginRow(tok, ROW_OPEN_1, sizeof(ROW_OPEN_1) - 1);
+    }
+  }
+}
+
+void Tokenizer_End(RowTokenizer &tok) {
+  // A page cut off mid-row never produced its </tr>; drop the partial row
+  if (tok.inRow) {
+    tok.rowOverflow = true;
+    EndRow(tok);
+  }
+  EmitLine(tok);
+}
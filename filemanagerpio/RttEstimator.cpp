@@ -0,0 +1,97 @@
+#include "Global.h"
+
+// ============ RTT ESTIMATOR ============
+// TCP-style retransmission timer (RFC 6298) over completed RTDB writes:
+//
+//   first sample   SRTT = R, RTTVAR = R / 2
+//   then           RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|
+//                  SRTT   = 7/8 SRTT   + 1/8 R
+//   timeout        SRTT + 4 RTTVAR, clamped to RTT_MIN/MAX_TIMEOUT
+//
+// A timeout doubles the timer until the next clean sample (Karn), and
+// samples from retried requests are not used because it is unknown which
+// attempt was answered. The last RTT_HISTORY samples are kept for the
+// percentiles reported by the status API.
+
+static uint32_t srtt = 0;   // ms, 0 = no sample yet
+static uint32_t rttvar = 0; // ms
+static uint8_t backoffShift = 0;
+static uint32_t history[RTT_HISTORY];
+static uint16_t historyNext = 0;
+static uint16_t historyCount = 0;
+static uint32_t sampleCount = 0;
+static uint32_t timeoutCount = 0;
+static uint32_t retryCount = 0;
+
+// A fresh connection starts from the estimate, not from the backed-off timer
+void Rtt_ResetBackoff() { backoffShift = 0; }
+
+void Rtt_AddSample(uint32_t ms) {
+  if (srtt == 0) {
+    srtt = max(ms, (uint32_t)1);
+    rttvar = ms / 2;
+  } else {
+    uint32_t error = srtt > ms ? srtt - ms : ms - srtt;
+    rttvar = (3 * rttvar + error) / 4;
+    srtt = max((7 * srtt + ms) / 8, (uint32_t)1);
+  }
+  backoffShift = 0;
+  Metrics_Observe(METRIC_RTDB_RTT, ms);
+
+  history[historyNext] = ms;
+  historyNext = (historyNext + 1) % RTT_HISTORY;
+  if (historyCount < RTT_HISTORY)
+    historyCount++;
+  sampleCount++;
+}
+
+void Rtt_OnTimeout() {
+  timeoutCount++;
+  if (backoffShift < 6)
+    backoffShift++;
+}
+
+void Rtt_OnRetry() { retryCount++; }
+
+uint32_t Rtt_Timeout() {
+  uint32_t rto = srtt ? srtt + max((uint32_t)RTT_CLOCK_GRANULARITY, 4 * rttvar)
+                      : RTT_INITIAL_TIMEOUT;
+  rto = constrain(rto, (uint32_t)RTT_MIN_TIMEOUT, (uint32_t)RTT_MAX_TIMEOUT);
+  return min(rto << backoffShift, (uint32_t)RTT_MAX_TIMEOUT);
+}
+
+// "Full jitter": uniform in [0, min(cap, base * 2^attempt)], so clients that
+// failed together do not retry in lockstep
+uint32_t Rtt_BackoffDelay(uint8_t attempt) {
+  uint32_t ceiling = RTT_BACKOFF_BASE << min(attempt, (uint8_t)10);
+  ceiling = min(ceiling, (uint32_t)RTT_BACKOFF_CAP);
+  return random(ceiling + 1);
+}
+
+static int CompareMs(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+RttStats Rtt_GetStats() {
+  RttStats stats = {};
+  stats.srtt = srtt;
+  stats.rttvar = rttvar;
+  stats.timeout = Rtt_Timeout();
+  stats.samples = sampleCount;
+  stats.timeouts = timeoutCount;
+  stats.retries = retryCount;
+  if (historyCount == 0)
+    return stats;
+
+  uint32_t sorted[RTT_HISTORY];
+  memcpy(sorted, history, historyCount * sizeof(uint32_t));
+  qsort(sorted, historyCount, sizeof(uint32_t), CompareMs);
+  // Nearest-rank percentiles
+  stats.p50 = sorted[(historyCount * 50 + 99) / 100 - 1];
+  stats.p90 = sorted[(historyCount * 90 + 99) / 100 - 1];
+  stats.p99 = sorted[(historyCount * 99 + 99) / 100 - 1];
+  stats.max = sorted[historyCount - 1];
+  return stats;
+}
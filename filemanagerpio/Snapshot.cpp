@@ -0,0 +1,360 @@
+#include "Global.h"
+
+// ============ UPLOAD SNAPSHOT ============
+// Remembers what was last written to the RTDB for every flight as one 32-bit
+// FNV-1a hash per field, so a cycle only uploads flights and fields whose
+// values changed. The snapshot is written to LittleFS at the end of each
+// cycle and loaded at boot, which keeps it across a restart.
+//
+//   previous  sorted by (category, key), loaded from /snapshot.bin
+//   next      built during the cycle; only successful writes update hashes
+//   staged    hashes of the values a pending write carries, per next entry
+//
+// Hashes are staged when a flight is serialized and committed when its
+// write succeeds, so a value the scraper changes in between is not marked
+// as written. A flight queued again in the same cycle is compared with its
+// next entry, i.e. with what this cycle already wrote.
+//
+// Flights that are not scraped again are dropped from the next snapshot; if
+// they come back they are sent in full. Flights on a page that did not
+// change (PageCache.cpp) are carried into it without a diff. Every SNAPSHOT_FULL_SYNC_CYCLES
+// cycles everything is sent anyway, so edits made directly in the RTDB are
+// overwritten again eventually.
+
+#define SNAPSHOT_MAGIC 0x53534657UL // "WFSS"
+#define SNAPSHOT_VERSION 1
+
+struct SnapshotEntry {
+  FlightKey key;
+  FieldMask written; // fields whose hash reflects an RTDB write
+  uint8_t category;  // FlightCategory
+  uint8_t change;    // SnapshotChange of this cycle, not used when loaded
+  uint8_t reserved[2];
+  uint32_t hash[FIELD_COUNT];
+};
+
+struct SnapshotHeader {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t fieldCount; // layout changes with MANAGED_FIELD_LIST
+  uint16_t count;
+  uint16_t cyclesToFullSync;
+  uint16_t reserved;
+  uint32_t checksum; // FNV-1a over the entries
+};
+
+static SnapshotEntry *previous = nullptr;
+static SnapshotEntry *next = nullptr;
+static uint32_t (*staged)[FIELD_COUNT] = nullptr;
+static uint16_t previousCount = 0;
+static uint16_t nextCount = 0;
+static uint16_t cyclesToFullSync = 0;
+static SnapshotStats stats = {};
+
+static uint32_t HashBytes(uint32_t hash, const void *data, size_t len) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Includes the NUL so "a","bc" and "ab","c" hash differently
+static uint32_t HashText(uint32_t hash, const char *text) {
+  return HashBytes(hash, text, strlen(text) + 1);
+}
+
+static int CompareEntries(const void *a, const void *b) {
+  const SnapshotEntry *x = (const SnapshotEntry *)a;
+  const SnapshotEntry *y = (const SnapshotEntry *)b;
+  if (x->category != y->category)
+    return x->category < y->category ? -1 : 1;
+  if (x->key != y->key)
+    return x->key < y->key ? -1 : 1;
+  return 0;
+}
+
+static const SnapshotEntry *FindPrevious(FlightCategory category,
+                                         FlightKey key) {
+  SnapshotEntry probe = {};
+  probe.key = key;
+  probe.category = category;
+  return (const SnapshotEntry *)bsearch(&probe, previous, previousCount,
+                                        sizeof(SnapshotEntry), CompareEntries);
+}
+
+// Newest entries first: a flight queued again usually came with a recent
+// page
+static SnapshotEntry *FindNext(const FlightRecord &flight) {
+  for (int i = (int)nextCount - 1; i >= 0; i--) {
+    if (next[i].key == flight.key && next[i].category == flight.category)
+      return &next[i];
+  }
+  return nullptr;
+}
+
+// Hashes of the fields CreateFilteredFlightDoc() would send: present and,
+// except ckco, not empty
+static FieldMask HashFlight(const FlightRecord &flight, uint32_t *hash) {
+  FieldMask fields = 0;
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (!(flight.present & FIELD_BIT(id)))
+      continue;
+    uint32_t h = 2166136261u;
+    if (id == FIELD_CKCO) {
+      for (const CounterEntry *entry = FlightStore_GetCounter(flight.ckcoHead);
+           entry; entry = FlightStore_GetCounter(entry->next)) {
+        h = HashText(h, FlightStore_Text(entry->counter));
+        h = HashText(h, FlightStore_Text(entry->remark));
+        h = HashText(h, FlightStore_Text(entry->remarkLu));
+      }
+    } else {
+      const char *value = FlightStore_Text(flight.value[id]);
+      if (*value == '\0')
+        continue;
+      h = HashText(h, value);
+    }
+    hash[id] = h;
+    fields |= FIELD_BIT(id);
+  }
+  return fields;
+}
+
+static bool Snapshot_Load() {
+  File file = LittleFS.open(SNAPSHOT_PATH, "r");
+  if (!file)
+    return false;
+
+  SnapshotHeader header;
+  bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            header.magic == SNAPSHOT_MAGIC &&
+            header.version == SNAPSHOT_VERSION &&
+            header.fieldCount == FIELD_COUNT &&
+            header.count <= SNAPSHOT_CAPACITY;
+  if (ok) {
+    size_t bytes = header.count * sizeof(SnapshotEntry);
+    ok = file.read((uint8_t *)previous, bytes) == bytes &&
+         HashBytes(2166136261u, previous, bytes) == header.checksum;
+  }
+  file.close();
+
+  if (!ok) {
+    Serial.println("⚠️ Snapshot file invalid, next cycle uploads everything");
+    previousCount = 0;
+    return false;
+  }
+  previousCount = header.count;
+  cyclesToFullSync = header.cyclesToFullSync;
+  return true;
+}
+
+bool Snapshot_Init() {
+  if (previous)
+    return true;
+  previous =
+      (SnapshotEntry *)ps_calloc(SNAPSHOT_CAPACITY, sizeof(SnapshotEntry));
+  next = (SnapshotEntry *)ps_calloc(SNAPSHOT_CAPACITY, sizeof(SnapshotEntry));
+  staged = (uint32_t(*)[FIELD_COUNT])ps_calloc(SNAPSHOT_CAPACITY,
+                                               sizeof(*staged));
+  if (!previous || !next || !staged) {
+    Serial.println("❌ Snapshot: cannot allocate tables, delta sync disabled");
+    free(previous);
+    free(next);
+    free(staged);
+    previous = next = nullptr;
+    staged = nullptr;
+    return false;
+  }
+
+  if (Snapshot_Load()) {
+    Serial.printf("📸 Snapshot loaded: %u flights, full sync in %u cycles\n",
+                  previousCount, cyclesToFullSync);
+  } else {
+    Serial.println("📸 No snapshot yet, first cycle uploads everything");
+  }
+  return true;
+}
+
+void Snapshot_BeginCycle() {
+  nextCount = 0;
+  stats = {};
+  if (!previous) {
+    stats.fullSync = true;
+    return;
+  }
+  if (cyclesToFullSync == 0) {
+    stats.fullSync = true;
+    cyclesToFullSync = SNAPSHOT_FULL_SYNC_CYCLES;
+  }
+  cyclesToFullSync--;
+}
+
+SnapshotChange Snapshot_Diff(const FlightRecord &flight, FieldMask &changed) {
+  uint32_t hash[FIELD_COUNT];
+  FieldMask fields = HashFlight(flight, hash);
+
+  SnapshotEntry scratch;
+  SnapshotEntry *entry = next ? FindNext(flight) : nullptr;
+  bool again = entry != nullptr;
+  const SnapshotEntry *old = nullptr;
+  if (!again) {
+    // Carry the old hashes forward; Commit() updates the ones that get
+    // written
+    old = previous ? FindPrevious((FlightCategory)flight.category, flight.key)
+                   : nullptr;
+    entry = next && nextCount < SNAPSHOT_CAPACITY ? &next[nextCount++]
+                                                  : &scratch;
+    if (old) {
+      *entry = *old;
+    } else {
+      memset(entry, 0, sizeof(*entry));
+      entry->key = flight.key;
+      entry->category = flight.category;
+    }
+  }
+
+  changed = 0;
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if ((fields & FIELD_BIT(id)) &&
+        (!(entry->written & FIELD_BIT(id)) || entry->hash[id] != hash[id]))
+      changed |= FIELD_BIT(id);
+  }
+  stats.fieldsChanged += __builtin_popcount(changed);
+
+  if (again) {
+    // Counted when first seen; an unchanged flight may change later on
+    if (changed && entry->change == SNAPSHOT_UNCHANGED) {
+      stats.flights[SNAPSHOT_UNCHANGED]--;
+      stats.flights[SNAPSHOT_CHANGED]++;
+      entry->change = SNAPSHOT_CHANGED;
+    }
+    return (SnapshotChange)entry->change;
+  }
+
+  SnapshotChange change = !old      ? SNAPSHOT_NEW
+                          : changed ? SNAPSHOT_CHANGED
+                                    : SNAPSHOT_UNCHANGED;
+  entry->change = change;
+  stats.flights[change]++;
+  if (stats.fullSync) {
+    // Everything counts as unwritten until this cycle writes it
+    changed = fields;
+    entry->written = 0;
+  }
+  return change;
+}
+
+bool Snapshot_Has(FlightCategory category, FlightKey key) {
+  return previous && FindPrevious(category, key);
+}
+
+// A flight on a page that did not change since the last cycle: keep its
+// entry as is. Nothing to diff, it was not parsed at all.
+bool Snapshot_Carry(FlightCategory category, FlightKey key) {
+  if (!next)
+    return false;
+  const SnapshotEntry *old = FindPrevious(category, key);
+  if (!old)
+    return false;
+  for (int i = (int)nextCount - 1; i >= 0; i--) {
+    if (next[i].key == key && next[i].category == category)
+      return true; // on an earlier page too
+  }
+  if (nextCount >= SNAPSHOT_CAPACITY)
+    return false;
+  SnapshotEntry *entry = &next[nextCount++];
+  *entry = *old;
+  entry->change = SNAPSHOT_UNCHANGED;
+  stats.flights[SNAPSHOT_UNCHANGED]++;
+  return true;
+}
+
+void Snapshot_Stage(const FlightRecord &flight, FieldMask fields) {
+  SnapshotEntry *entry = next ? FindNext(flight) : nullptr;
+  if (!entry)
+    return;
+  uint32_t hash[FIELD_COUNT];
+  fields &= HashFlight(flight, hash);
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (fields & FIELD_BIT(id))
+      staged[entry - next][id] = hash[id];
+  }
+}
+
+void Snapshot_Commit(const FlightRecord &flight, FieldMask written) {
+  SnapshotEntry *entry = next ? FindNext(flight) : nullptr;
+  if (!entry)
+    return;
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (written & FIELD_BIT(id))
+      entry->hash[id] = staged[entry - next][id];
+  }
+  entry->written |= written;
+}
+
+// Write aside and rename over the old file, which LittleFS replaces
+// atomically: a reset mid-write leaves the old snapshot in place
+static bool Snapshot_WriteFile(const SnapshotHeader &header,
+                               const SnapshotEntry *entries, size_t bytes) {
+  File file = LittleFS.open(SNAPSHOT_TEMP_PATH, "w");
+  if (!file) {
+    Serial.println("❌ Snapshot: cannot open file for writing");
+    return false;
+  }
+  bool ok = file.write((const uint8_t *)&header, sizeof(header)) ==
+                sizeof(header) &&
+            file.write((const uint8_t *)entries, bytes) == bytes;
+  file.close();
+  ok = ok && LittleFS.rename(SNAPSHOT_TEMP_PATH, SNAPSHOT_PATH);
+  if (!ok)
+    LittleFS.remove(SNAPSHOT_TEMP_PATH);
+  return ok;
+}
+
+bool Snapshot_Save() {
+  if (!next)
+    return false;
+
+  // Sorted so the next boot can binary search it
+  qsort(next, nextCount, sizeof(SnapshotEntry), CompareEntries);
+
+  // This cycle's snapshot is the baseline for the next one, whether or not
+  // the file is written: the uploads it records are already in the RTDB
+  SnapshotEntry *swap = previous;
+  previous = next;
+  next = swap;
+  previousCount = nextCount;
+  nextCount = 0;
+  stats.stored = previousCount;
+
+  SnapshotHeader header = {};
+  header.magic = SNAPSHOT_MAGIC;
+  header.version = SNAPSHOT_VERSION;
+  header.fieldCount = FIELD_COUNT;
+  header.count = previousCount;
+  header.cyclesToFullSync = cyclesToFullSync;
+  size_t bytes = previousCount * sizeof(SnapshotEntry);
+  header.checksum = HashBytes(2166136261u, previous, bytes);
+
+  for (int attempt = 1; attempt <= SNAPSHOT_WRITE_ATTEMPTS; attempt++) {
+    if (Snapshot_WriteFile(header, previous, bytes)) {
+      Serial.printf("📸 Snapshot saved: %u flights (%u bytes)\n",
+                    previousCount, (unsigned)(sizeof(header) + bytes));
+      return true;
+    }
+  }
+  // Written again after the next cycle; a restart before that sends the
+  // flights changed since the file on LittleFS once more
+  Serial.println("❌ Snapshot: write failed, file is one cycle behind");
+  return false;
+}
+
+SnapshotStats Snapshot_GetStats() { return stats; }
+
+void Snapshot_PrintStats() {
+  Serial.printf("📸 Delta: %u new, %u changed (%u fields), %u unchanged%s\n",
+                stats.flights[SNAPSHOT_NEW], stats.flights[SNAPSHOT_CHANGED],
+                stats.fieldsChanged, stats.flights[SNAPSHOT_UNCHANGED],
+                stats.fullSync ? " - full sync" : "");
+}
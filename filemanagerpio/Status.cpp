@@ -0,0 +1,103 @@
+#include "Global.h"
+
+// ============ STATUS ============
+// The web UI used to poll /api/esp32status every 10 s for two Strings the
+// sync overwrote on every page. The status now lives in fixed buffers and
+// every change is handed to a listener - the SSE endpoint in MyServer.cpp -
+// as soon as it happens, so the UI sees each page and chunk without asking.
+//
+// The scraper task, the loop task and the watchdog all set it. The lock only
+// covers the copy: the listener is called after it is released, so a
+// listener that takes locks of its own (the SSE clients') cannot deadlock
+// with a reader of the status. Events of two tasks may then arrive out of
+// order; each status carries its seq and the UI drops older ones.
+
+static SemaphoreHandle_t statusLock = nullptr;
+static StatusInfo current = {"🚀", "System starting...", 0, 0};
+static StatusListener listener = nullptr;
+
+static void Status_Lock() {
+  if (statusLock)
+    xSemaphoreTakeRecursive(statusLock, portMAX_DELAY);
+}
+
+static void Status_Unlock() {
+  if (statusLock)
+    xSemaphoreGiveRecursive(statusLock);
+}
+
+// JSON string body; messages are our own text and config names
+static size_t Escape(const char *text, char *dst, size_t size) {
+  size_t used = 0;
+  for (; *text && used + 2 < size; text++) {
+    if (*text == '"' || *text == '\\')
+      dst[used++] = '\\';
+    dst[used++] = (uint8_t)*text < 0x20 ? ' ' : *text;
+  }
+  dst[used] = '\0';
+  return used;
+}
+
+void Status_Init() {
+  if (!statusLock)
+    statusLock = xSemaphoreCreateRecursiveMutex();
+}
+
+void Status_SetListener(StatusListener newListener) {
+  Status_Lock();
+  listener = newListener;
+  Status_Unlock();
+}
+
+void Status_Set(const char *icon, const char *message) {
+  Status_Lock();
+  if (strcmp(current.icon, icon) == 0 &&
+      strncmp(current.message, message, STATUS_MESSAGE_MAX - 1) == 0) {
+    Status_Unlock();
+    return;
+  }
+  snprintf(current.icon, sizeof(current.icon), "%s", icon);
+  snprintf(current.message, sizeof(current.message), "%s", message);
+  current.seq++;
+  current.changedMs = millis();
+  StatusInfo changed = current;
+  StatusListener notify = listener;
+  Status_Unlock();
+
+  if (notify) {
+    char json[STATUS_EVENT_MAX];
+    Status_FormatJson(changed, json, sizeof(json));
+    notify("status", json, changed.seq);
+  }
+}
+
+void Status_Progress(const char *stage, int done, int total) {
+  Status_Lock();
+  StatusListener notify = listener;
+  Status_Unlock();
+
+  if (notify) {
+    char json[STATUS_EVENT_MAX];
+    snprintf(json, sizeof(json), "{\"stage\":\"%s\",\"done\":%d,\"total\":%d}",
+             stage, done, total);
+    notify("progress", json, 0); // ids belong to status changes
+  }
+}
+
+StatusInfo Status_Get() {
+  Status_Lock();
+  StatusInfo copy = current;
+  Status_Unlock();
+  return copy;
+}
+
+// {"icon":"📥","message":"...","seq":12,"uptime":345}
+int Status_FormatJson(const StatusInfo &status, char *dst, size_t size) {
+  char message[STATUS_MESSAGE_MAX * 2];
+  Escape(status.message, message, sizeof(message));
+  return snprintf(dst, size,
+                  "{\"icon\":\"%s\",\"message\":\"%s\",\"seq\":%lu,"
+                  "\"uptime\":%lu}",
+                  status.icon, message, (unsigned long)status.seq,
+                  (unsigned long)(status.changedMs / 1000));
+}
@@ -0,0 +1,290 @@
+#include "Global.h"
+
+// ============ SYNC PIPELINE ============
+// One cycle runs as two tasks connected by the flight queue:
+//
+//   scraper task (core 0)   fetch + parse pages, paced by Pacing.cpp; after
+//                           each page the flights it changed are queued
+//   loop task (core 1)      diff each queued flight against the snapshot,
+//                           batch it, and send the chunk when the queue runs
+//                           dry - i.e. while the scraper waits for its next
+//                           page
+//
+// Upload time hides behind the page pacing, so a cycle takes about as long
+// as the longer of fetching and uploading instead of both. Departures are
+// held until the check-in pages are parsed, because check-in rows overwrite
+// departure fields (cro1, crow, ckco, ...); sending them per page would
+// write every such field twice a cycle, the first time with a stale value.
+// A flight changed again later anyway (a row repeated across pages) is
+// queued again and only its new fields are sent. Pages that did not change
+// since the last cycle are not parsed at all (PageCache.cpp).
+//
+// While the scraper runs it is the only task that sets the status; the
+// uploader only reports progress.
+
+struct SyncCounts {
+  int queued;   // records popped, a flight may come more than once
+  int uploaded; // flights in successful writes
+  int buffered; // flights written to the write-ahead log
+  int chunks;   // upload requests
+};
+
+static SyncCounts counts = {};
+static int16_t pageFlights[FLIGHT_STORE_CAPACITY]; // scraper task only
+static bool holdPages = false; // scraper: departures not final yet
+static bool batching = true;
+
+// ============ SCRAPER TASK ============
+static void Sync_FetchAll() {
+  holdPages = true;
+  Pacing_PlanCycle();
+  Status_Set("📥", "Fetching departure flights...");
+  Serial.println("\n⚡ FETCHING DEPARTURE FLIGHTS (INT)");
+  Fetch("configs/FREE/departure_int.cfg", "Departure", "INT");
+
+  Serial.println("\n⚡ FETCHING DEPARTURE FLIGHTS (DOM)");
+  Fetch("configs/FREE/departure_dom.cfg", "Departure", "DOM");
+
+  Serial.println("\n⚡ FETCHING CHECKIN DATA");
+  Fetch("configs/FREE/checkin.cfg", "CheckIn", "");
+
+  // Departures are complete: upload them while arrivals are fetched
+  holdPages = false;
+  Sync_PageParsed();
+
+  Status_Set("📥", "Fetching arrival flights...");
+  Serial.println("\n⚡ FETCHING ARRIVAL FLIGHTS (INT)");
+  Fetch("configs/FREE/arrival_int.cfg", "Arrival", "INT");
+
+  Serial.println("\n⚡ FETCHING ARRIVAL FLIGHTS (DOM)");
+  Fetch("configs/FREE/arrival_dom.cfg", "Arrival", "DOM");
+}
+
+static void Sync_ScraperTask(void *parameters) {
+  (void)parameters;
+  Serial.printf("🕷️ Scraper task running on core %d\n", xPortGetCoreID());
+  Sync_FetchAll();
+  FlightQueue_Close();
+  vTaskDelete(NULL);
+}
+
+void Sync_PageParsed() {
+  Health_Feed();
+  if (holdPages)
+    return; // changes stay marked in the store until released
+  FlightStore_Lock();
+  int count = FlightStore_TakeDirty(pageFlights, FLIGHT_STORE_CAPACITY);
+  FlightStore_Unlock();
+  for (int i = 0; i < count; i++)
+    FlightQueue_Push(pageFlights[i]);
+  FlightQueue_Publish();
+  TRACE(TRACE_QUEUED, count, 0);
+}
+
+// ============ UPLOADER ============
+static void Sync_FlushChunk() {
+  counts.chunks++;
+  Status_Progress("upload", counts.chunks, counts.queued);
+  LOG_DEBUG("📤 Uploading chunk %d (%d flights queued so far)\n",
+            counts.chunks, counts.queued);
+  if (!Batch_Flush())
+    LOG_ERROR("❌ Failed to upload chunk %d\n", counts.chunks);
+}
+
+// Larger than the whole batch buffer, or batching off: individual
+// field-level update.
+// Called with the store locked; unlocks it.
+static void Sync_UploadAlone(int rec, FieldMask changed) {
+  const FlightRecord *flight = FlightStore_Get(rec);
+  char flightKey[FLIGHT_KEY_TEXT_MAX];
+  FlightKey_Format(flight->key, flightKey, sizeof(flightKey));
+  const char *categoryName = FLIGHT_CATEGORY_NAMES[flight->category];
+  LOG_DEBUG("Updating %s on its own\n", flightKey);
+  DynamicJsonDocument *filteredFlightDoc =
+      CreateFilteredFlightDoc(*flight, changed);
+  if (filteredFlightDoc->overflowed()) {
+    // Some fields did not fit; nothing is sent or marked as written
+    LOG_ERROR("❌ %s does not fit %u bytes of JSON, logged instead\n",
+              flightKey, (unsigned)filteredFlightDoc->capacity());
+    delete filteredFlightDoc;
+    Wal_Append(*flight, changed);
+    FlightStore_Unlock();
+    return;
+  }
+  Snapshot_Stage(*flight, changed);
+  FlightStore_Unlock();
+
+  bool ok = UpdateFlight(categoryName, flightKey, *filteredFlightDoc);
+  delete filteredFlightDoc;
+
+  FlightStore_Lock();
+  if (ok) {
+    Snapshot_Commit(*flight, changed);
+    counts.uploaded++;
+  } else {
+    LOG_ERROR("❌ Failed to update %s\n", flightKey);
+    Wal_Append(*flight, changed);
+  }
+  FlightStore_Unlock();
+}
+
+// Sends the fields of one queued flight that differ from what the RTDB last
+// got, or logs them while Firebase is offline
+static void Sync_UploadFlight(int rec, bool online) {
+  Batch_Settle(rec);
+
+  FlightStore_Lock();
+  const FlightRecord *flight = FlightStore_Get(rec);
+  FieldMask changed;
+  Snapshot_Diff(*flight, changed);
+  if (!changed) {
+    FlightStore_Unlock();
+    return;
+  }
+
+  // Not committed to the snapshot: the next cycle still sees the change
+  if (!online) {
+    Wal_Append(*flight, changed);
+    FlightStore_Unlock();
+    counts.buffered++;
+    return;
+  }
+
+  if (!batching) {
+    Sync_UploadAlone(rec, changed);
+    return;
+  }
+
+  bool added = Batch_Add(rec, changed);
+  FlightStore_Unlock();
+  if (added)
+    return;
+
+  // Chunk is full: send it, then start the next one with this flight
+  Sync_FlushChunk();
+  FlightStore_Lock();
+  if (Batch_Add(rec, changed))
+    FlightStore_Unlock();
+  else
+    Sync_UploadAlone(rec, changed);
+}
+
+static void Sync_RunUploader() {
+  // Firebase gets up to 30 s to come up; the scraper is fetching meanwhile
+  unsigned long fbWaitStart = millis();
+  while (!Firebase_IsReady() && (millis() - fbWaitStart < 30000)) {
+    app.loop();
+    delay(10);
+  }
+  bool online = Firebase_IsReady();
+  if (online && Wal_HasPending())
+    Wal_Replay(); // older than anything scraped now, so it goes first
+  if (!online)
+    Serial.println("⚠️ Firebase not ready after 30s, logging changes");
+
+  for (;;) {
+    int16_t rec;
+    if (FlightQueue_Pop(rec)) {
+      counts.queued++;
+      Health_Feed();
+      if (!online && Firebase_IsReady()) {
+        Serial.println("✅ Firebase is back, replaying logged changes");
+        online = true;
+        Wal_Replay();
+      }
+      Sync_UploadFlight(rec, online);
+      continue;
+    }
+
+    // Queue is empty: send the page's chunk while the next page is fetched,
+    // and keep collecting results instead of sleeping on them
+    if (Batch_Pending())
+      Sync_FlushChunk();
+    if (Firebase_WritesInFlight()) {
+      Batch_Poll();
+      delay(10);
+      continue;
+    }
+    if (!FlightQueue_Wait())
+      break; // scraper finished and everything is handed over
+  }
+  counts.uploaded += Batch_Drain();
+}
+
+void Sync_SetBatching(bool enabled) { batching = enabled; }
+
+// ============ ONE FULL SYNC CYCLE ============
+// Fetch departures, check-in and arrivals while uploading them, then stamp
+// the sync time. Shared by loop() on the device and the host harness.
+// Fails when nothing was scraped or some update went to the write-ahead log.
+bool Sync_RunCycle() {
+  // Departures and arrivals share the store for the whole cycle; it is only
+  // reset here
+  FlightStore_Clear();
+  Snapshot_BeginCycle();
+  // A full sync sends every field, so every page has to be parsed
+  PageCache_BeginCycle(!Snapshot_GetStats().fullSync);
+  TRACE(TRACE_CYCLE_BEGIN, Snapshot_GetStats().fullSync, 0);
+  counts = {};
+  unsigned long cycleStart = millis();
+  uint32_t walAppended = Wal_GetStats().appended;
+
+  Status_Set("🔄", "Starting data sync...");
+
+  Serial.printf("\nMemory before sync - Free: %d, PSRAM: %d\n",
+                ESP.getFreeHeap(), ESP.getFreePsram());
+
+  FlightQueue_Begin();
+  if (xTaskCreatePinnedToCore(Sync_ScraperTask, "scraper", SYNC_SCRAPER_STACK,
+                              nullptr, SYNC_SCRAPER_PRIORITY, nullptr,
+                              SYNC_SCRAPER_CORE) != pdPASS) {
+    Serial.println("❌ Cannot start the scraper task, skipping this cycle");
+    Status_Set("❌", "ERROR: scraper task failed");
+    return false;
+  }
+  Serial.printf("📤 Uploader running on core %d\n", xPortGetCoreID());
+  Sync_RunUploader();
+
+  FlightStore_PrintStats();
+  SnapshotStats delta = Snapshot_GetStats();
+  PageCacheStats pages = PageCache_GetStats();
+  if (counts.buffered) {
+    Serial.printf("\n📒 Firebase offline, %d flights kept in the write-ahead "
+                  "log\n",
+                  counts.buffered);
+  }
+  Serial.printf("\n✅ Upload complete: %d flights uploaded in %d request(s), "
+                "%d unchanged, %lu ms\n",
+                counts.uploaded, counts.chunks,
+                delta.flights[SNAPSHOT_UNCHANGED], millis() - cycleStart);
+  Serial.printf("♻️ Pages: %u unchanged (%u rows carried over, %lu bytes "
+                "not parsed), %u changed, %u parsed for overlapping flights%s\n",
+                pages.hits, pages.carried, (unsigned long)pages.skippedBytes,
+                pages.misses, pages.forced,
+                pages.enabled ? "" : " - page cache off this cycle");
+
+  // Persist what was written so the next boot only sends changes
+  Snapshot_PrintStats();
+  Snapshot_Save();
+  // Skipped pages next cycle rely on every flight being written as hashed;
+  // they are checked against the baseline in RAM, not the file
+  bool clean = Wal_GetStats().appended == walAppended;
+  PageCache_EndCycle(clean);
+
+  Status_Set("📅", "Updating timestamp...");
+  // Update last sync timestamp in Firebase
+  Serial.println("\n📅 Updating sync timestamp...");
+  Firebase_UpdateLastSyncTime();
+
+  Serial.println("\n✅ Sync cycle complete (success or failure)\n");
+  // Flights on unchanged pages are not in the store, only in the snapshot
+  int scraped = delta.flights[SNAPSHOT_NEW] + delta.flights[SNAPSHOT_CHANGED] +
+                delta.flights[SNAPSHOT_UNCHANGED];
+  bool ok = (scraped > 0 || FlightStore_Count() > 0) && clean;
+  Metrics_Add(METRIC_FLIGHTS_UPLOADED, counts.uploaded);
+  Metrics_Add(METRIC_FLIGHTS_SKIPPED, delta.flights[SNAPSHOT_UNCHANGED]);
+  Metrics_Add(METRIC_FLIGHTS_FAILED, Wal_GetStats().appended - walAppended);
+  Metrics_Observe(METRIC_CYCLE, millis() - cycleStart);
+  TRACE(TRACE_CYCLE_END, millis() - cycleStart, ok);
+  return ok;
+}
@@ -0,0 +1,61 @@
+#include "Global.h"
+
+// ============ TRACE RING ============
+// Fixed-size records in a PSRAM ring; the newest TRACE_RING_SIZE survive.
+// Both cores record: a slot is claimed with an atomic increment, so a dump
+// taken while a record is being written may show that one record half
+// filled. Nothing is formatted until /api/trace asks for it.
+
+const char *TRACE_EVENT_NAMES[TRACE_EVENT_COUNT] = {
+    "cycle_begin", "cycle_end",   "page",         "page_failed",
+    "page_cut",    "page_skip",   "queued",       "batch_sent",
+    "batch_done",  "write_sent",  "write_ok",     "write_error",
+    "write_timeout", "wal_append",
+};
+
+static TraceRecord *ring = nullptr;
+static uint32_t head = 0; // records written since boot
+
+bool Trace_Init() {
+  if (ring)
+    return true;
+  ring = (TraceRecord *)ps_calloc(TRACE_RING_SIZE, sizeof(TraceRecord));
+  if (!ring) {
+    LOG_ERROR("❌ Trace: cannot allocate the ring\n");
+    return false;
+  }
+  return true;
+}
+
+void Trace_Record(TraceEvent event, int32_t a, int32_t b) {
+  if (!ring)
+    return;
+  uint32_t slot = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+  TraceRecord &record = ring[slot & (TRACE_RING_SIZE - 1)];
+  record.ms = millis();
+  record.event = event;
+  record.core = xPortGetCoreID();
+  record.a = a;
+  record.b = b;
+}
+
+size_t Trace_Snapshot(TraceRecord *out, size_t max, uint32_t &total) {
+  total = __atomic_load_n(&head, __ATOMIC_RELAXED);
+  if (!ring)
+    return 0;
+  size_t count = total < TRACE_RING_SIZE ? total : TRACE_RING_SIZE;
+  if (count > max)
+    count = max;
+  for (size_t i = 0; i < count; i++)
+    out[i] = ring[(total - count + i) & (TRACE_RING_SIZE - 1)];
+  return count;
+}
+
+// "<ms> <core> <event> <a> <b>\n"
+int Trace_Format(const TraceRecord &record, char *dst, size_t size) {
+  const char *name = record.event < TRACE_EVENT_COUNT
+                         ? TRACE_EVENT_NAMES[record.event]
+                         : "?";
+  return snprintf(dst, size, "%lu %u %s %ld %ld\n", (unsigned long)record.ms,
+                  record.core, name, (long)record.a, (long)record.b);
+}
@@ -0,0 +1,450 @@
+#include "Global.h"
+
+// ============ WRITE-AHEAD LOG ============
+// Field-level updates that could not be written to the RTDB (Firebase not
+// ready, or a chunk that failed after its retries) are appended to
+// /wal.log and sent on the next cycle that has a working uplink, also after
+// a restart. Each record is framed with its length and a CRC-32:
+//
+//   header   magic 'WFSW', version, fieldCount
+//   record   magic, length, crc32 | key, seq, category, field, value JSON
+//
+// A torn or corrupt record ends the log; everything before it is kept.
+// Replay and compaction keep only the newest record (highest seq) per
+// flight and field. Appends that would grow the file past WAL_MAX_BYTES
+// compact it first and then evict the oldest records down to
+// WAL_COMPACT_TARGET, so the log cannot fill the partition. When that
+// rewrite fails the update is refused instead; its flight is not marked as
+// written, so the next cycle diffs and sends it again.
+//
+// Compaction writes the new log aside and renames it over the live one,
+// which LittleFS does atomically: a reset mid-way leaves either log whole.
+//
+// A log from an earlier boot that could not be indexed (no memory) or whose
+// torn tail could not be cut off is "unindexed": it is never truncated and
+// nothing is appended behind it, where a scan would not find it. Appends
+// are refused, like a failed compaction's, and an append tries again at
+// most every WAL_REOPEN_MS.
+
+#define WAL_MAGIC 0x57534657UL // "WFSW"
+#define WAL_VERSION 1
+#define WAL_RECORD_MAGIC 0xA55A
+
+struct WalHeader {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t fieldCount; // field ids change with MANAGED_FIELD_LIST
+  uint16_t reserved;
+};
+
+struct WalFrame {
+  uint16_t magic;
+  uint16_t length; // WalEntry + value
+  uint32_t crc;    // CRC-32 of WalEntry + value
+};
+
+struct WalEntry {
+  FlightKey key;
+  uint32_t seq;
+  uint8_t category; // FlightCategory
+  uint8_t field;    // FieldId
+  uint16_t valueLength;
+};
+
+// One record found by WalScan()
+struct WalIndex {
+  FlightKey key;
+  uint32_t seq;
+  uint32_t offset; // of the WalFrame
+  uint16_t length; // WalEntry + value
+  uint8_t category;
+  uint8_t field;
+};
+
+static uint32_t fileBytes = 0; // valid bytes in WAL_PATH, 0 = no log
+static bool unindexed = false; // WAL_PATH holds records not in fileBytes
+static unsigned long reopenMs = 0; // last WalOpenExisting() that failed
+static uint32_t nextSeq = 1;
+static WalStats stats = {};
+static char value[sizeof(WalEntry) + WAL_VALUE_MAX];  // record being read
+static char record[sizeof(WalEntry) + WAL_VALUE_MAX]; // record being appended
+
+// ============ CRC-32 (IEEE 802.3, reflected) ============
+static uint32_t Crc32(uint32_t crc, const void *data, size_t len) {
+  static const uint32_t nibble[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+      0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  const uint8_t *bytes = (const uint8_t *)data;
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= bytes[i];
+    crc = (crc >> 4) ^ nibble[crc & 15];
+    crc = (crc >> 4) ^ nibble[crc & 15];
+  }
+  return ~crc;
+}
+
+static bool WriteHeader(File &file) {
+  WalHeader header = {WAL_MAGIC, WAL_VERSION, FIELD_COUNT, 0};
+  return file.write((const uint8_t *)&header, sizeof(header)) ==
+         sizeof(header);
+}
+
+// Reads the record at the current position into `value`; false at the end
+// of the log or at the first record that does not check out
+static bool ReadRecord(File &file, WalFrame &frame) {
+  if (file.read((uint8_t *)&frame, sizeof(frame)) != sizeof(frame) ||
+      frame.magic != WAL_RECORD_MAGIC || frame.length < sizeof(WalEntry) ||
+      frame.length > sizeof(value))
+    return false;
+  if (file.read((uint8_t *)value, frame.length) != frame.length ||
+      Crc32(0, value, frame.length) != frame.crc)
+    return false;
+  const WalEntry *entry = (const WalEntry *)value;
+  return sizeof(WalEntry) + entry->valueLength == frame.length &&
+         entry->field < FIELD_COUNT && entry->category < CATEGORY_COUNT;
+}
+
+// Indexes every valid record. Returns the count, or -1 when the file is
+// missing or from another layout; `valid` is the length of the good prefix.
+static int WalScan(WalIndex *index, int capacity, uint32_t &valid) {
+  valid = 0;
+  File file = LittleFS.open(WAL_PATH, "r");
+  if (!file)
+    return -1;
+  WalHeader header;
+  if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != WAL_MAGIC || header.version != WAL_VERSION ||
+      header.fieldCount != FIELD_COUNT) {
+    file.close();
+    return -1;
+  }
+
+  int count = 0;
+  uint32_t offset = sizeof(header);
+  WalFrame frame;
+  while (count < capacity && ReadRecord(file, frame)) {
+    const WalEntry *entry = (const WalEntry *)value;
+    WalIndex &item = index[count++];
+    item.key = entry->key;
+    item.seq = entry->seq;
+    item.offset = offset;
+    item.length = frame.length;
+    item.category = entry->category;
+    item.field = entry->field;
+    offset += sizeof(frame) + frame.length;
+  }
+  file.close();
+  valid = offset;
+  return count;
+}
+
+static int CompareTarget(const void *a, const void *b) {
+  const WalIndex *x = (const WalIndex *)a;
+  const WalIndex *y = (const WalIndex *)b;
+  if (x->category != y->category)
+    return x->category < y->category ? -1 : 1;
+  if (x->key != y->key)
+    return x->key < y->key ? -1 : 1;
+  if (x->field != y->field)
+    return x->field < y->field ? -1 : 1;
+  return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+static int CompareSeq(const void *a, const void *b) {
+  const WalIndex *x = (const WalIndex *)a;
+  const WalIndex *y = (const WalIndex *)b;
+  return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+// Loads the index with only the newest record per flight and field, oldest
+// first. Returns nullptr when there is nothing to keep, with count -1 when
+// the log could not be read and has to stay as it is.
+static WalIndex *WalLoadLatest(int &count) {
+  count = 0;
+  if (fileBytes == 0)
+    return nullptr;
+  int capacity = fileBytes / (sizeof(WalFrame) + sizeof(WalEntry)) + 1;
+  WalIndex *index = (WalIndex *)ps_malloc(capacity * sizeof(WalIndex));
+  if (!index) {
+    Serial.println("❌ WAL: cannot allocate index");
+    count = -1;
+    return nullptr;
+  }
+  uint32_t valid;
+  int found = WalScan(index, capacity, valid);
+  if (found <= 0) {
+    free(index);
+    return nullptr;
+  }
+
+  qsort(index, found, sizeof(WalIndex), CompareTarget);
+  for (int i = 0; i < found; i++) {
+    bool superseded = i + 1 < found &&
+                      index[i + 1].category == index[i].category &&
+                      index[i + 1].key == index[i].key &&
+                      index[i + 1].field == index[i].field;
+    if (!superseded)
+      index[count++] = index[i];
+  }
+  qsort(index, count, sizeof(WalIndex), CompareSeq);
+  return index;
+}
+
+// Rewrites the log with the newest record per flight and field, dropping the
+// oldest ones until it fits in `limit` bytes
+static bool WalCompact(uint32_t limit) {
+  int count;
+  WalIndex *index = WalLoadLatest(count);
+  if (count < 0)
+    return false;
+
+  uint32_t total = sizeof(WalHeader);
+  for (int i = 0; i < count; i++)
+    total += sizeof(WalFrame) + index[i].length;
+  int first = 0;
+  while (first < count && total > limit) {
+    total -= sizeof(WalFrame) + index[first].length;
+    first++;
+  }
+  if (first > 0) {
+    stats.evicted += first;
+    Serial.printf("⚠️ WAL full, evicted %d oldest updates\n", first);
+  }
+
+  bool ok = true;
+  if (first < count) {
+    File source = LittleFS.open(WAL_PATH, "r");
+    File target = LittleFS.open(WAL_TEMP_PATH, "w");
+    ok = source && target && WriteHeader(target);
+    for (int i = first; ok && i < count; i++) {
+      WalFrame frame;
+      ok = source.seek(index[i].offset) && ReadRecord(source, frame) &&
+           target.write((const uint8_t *)&frame, sizeof(frame)) ==
+               sizeof(frame) &&
+           target.write((const uint8_t *)value, frame.length) == frame.length;
+    }
+    source.close();
+    target.close();
+    ok = ok && LittleFS.rename(WAL_TEMP_PATH, WAL_PATH);
+    if (!ok)
+      LittleFS.remove(WAL_TEMP_PATH);
+  } else {
+    LittleFS.remove(WAL_PATH);
+    total = 0;
+  }
+  free(index);
+
+  if (!ok) {
+    Serial.println("❌ WAL: compaction failed, keeping the log as it is");
+    return false;
+  }
+  fileBytes = total;
+  stats.records = first < count ? count - first : 0;
+  unindexed = false; // what is on LittleFS is what was just written
+  return true;
+}
+
+// Indexes the log left by an earlier boot and cuts a torn tail off. False
+// leaves it unindexed; a later append tries again.
+static bool WalOpenExisting() {
+  reopenMs = millis();
+  File file = LittleFS.open(WAL_PATH, "r");
+  if (!file) {
+    fileBytes = 0;
+    unindexed = false;
+    return true;
+  }
+  uint32_t size = file.size();
+  file.close();
+  int capacity = size / (sizeof(WalFrame) + sizeof(WalEntry)) + 1;
+  WalIndex *index = (WalIndex *)ps_malloc(capacity * sizeof(WalIndex));
+  if (!index) {
+    Serial.println("❌ WAL: cannot allocate index, log kept, appends refused");
+    fileBytes = size; // replay tries again
+    unindexed = true;
+    return false;
+  }
+
+  uint32_t valid;
+  int count = WalScan(index, capacity, valid);
+  for (int i = 0; i < count; i++)
+    nextSeq = max(nextSeq, index[i].seq + 1);
+  free(index);
+
+  if (count <= 0) {
+    if (count < 0)
+      Serial.println("⚠️ Write-ahead log unreadable, discarding it");
+    LittleFS.remove(WAL_PATH);
+    fileBytes = 0;
+    unindexed = false;
+    return true;
+  }
+
+  fileBytes = valid;
+  stats.records = count;
+  unindexed = false;
+  if (size > valid) {
+    // Torn append at power loss: keep the good prefix, so new records are
+    // not written behind garbage
+    Serial.printf("⚠️ WAL: dropping %u corrupt bytes at the end\n",
+                  (unsigned)(size - valid));
+    if (!WalCompact(WAL_MAX_BYTES)) {
+      Serial.println("❌ WAL: corrupt tail not removed, appends refused");
+      unindexed = true;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Wal_Init() {
+  if (!LittleFS.exists(WAL_PATH)) {
+    Serial.println("📒 No write-ahead log");
+    return true;
+  }
+  WalOpenExisting();
+  if (fileBytes) {
+    Serial.printf("📒 Write-ahead log: %u updates pending (%u bytes)%s\n",
+                  (unsigned)stats.records, (unsigned)fileBytes,
+                  unindexed ? ", not indexed" : "");
+  }
+  return true;
+}
+
+bool Wal_Append(const FlightRecord &flight, FieldMask fields) {
+  // Only a log that does not exist is created (and truncated) with "w"
+  bool reopen = unindexed ? millis() - reopenMs >= WAL_REOPEN_MS
+                          : fileBytes == 0 && LittleFS.exists(WAL_PATH);
+  if ((reopen && !WalOpenExisting()) || unindexed) {
+    for (int id = 0; id < FIELD_COUNT; id++) {
+      if (fields & FIELD_BIT(id))
+        stats.evicted++;
+    }
+    return false;
+  }
+
+  File file;
+  int appended = 0;
+  for (int id = 0; id < FIELD_COUNT; id++) {
+    if (!(fields & FIELD_BIT(id)))
+      continue;
+    int length = Batch_FormatValue(flight, id, record + sizeof(WalEntry),
+                                   WAL_VALUE_MAX);
+    if (length < 0)
+      continue; // empty, or larger than a record may be
+
+    WalEntry entry = {flight.key, nextSeq++, flight.category, (uint8_t)id,
+                      (uint16_t)length};
+    memcpy(record, &entry, sizeof(entry));
+    WalFrame frame;
+    frame.magic = WAL_RECORD_MAGIC;
+    frame.length = sizeof(entry) + length;
+    frame.crc = Crc32(0, record, frame.length);
+    uint32_t recordBytes = sizeof(frame) + frame.length;
+
+    if (fileBytes + recordBytes > WAL_MAX_BYTES) {
+      if (file)
+        file.close();
+      if (!WalCompact(WAL_COMPACT_TARGET) ||
+          fileBytes + recordBytes > WAL_MAX_BYTES) {
+        stats.evicted++;
+        Serial.printf("❌ WAL full and cannot be compacted, %s not logged\n",
+                      FIELD_NAMES[id]);
+        stats.appended += appended;
+        return false;
+      }
+    }
+
+    if (!file) {
+      bool fresh = fileBytes == 0;
+      file = LittleFS.open(WAL_PATH, fresh ? "w" : "a");
+      if (!file || (fresh && !WriteHeader(file))) {
+        Serial.println("❌ WAL: cannot open log for writing");
+        return false;
+      }
+      if (fresh)
+        fileBytes = sizeof(WalHeader);
+    }
+    if (file.write((const uint8_t *)&frame, sizeof(frame)) != sizeof(frame) ||
+        file.write((const uint8_t *)record, frame.length) != frame.length) {
+      Serial.println("❌ WAL: write failed");
+      file.close();
+      return false;
+    }
+    fileBytes += recordBytes;
+    stats.records++;
+    appended++;
+  }
+  if (file)
+    file.close();
+  stats.appended += appended;
+  TRACE(TRACE_WAL_APPEND, flight.category, appended);
+  return true;
+}
+
+bool Wal_HasPending() { return fileBytes > 0; }
+
+int Wal_Replay() {
+  int count;
+  WalIndex *index = WalLoadLatest(count);
+  if (count < 0)
+    return 0; // kept for the next cycle
+  if (!index) {
+    LittleFS.remove(WAL_PATH);
+    fileBytes = 0;
+    unindexed = false;
+    stats.records = 0;
+    return 0;
+  }
+
+  Serial.printf("\n📒 Replaying %d buffered updates from the write-ahead log\n",
+                count);
+  File file = LittleFS.open(WAL_PATH, "r");
+  int sent = 0;
+  for (int i = 0; file && i < count; i++) {
+    WalFrame frame;
+    if (!file.seek(index[i].offset) || !ReadRecord(file, frame))
+      break;
+    const WalEntry *entry = (const WalEntry *)value;
+    char flightKey[FLIGHT_KEY_TEXT_MAX];
+    FlightKey_Format(entry->key, flightKey, sizeof(flightKey));
+    char path[64];
+    snprintf(path, sizeof(path), "%s/%s/%s",
+             FLIGHT_CATEGORY_NAMES[entry->category], flightKey,
+             FIELD_NAMES[entry->field]);
+
+    const char *json = value + sizeof(WalEntry);
+    if (!Batch_AddPath(path, json, entry->valueLength)) {
+      Batch_Flush();
+      if (!Batch_AddPath(path, json, entry->valueLength))
+        continue;
+    }
+    sent++;
+  }
+  file.close();
+  free(index);
+  if (Batch_Pending())
+    Batch_Flush();
+  Batch_Drain();
+
+  if (sent < count || Batch_FailedChunks() > 0) {
+    // Keep it, smaller, for the next cycle
+    Serial.println("⚠️ WAL replay incomplete, keeping the log");
+    WalCompact(WAL_MAX_BYTES);
+    return 0;
+  }
+  LittleFS.remove(WAL_PATH);
+  fileBytes = 0;
+  unindexed = false;
+  stats.records = 0;
+  stats.replayed += sent;
+  Serial.printf("✅ Write-ahead log replayed: %d updates\n", sent);
+  return sent;
+}
+
+WalStats Wal_GetStats() {
+  stats.bytes = fileBytes;
+  return stats;
+}
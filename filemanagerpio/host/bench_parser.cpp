@@ -0,0 +1,329 @@
+// Host benchmark: WebDavis row parser
+// Replays the recorded corpus through Fetch() -> postRequest() ->
+// RowTokenizer -> ExtractCellField() -> CommitRowFields() and
+// reports parse cost per page against the page pacing interval, then
+// times the per-cell Field:/Value: extractor on the recorded rows against the
+// original indexOf()/substring() scan it replaced.
+//
+//   wfs_bench [-p corpus_dir] [-i iterations]
+//
+// Timings are wall clock on the host; allocation counts and store usage are
+// deterministic for a given corpus and are the numbers to diff.
+
+#include "Global.h"
+#include "HostHeap.h"
+#include "HostTransport.h"
+#include "replay.h"
+
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct BenchConfig {
+  const char *name;
+  const char *config;
+  const char *category;
+  const char *subCategory;
+  bool startsCycle; // the flight store is cleared before this config
+};
+
+static const BenchConfig CONFIGS[] = {
+    {"departure_int", "configs/FREE/departure_int.cfg", "Departure", "INT", true},
+    {"departure_dom", "configs/FREE/departure_dom.cfg", "Departure", "DOM", false},
+    {"checkin", "configs/FREE/checkin.cfg", "CheckIn", "", false},
+    {"arrival_int", "configs/FREE/arrival_int.cfg", "Arrival", "INT", false},
+    {"arrival_dom", "configs/FREE/arrival_dom.cfg", "Arrival", "DOM", false},
+};
+static const int CONFIG_COUNT = sizeof(CONFIGS) / sizeof(CONFIGS[0]);
+
+struct BenchResult {
+  double seconds;
+  unsigned long long allocations;
+  size_t peakHeap;
+  FlightStoreStats store; // after this config
+};
+
+static double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// ============ CELL EXTRACTOR ============
+// Rows as the tokenizer hands them to the parser, with each cell's span
+struct RecordedRow {
+  std::string html;
+  std::vector<std::pair<size_t, size_t>> cells; // offset, length
+};
+
+static std::vector<RecordedRow> recordedRows;
+
+static void RecordToken(TokenizerEvent event, const char *data, size_t len,
+                        void *context) {
+  RowTokenizer &tok = *(RowTokenizer *)context;
+  if (event == TOKEN_ROW_BEGIN) {
+    recordedRows.emplace_back();
+  } else if (event == TOKEN_CELL) {
+    recordedRows.back().cells.push_back({(size_t)(data - tok.row), len});
+  } else if (event == TOKEN_ROW_END) {
+    recordedRows.back().html.assign(data, len);
+  } else if (event == TOKEN_ROW_DROPPED) {
+    recordedRows.pop_back();
+  }
+}
+
+static void RecordRows() {
+  static RowTokenizer tok;
+  for (int c = 0; c < CONFIG_COUNT; c++) {
+    for (int page = 1;; page++) {
+      const String *body = Replay_GetPage(CONFIGS[c].config, page);
+      if (!body)
+        break;
+      Tokenizer_Begin(tok, RecordToken, &tok);
+      Tokenizer_Feed(tok, body->c_str(), body->length());
+      Tokenizer_End(tok);
+    }
+  }
+}
+
+// The per-cell scan the row parser used before the single-pass extractor,
+// kept verbatim up to the point where it has fieldName and value
+static int LegacyExtractCells(const String &trHtml, String *names,
+                              String *values, int maxCells) {
+  int pos = 0;
+  int count = 0;
+  while (true) {
+    int tdStart = trHtml.indexOf("<td", pos);
+    if (tdStart == -1)
+      break;
+
+    int tdEnd = trHtml.indexOf("</td>", tdStart);
+    if (tdEnd == -1)
+      break;
+
+    int titleStart = trHtml.indexOf("title='", tdStart);
+    String fieldName = "";
+
+    if (titleStart >= 0 && titleStart < tdEnd) {
+      titleStart += 7;
+      int titleEnd = trHtml.indexOf("'", titleStart);
+      if (titleEnd > titleStart) {
+        String title = trHtml.substring(titleStart, titleEnd);
+        int fIndex = title.indexOf("Field:");
+        if (fIndex >= 0) {
+          fieldName = title.substring(fIndex + 6);
+          fieldName.trim();
+          int sp = fieldName.indexOf(' ');
+          if (sp > 0)
+            fieldName = fieldName.substring(0, sp);
+        }
+      }
+    }
+
+    int valueIndex = trHtml.indexOf("Value:", tdStart);
+    String value = "";
+
+    if (valueIndex >= 0 && valueIndex < tdEnd) {
+      valueIndex += 6;
+      int valueEnd = trHtml.indexOf("<", valueIndex);
+      if (valueEnd > valueIndex) {
+        value = trHtml.substring(valueIndex, valueEnd);
+        value.trim();
+      }
+    }
+
+    pos = tdEnd + 5;
+    if (fieldName.length() == 0 || value.length() == 0)
+      continue;
+    if (count < maxCells) {
+      names[count] = fieldName;
+      values[count] = value;
+      count++;
+    }
+  }
+  return count;
+}
+
+static int ExtractCells(const RecordedRow &row, RowFields &fields) {
+  fields.count = 0;
+  for (const auto &cell : row.cells) {
+    if (fields.count < ROW_MAX_CELLS &&
+        ExtractCellField(row.html.data() + cell.first, cell.second,
+                         fields.cells[fields.count]))
+      fields.count++;
+  }
+  return fields.count;
+}
+
+static void BenchCellExtractor(int iterations) {
+  RecordRows();
+  std::vector<String> legacyRows;
+  size_t cellCount = 0;
+  for (const auto &row : recordedRows) {
+    legacyRows.push_back(String(row.html.c_str(), row.html.size()));
+    cellCount += row.cells.size();
+  }
+
+  static RowFields fields;
+  String names[ROW_MAX_CELLS];
+  String values[ROW_MAX_CELLS];
+
+  // Both extractors must agree on every recorded row before timing them
+  int mismatches = 0;
+  for (size_t r = 0; r < recordedRows.size(); r++) {
+    int legacyCount =
+        LegacyExtractCells(legacyRows[r], names, values, ROW_MAX_CELLS);
+    int count = ExtractCells(recordedRows[r], fields);
+    bool same = legacyCount == count;
+    for (int i = 0; same && i < count; i++)
+      same = names[i] == fields.cells[i].name &&
+             values[i] == fields.cells[i].value;
+    if (!same)
+      mismatches++;
+  }
+
+  int reps = iterations * 25;
+  unsigned long long sink = 0;
+
+  HostHeapStats before = HostHeap_GetStats();
+  double start = Now();
+  for (int i = 0; i < reps; i++)
+    for (const auto &row : legacyRows)
+      sink += LegacyExtractCells(row, names, values, ROW_MAX_CELLS);
+  double legacySeconds = Now() - start;
+  unsigned long long legacyAllocs =
+      HostHeap_GetStats().allocations - before.allocations;
+
+  before = HostHeap_GetStats();
+  start = Now();
+  for (int i = 0; i < reps; i++)
+    for (const auto &row : recordedRows)
+      sink += ExtractCells(row, fields);
+  double seconds = Now() - start;
+  unsigned long long allocs =
+      HostHeap_GetStats().allocations - before.allocations;
+
+  double rows = (double)recordedRows.size() * reps;
+  printf("\ncell extractor: %u rows, %u cells, %d rep(s), %s\n",
+         (unsigned)recordedRows.size(), (unsigned)cellCount, reps,
+         mismatches ? "OUTPUT MISMATCH" : "outputs identical");
+  printf("%-15s %9s %10s\n", "extractor", "ns/row", "allocs/row");
+  printf("%-15s %9.0f %10.1f\n", "indexOf scan", legacySeconds * 1e9 / rows,
+         legacyAllocs / rows);
+  printf("%-15s %9.0f %10.1f\n", "single pass", seconds * 1e9 / rows,
+         allocs / rows);
+  printf("speedup: %.1fx (checksum %llu)\n",
+         seconds > 0 ? legacySeconds / seconds : 0, sink);
+}
+
+int main(int argc, char **argv) {
+  String corpusDir = "corpus";
+  int iterations = 20;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:i:h")) != -1) {
+    switch (opt) {
+    case 'p':
+      corpusDir = optarg;
+      break;
+    case 'i':
+      iterations = atoi(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: wfs_bench [-p corpus_dir] [-i iterations]\n");
+      return 2;
+    }
+  }
+  if (iterations < 1)
+    iterations = 1;
+
+  if (!Replay_Init(corpusDir)) {
+    fprintf(stderr, "no recorded pages in %s\n", corpusDir.c_str());
+    return 1;
+  }
+  HostHttp_SetHandler(Replay_Handler);
+  HostSerial_SetMuted(true);
+  FlightStore_Init();
+
+  BenchResult results[CONFIG_COUNT] = {};
+  for (int it = 0; it < iterations; it++) {
+    for (int c = 0; c < CONFIG_COUNT; c++) {
+      const BenchConfig &cfg = CONFIGS[c];
+      if (cfg.startsCycle)
+        FlightStore_Clear();
+
+      // Fetch() queues each page's flights for the uploader; this task
+      // takes that role and drops them (a config fits in the queue)
+      FlightQueue_Begin();
+      HostHeapStats before = HostHeap_GetStats();
+      HostHeap_ResetPeak();
+      double start = Now();
+      Fetch(cfg.config, cfg.category, cfg.subCategory);
+      double elapsed = Now() - start;
+      HostHeapStats after = HostHeap_GetStats();
+      int16_t rec;
+      while (FlightQueue_Pop(rec)) {
+      }
+
+      BenchResult &r = results[c];
+      r.seconds += elapsed;
+      r.allocations += after.allocations - before.allocations;
+      r.peakHeap = max(r.peakHeap, after.peakBytes - before.liveBytes);
+      r.store = FlightStore_GetStats();
+    }
+  }
+
+  printf("corpus: %s, %d iteration(s)\n\n", corpusDir.c_str(), iterations);
+  printf("%-15s %5s %5s %8s %9s %9s %7s %10s %9s %19s\n", "config", "pages",
+         "rows", "bytes", "us/page", "rows/s", "MB/s", "allocs/row",
+         "peak heap", "store flights/pool");
+
+  int totalPages = 0, totalRows = 0;
+  unsigned long totalBytes = 0;
+  double totalSeconds = 0;
+  unsigned long long totalAllocs = 0;
+  for (int c = 0; c < CONFIG_COUNT; c++) {
+    ReplayConfigStats stats = Replay_GetConfigStats(CONFIGS[c].config);
+    const BenchResult &r = results[c];
+    double perRun = r.seconds / iterations;
+    double allocsPerRow =
+        stats.rows ? (double)r.allocations / iterations / stats.rows : 0;
+
+    char usage[32];
+    bool dropped = r.store.droppedFlights || r.store.droppedValues ||
+                   r.store.droppedCounters;
+    snprintf(usage, sizeof(usage), "%u %u/%u%s", (unsigned)r.store.flights,
+             (unsigned)r.store.poolUsed, (unsigned)FLIGHT_STORE_POOL_BYTES,
+             dropped ? " FULL" : "");
+    printf("%-15s %5d %5d %8lu %9.1f %9.0f %7.2f %10.1f %9u %19s\n",
+           CONFIGS[c].name,
+           stats.pages, stats.rows, stats.bytes,
+           stats.pages ? perRun * 1e6 / stats.pages : 0,
+           perRun > 0 ? stats.rows / perRun : 0,
+           perRun > 0 ? stats.bytes / perRun / 1e6 : 0, allocsPerRow,
+           (unsigned)r.peakHeap, usage);
+
+    totalPages += stats.pages;
+    totalRows += stats.rows;
+    totalBytes += stats.bytes;
+    totalSeconds += perRun;
+    totalAllocs += r.allocations / iterations;
+  }
+
+  printf("%-15s %5d %5d %8lu %9.1f %9.0f %7.2f %10.1f\n", "total", totalPages,
+         totalRows, totalBytes, totalPages ? totalSeconds * 1e6 / totalPages : 0,
+         totalSeconds > 0 ? totalRows / totalSeconds : 0,
+         totalSeconds > 0 ? totalBytes / totalSeconds / 1e6 : 0,
+         totalRows ? (double)totalAllocs / totalRows : 0);
+
+  double parseMsPerPage = totalPages ? totalSeconds * 1e3 / totalPages : 0;
+  double pacingMs = 60000.0 / PACING_DEFAULT_RATE;
+  printf("\nparse time per page: %.3f ms vs %.0f ms pacing: %.4f%% of the "
+         "page interval\n",
+         parseMsPerPage, pacingMs, parseMsPerPage / pacingMs * 100.0);
+  printf("serial bytes per cycle: %llu\n",
+         HostSerial_BytesWritten() / iterations);
+
+  BenchCellExtractor(iterations);
+  return 0;
+}
@@ -0,0 +1,234 @@
+// Host check + microbenchmark: date/time kernel (DateTime.cpp)
+// Runs DateTime_Normalize() / DateTime_CompactMinutes() side by side with the
+// String code the parser used before (ISO substring() rebuild, the stm
+// fallbacks, ParseKeySTMTime() via mktime) and fails on any difference:
+//   - a table of edge cases (leap days, bad layouts, 2/4 digit years)
+//   - a sweep over 2000-2099 in 7 minute steps, through every input layout
+// Then times both on a mix of the layouts WebDavis sends.
+//
+//   wfs_datetime [-i iterations]
+//
+// Exit status is 1 when any check fails, so `make check` can gate on it.
+
+#include "Global.h"
+
+#include <chrono>
+#include <unistd.h>
+
+static double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// ============ PREVIOUS IMPLEMENTATION ============
+// Kept verbatim from ExtractTDInfoJSON / ParseKeySTMTime, minus logging.
+// Returns false where the old code skipped the stm field.
+static bool LegacyNormalize(String &value, bool stm) {
+  if (value.length() == 19 && value[4] == '-' && value[7] == '-' &&
+      value[10] == ' ' && value[13] == ':' && value[16] == ':') {
+    value = value.substring(2, 4) + value.substring(5, 7) +
+            value.substring(8, 10) + value.substring(11, 13) +
+            value.substring(14, 16);
+  }
+  if (!stm)
+    return true;
+
+  if (value.length() == 12 && value.substring(0, 4).toInt() > 1999) {
+    value = value.substring(2);
+  } else if (value.length() > 10) {
+    String cleanValue = "";
+    for (int i = 0; i < (int)value.length() && cleanValue.length() < 12; i++) {
+      if (isdigit(value[i])) {
+        cleanValue += value[i];
+      }
+    }
+    if (cleanValue.length() == 12) {
+      value = cleanValue.substring(2);
+    } else if (cleanValue.length() == 10) {
+      value = cleanValue;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static time_t LegacyParseKeySTMTime(String keySTM) {
+  if (keySTM.length() != 10)
+    return 0;
+
+  struct tm timeinfo = {0};
+  timeinfo.tm_year = (keySTM.substring(0, 2).toInt() + 2000) - 1900;
+  timeinfo.tm_mon = keySTM.substring(2, 4).toInt() - 1;
+  timeinfo.tm_mday = keySTM.substring(4, 6).toInt();
+  timeinfo.tm_hour = keySTM.substring(6, 8).toInt();
+  timeinfo.tm_min = keySTM.substring(8, 10).toInt();
+  timeinfo.tm_sec = 0;
+
+  return mktime(&timeinfo);
+}
+
+// ============ CHECKS ============
+static int failures = 0;
+static int checks = 0;
+
+static void Fail(const char *input, const char *what, const String &expected,
+                 const String &actual) {
+  failures++;
+  if (failures <= 20)
+    printf("FAIL %-24s %-8s expected '%s' got '%s'\n", input, what,
+           expected.c_str(), actual.c_str());
+}
+
+// Same input through both implementations; text, skip decision and (for
+// real dates) the Unix time must agree
+static void CheckValue(const char *input, bool stm) {
+  checks++;
+  String legacy = input;
+  bool legacyKept = LegacyNormalize(legacy, stm);
+
+  char text[CELL_VALUE_MAX];
+  uint8_t len = strlen(input);
+  memcpy(text, input, len + 1);
+  uint32_t minutes;
+  DateTimeShape shape = DateTime_Normalize(text, len, stm, &minutes);
+  bool kept = shape != DATETIME_BAD;
+
+  if (kept != legacyKept) {
+    Fail(input, "skip", legacyKept ? "kept" : "skipped",
+         kept ? "kept" : "skipped");
+    return;
+  }
+  if (!kept)
+    return;
+  if (legacy != text || legacy.length() != len) {
+    Fail(input, "text", legacy, text);
+    return;
+  }
+  if (minutes == DATETIME_INVALID)
+    return; // the old code had no notion of a valid date; nothing to compare
+
+  time_t expected = LegacyParseKeySTMTime(legacy);
+  time_t actual = DateTime_MinutesToEpoch(minutes);
+  if (expected != actual)
+    Fail(input, "epoch", String((long)expected), String((long)actual));
+
+  char formatted[11];
+  DateTime_FormatCompact(minutes, formatted);
+  if (legacy != formatted)
+    Fail(input, "format", legacy, formatted);
+}
+
+static void CheckInvalidDate(const char *compact) {
+  checks++;
+  if (DateTime_CompactMinutes(compact, strlen(compact)) != DATETIME_INVALID)
+    Fail(compact, "invalid", "DATETIME_INVALID", "minutes");
+}
+
+static const char *CASES[] = {
+    "2026-01-31 08:10:00", "2024-02-29 23:59:59", "2000-01-01 00:00:00",
+    "2099-12-31 23:59:00", "202601310810",       "199912312359",
+    "2601310810",          "2026/01/31 08:10",   "31.01.2026 08:10",
+    "2026-01-31T08:10:00", "26-01-31 08:10",     "2026-01-31 08:10",
+    "Value 2026 01 31",    "PK 300",             "ONTIME",
+    "",                    "12",                 "26013108100",
+    "2026013108",          "x2026-01-31 08:10:00"};
+
+static const char *INVALID_DATES[] = {"2502291200", "2613011200", "2600011200",
+                                      "2601321200", "2601312400", "2601311260",
+                                      "26013112a0", "2604311200"};
+
+static void RunChecks() {
+  // The firmware runs at GMT+5; mktime() in the old code used that zone
+  setenv("TZ", "PKT-5", 1);
+  tzset();
+
+  for (const char *input : CASES) {
+    CheckValue(input, true);
+    CheckValue(input, false);
+  }
+  for (const char *compact : INVALID_DATES)
+    CheckInvalidDate(compact);
+
+  // Every layout for a spread of minutes across 2000-01-01 .. 2099-12-31
+  const uint32_t END_OF_2099 = 36525UL * 1440;
+  for (uint32_t minutes = 0; minutes < END_OF_2099; minutes += 7) {
+    char compact[11];
+    DateTime_FormatCompact(minutes, compact);
+    if (DateTime_CompactMinutes(compact, 10) != minutes) {
+      checks++;
+      Fail(compact, "roundtrip", String(minutes),
+           String(DateTime_CompactMinutes(compact, 10)));
+      continue;
+    }
+
+    char iso[20];
+    snprintf(iso, sizeof(iso), "20%.2s-%.2s-%.2s %.2s:%.2s:00", compact,
+             compact + 2, compact + 4, compact + 6, compact + 8);
+    char year4[13];
+    snprintf(year4, sizeof(year4), "20%s", compact);
+    CheckValue(iso, true);
+    CheckValue(year4, true);
+    CheckValue(compact, true);
+  }
+}
+
+// ============ MICROBENCHMARK ============
+static void RunBench(int iterations) {
+  static const char *MIX[] = {"2026-01-31 08:10:00", "2026-01-31 09:45:00",
+                              "202601311120",        "2601311205",
+                              "2026/01/31 13:30",    "2026-02-01 00:05:00"};
+  const int mixCount = sizeof(MIX) / sizeof(MIX[0]);
+  long reps = (long)iterations * 20000;
+  unsigned long long sink = 0;
+
+  double start = Now();
+  for (long i = 0; i < reps; i++) {
+    String value = MIX[i % mixCount];
+    if (LegacyNormalize(value, true))
+      sink += LegacyParseKeySTMTime(value);
+  }
+  double legacySeconds = Now() - start;
+
+  start = Now();
+  for (long i = 0; i < reps; i++) {
+    const char *input = MIX[i % mixCount];
+    char text[CELL_VALUE_MAX];
+    uint8_t len = strlen(input);
+    memcpy(text, input, len + 1);
+    uint32_t minutes;
+    if (DateTime_Normalize(text, len, true, &minutes) != DATETIME_BAD)
+      sink += DateTime_MinutesToEpoch(minutes);
+  }
+  double seconds = Now() - start;
+
+  printf("\n%-18s %9s\n", "stm -> epoch", "ns/value");
+  printf("%-18s %9.1f\n", "substring+mktime", legacySeconds * 1e9 / reps);
+  printf("%-18s %9.1f\n", "in-place kernel", seconds * 1e9 / reps);
+  printf("speedup: %.1fx (checksum %llu)\n",
+         seconds > 0 ? legacySeconds / seconds : 0, sink);
+}
+
+int main(int argc, char **argv) {
+  int iterations = 20;
+  int opt;
+  while ((opt = getopt(argc, argv, "i:h")) != -1) {
+    switch (opt) {
+    case 'i':
+      iterations = atoi(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: wfs_datetime [-i iterations]\n");
+      return 2;
+    }
+  }
+  if (iterations < 1)
+    iterations = 1;
+  HostSerial_SetMuted(true);
+
+  RunChecks();
+  printf("date/time kernel: %d checks, %d failure(s)\n", checks, failures);
+  RunBench(iterations);
+  return failures ? 1 : 0;
+}
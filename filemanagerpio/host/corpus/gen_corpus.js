@@ -0,0 +1,183 @@
+// Generates the fixed WebDavis replay corpus used by the host benchmarks.
+// Output is deterministic (seeded PRNG), so re-running it only produces a
+// diff when this generator changes.
+//
+//   node gen_corpus.js        (writes *.html next to this script)
+
+const fs = require("fs");
+const path = require("path");
+
+let seed = 0x5eed1234;
+function rand() {
+  // mulberry32
+  seed = (seed + 0x6d2b79f5) | 0;
+  let t = seed;
+  t = Math.imul(t ^ (t >>> 15), t | 1);
+  t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+  return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+}
+const pick = (a) => a[Math.floor(rand() * a.length)];
+const pad = (n) => String(n).padStart(2, "0");
+
+const INT_AIRLINES = ["PK", "QR", "EK", "TK", "EY", "SV", "GF", "WY", "FZ", "G9", "PA", "ER", "9P"];
+const DOM_AIRLINES = ["PK", "PA", "ER", "9P"];
+const INT_CITIES = ["Dubai", "Doha", "Jeddah", "Riyadh", "Istanbul", "Abu Dhabi", "Muscat",
+  "Bahrain", "Sharjah", "London", "Manchester", "Toronto", "Kuala Lumpur", "Madinah"];
+const DOM_CITIES = ["Karachi", "Lahore", "Quetta", "Peshawar", "Multan", "Skardu", "Gilgit", "Faisalabad"];
+const DEP_STATUS = ["Scheduled", "Check-in Open", "Boarding", "Gate Closed", "Departed", "Delayed"];
+const ARR_STATUS = ["Expected", "On Time", "Delayed", "Landed", "Baggage Delivered"];
+const REMARKS = ["", "", "", "Final Call", "Go To Gate", "New Time", "Cancelled"];
+const AIRCRAFT = ["A320", "A321", "B777", "B737", "A330", "ATR72", "B787"];
+
+// Minutes are counted from 2026-01-31 00:00 and may roll into February.
+function iso(minutes) {
+  const dayOffset = Math.floor(minutes / 1440);
+  const date = dayOffset === 0 ? "2026-01-31" : `2026-02-${pad(dayOffset)}`;
+  const h = Math.floor(minutes / 60) % 24;
+  const m = minutes % 60;
+  return `${date} ${pad(h)}:${pad(m)}:00`;
+}
+
+function flightNumber(airlines) {
+  const code = pick(airlines);
+  const num = 100 + Math.floor(rand() * 900);
+  const r = rand();
+  if (r < 0.06) return `${code} ${num} ${2000 + Math.floor(rand() * 30)}`; // garbage after 2nd space
+  if (r < 0.10) return `${code}-${num}`;
+  return `${code} ${num}`;
+}
+
+function cell(field, value) {
+  return `      <td class='c_${field}' title='Field: ${field} (${field.toUpperCase()})' nowrap>Value: ${value}</td>`;
+}
+
+function makeFlights(count, airlines, cities, startMinute) {
+  const flights = [];
+  let minute = startMinute;
+  for (let i = 0; i < count; i++) {
+    minute += 5 + Math.floor(rand() * 25);
+    flights.push({
+      minute,
+      flnr: flightNumber(airlines),
+      city: pick(cities),
+      via: rand() < 0.15 ? pick(cities) : "",
+    });
+  }
+  return flights;
+}
+
+function departureRow(f, i) {
+  const delayed = rand() < 0.2;
+  return [
+    cell("stm", iso(f.minute)),
+    cell("flnr", f.flnr),
+    cell("city_lu", f.city),
+    cell("via1_lu", f.via),
+    cell("ect", delayed ? iso(f.minute + 20 + Math.floor(rand() * 60)) : ""),
+    cell("att", rand() < 0.3 ? iso(f.minute + Math.floor(rand() * 15)) : ""),
+    cell("gat1", rand() < 0.8 ? `A${1 + Math.floor(rand() * 12)}` : ""),
+    cell("bre1", pick(DEP_STATUS)),
+    cell("prem_lu", pick(REMARKS)),
+    cell("fsta_lu", pick(DEP_STATUS)),
+    cell("cro1", `Z${1 + (i % 4)}`),
+    cell("act", pick(AIRCRAFT)),
+    cell("regn", `AP-B${String.fromCharCode(65 + (i % 26))}${String.fromCharCode(65 + ((i * 7) % 26))}`),
+    "      <td class='tools'><a href='#' onclick='return false;'>&raquo;</a></td>",
+  ];
+}
+
+function arrivalRow(f) {
+  return [
+    cell("stm", iso(f.minute)),
+    cell("flnr", f.flnr),
+    cell("city_lu", f.city),
+    cell("via1_lu", f.via),
+    cell("ect", rand() < 0.5 ? iso(f.minute + Math.floor(rand() * 40)) : ""),
+    cell("att", rand() < 0.35 ? iso(f.minute + Math.floor(rand() * 30)) : ""),
+    cell("blt1", rand() < 0.6 ? String(1 + Math.floor(rand() * 8)) : ""),
+    cell("prem_lu", pick(REMARKS)),
+    cell("fsta_lu", pick(ARR_STATUS)),
+    cell("act", pick(AIRCRAFT)),
+    "      <td class='tools'><a href='#' onclick='return false;'>&raquo;</a></td>",
+  ];
+}
+
+function checkinRows(f, counters) {
+  const rows = [];
+  for (const counter of counters) {
+    rows.push([
+      cell("stm", iso(f.minute)),
+      cell("flnr", f.flnr),
+      cell("city_lu", f.city),
+      cell("ckco", String(counter)),
+      cell("crem", rand() < 0.5 ? "Economy" : "Business"),
+      cell("crem_lu", rand() < 0.7 ? "Open" : "Closed"),
+      cell("cctf", iso(Math.max(0, f.minute - 180))),
+      cell("cctt", iso(Math.max(0, f.minute - 45))),
+      cell("crow", String.fromCharCode(65 + Math.floor(rand() * 6))),
+      cell("aopn", iso(Math.max(0, f.minute - 180))),
+      cell("aclo", iso(Math.max(0, f.minute - 45))),
+      cell("cro1", `Z${1 + (counter % 4)}`),
+    ]);
+  }
+  return rows;
+}
+
+function page(rows, pageNo, pages, totalRows, session) {
+  const out = [];
+  out.push("<!DOCTYPE html>");
+  out.push("<html>");
+  out.push("<head><meta charset='utf-8'><title>WebDavis</title>");
+  out.push("<link rel='stylesheet' href='css/webdavis.css'></head>");
+  out.push("<body>");
+  out.push("<form method='post' action='index.php' name='main'>");
+  out.push(`  <input type='hidden' name='PHPSESSID' value='${session}'>`);
+  out.push(`  <div class='pager'>Page: ${pageNo} from ${pages} (${totalRows} rows)</div>`);
+  out.push("  <table class='grid' cellspacing='0'>");
+  out.push("    <tr class='header'><th>Time</th><th>Flight</th><th>City</th><th>...</th></tr>");
+  rows.forEach((cells, i) => {
+    out.push(`    <tr class='row_${i % 2}'>`);
+    for (const c of cells) out.push(c);
+    out.push("    </tr>");
+  });
+  out.push("  </table>");
+  out.push("  <input type='submit' name='n' value='>'>");
+  out.push("</form>");
+  out.push("</body>");
+  out.push("</html>");
+  return out.join("\n") + "\n";
+}
+
+function writeConfig(name, rows, perPage) {
+  const pages = Math.max(1, Math.ceil(rows.length / perPage));
+  for (let p = 0; p < pages; p++) {
+    const slice = rows.slice(p * perPage, (p + 1) * perPage);
+    const session = `rec${name.replace(/_/g, "")}${String(p + 1).padStart(4, "0")}`;
+    fs.writeFileSync(path.join(__dirname, `${name}.${p + 1}.html`),
+      page(slice, p + 1, pages, rows.length, session));
+  }
+}
+
+fs.writeFileSync(path.join(__dirname, "session.html"),
+  "<!DOCTYPE html>\n<html>\n<body>\n<form method='post' action='index.php'>\n" +
+  "  <input type='hidden' name='PHPSESSID' value='rec0000session0000000001'>\n" +
+  "  <select name='configs'><option>configs/FREE/departure_int.cfg</option></select>\n" +
+  "</form>\n</body>\n</html>\n");
+
+const depInt = makeFlights(60, INT_AIRLINES, INT_CITIES, 0);
+const depDom = makeFlights(40, DOM_AIRLINES, DOM_CITIES, 30);
+const arrInt = makeFlights(60, INT_AIRLINES, INT_CITIES, 10);
+const arrDom = makeFlights(40, DOM_AIRLINES, DOM_CITIES, 40);
+
+writeConfig("departure_int", depInt.map(departureRow), 20);
+writeConfig("departure_dom", depDom.map(departureRow), 20);
+writeConfig("arrival_int", arrInt.map(arrivalRow), 20);
+writeConfig("arrival_dom", arrDom.map(arrivalRow), 20);
+
+// Check-in: one row per open counter for the first international departures
+const checkin = [];
+depInt.slice(0, 24).forEach((f, i) => {
+  const counters = [10 + i * 3, 11 + i * 3].slice(0, 1 + (i % 2));
+  checkin.push(...checkinRows(f, counters));
+});
+writeConfig("checkin", checkin, 20);
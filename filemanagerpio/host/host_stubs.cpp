@@ -0,0 +1,21 @@
+// Firmware functions whose translation units (MyWiFi.cpp, MyServer.cpp, ...)
+// are not part of the host build.
+
+#include "Global.h"
+
+String NTP_GetFormattedTimestamp() {
+  time_t now = time(nullptr);
+  struct tm timeinfo;
+
+  if (!localtime_r(&now, &timeinfo)) {
+    return "Time not set";
+  }
+
+  char buffer[64];
+  strftime(buffer, sizeof(buffer), "%d %b %Y %I:%M %p", &timeinfo);
+  return String(buffer);
+}
+
+bool NTP_IsTimeSet() { return true; }
+
+bool WiFi_IsConnected() { return WiFi.status() == WL_CONNECTED; }
@@ -0,0 +1,365 @@
+// Host harness: runs the fetch -> parse -> filter -> upload cycle as a normal
+// Linux process. WebDavis pages are replayed from a directory of recorded
+// index.php responses (see replay.cpp) and uploads land in an in-memory
+// RTDB behind the FirebaseClient shim (rtdb_stub.cpp). LittleFS is a host
+// directory (-f), so the upload snapshot carries over between runs like it
+// does across ESP.restart().
+//
+//   wfs_host [-p pages_dir] [-f littlefs_dir] [-n cycles]
+//            [-l firebase_latency_ms] [-j firebase_jitter_ms]
+//            [-k firebase_kbytes_per_s]
+//            [-b batch_bytes] [-w write_window] [-e fail_every]
+//            [-o offline_cycles] [-s server_latency_ms] [-J server_jitter_ms]
+//            [-x server_fail_every] [-r pages_per_min] [-t]
+//            [-u truncate_every] [-z rotate_every]
+//            [-g synthetic_flights] [-c change_percent]
+//            [-E rtdb_fail_every] [-L rtdb_lose_every] [-R host:port]
+//            [-D tree_file] [-T trace_file] [-M metrics_file] [-q] [-d]
+//
+// -t serves the pages from a local TCP stub server (webdavis_stub.cpp)
+// instead of handing requests to the replay directly, so connection reuse
+// shows up as real connections. -g replaces the recorded pages with
+// synthetic tables that change between fetches (replay.cpp). -b 0 uploads
+// one flight per request instead of batching, and -R sends the RTDB
+// requests to a wfs_rtdb process instead of the in-memory tree.
+
+#include "Global.h"
+#include "HostTransport.h"
+#include "replay.h"
+#include "rtdb_stub.h"
+#include "webdavis_stub.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <unistd.h>
+
+static String pagesDir = "corpus";
+static unsigned long statusEvents = 0;
+static unsigned long progressEvents = 0;
+
+// Stands in for /api/events: counts what the web UI would be sent
+static void CountStatusEvent(const char *event, const char *json,
+                             uint32_t id) {
+  (void)json;
+  (void)id;
+  if (strcmp(event, "status") == 0)
+    statusEvents++;
+  else
+    progressEvents++;
+}
+
+static void Usage() {
+  fprintf(stderr, "usage: wfs_host [-p pages_dir] [-f littlefs_dir] "
+                  "[-n cycles] [-l firebase_latency_ms] "
+                  "[-j firebase_jitter_ms] "
+                  "[-k firebase_kbytes_per_s] [-b batch_bytes] "
+                  "[-w write_window] [-e fail_every] [-o offline_cycles] "
+                  "[-s server_latency_ms] [-J server_jitter_ms] "
+                  "[-x server_fail_every] "
+                  "[-r pages_per_min] [-t] [-u truncate_every] "
+                  "[-z rotate_every] [-g synthetic_flights] "
+                  "[-c change_percent] [-E rtdb_fail_every] "
+                  "[-L rtdb_lose_every] [-R host:port] [-D tree_file] "
+                  "[-T trace_file] [-M metrics_file] [-q] [-d]\n");
+}
+
+int main(int argc, char **argv) {
+  int cycles = 1;
+  int offlineCycles = 0;
+  bool dumpWrites = false;
+  bool stub = false;
+  StubOptions stubOptions = {};
+  ReplayOptions replayOptions = {0, REPLAY_SESSION_IDLE_MS};
+  unsigned long serverLatency = 0;
+  unsigned long serverJitter = 0;
+  int syntheticFlights = 0;
+  int changePercent = 10;
+  RtdbStubOptions rtdbOptions = {};
+  String remote = "";
+  String treeFile = "";
+  String traceFile = "";
+  String metricsFile = "";
+  int opt;
+  while ((opt = getopt(argc, argv,
+                       "p:f:n:l:j:k:b:w:e:o:s:J:x:r:tu:z:g:c:E:L:R:D:T:M:qdh")) !=
+         -1) {
+    switch (opt) {
+    case 'p':
+      pagesDir = optarg;
+      break;
+    case 'f':
+      HostLittleFS_SetRoot(optarg);
+      break;
+    case 'n':
+      cycles = atoi(optarg);
+      break;
+    case 'l':
+      HostFirebase_SetLatency(strtoul(optarg, nullptr, 10));
+      break;
+    case 'j':
+      HostFirebase_SetJitter(strtoul(optarg, nullptr, 10));
+      break;
+    case 'k':
+      HostFirebase_SetBandwidth(strtoul(optarg, nullptr, 10) * 1024);
+      break;
+    case 'w':
+      Firebase_SetWriteWindow(atoi(optarg));
+      break;
+    case 'b':
+      if (strtoul(optarg, nullptr, 10) == 0)
+        Sync_SetBatching(false);
+      else
+        Batch_SetBudget(strtoul(optarg, nullptr, 10));
+      break;
+    case 'e':
+      HostFirebase_SetFailEvery(atoi(optarg));
+      break;
+    case 'o':
+      offlineCycles = atoi(optarg);
+      break;
+    case 's':
+      serverLatency = strtoul(optarg, nullptr, 10);
+      break;
+    case 'J':
+      serverJitter = strtoul(optarg, nullptr, 10);
+      break;
+    case 'x':
+      HostHttp_SetFailEvery(atoi(optarg));
+      break;
+    case 'r':
+      Pacing_SetRate(strtoul(optarg, nullptr, 10));
+      break;
+    case 't':
+      stub = true;
+      break;
+    case 'u':
+      stubOptions.truncateEvery = atoi(optarg);
+      stub = true; // cut off at the transport
+      break;
+    case 'z':
+      replayOptions.rotateEvery = atoi(optarg);
+      break;
+    case 'g':
+      syntheticFlights = atoi(optarg);
+      break;
+    case 'c':
+      changePercent = atoi(optarg);
+      break;
+    case 'E':
+      rtdbOptions.failEvery = atoi(optarg);
+      break;
+    case 'L':
+      rtdbOptions.loseEvery = atoi(optarg);
+      break;
+    case 'R':
+      remote = optarg;
+      break;
+    case 'D':
+      treeFile = optarg;
+      break;
+    case 'T':
+      traceFile = optarg;
+      break;
+    case 'M':
+      metricsFile = optarg;
+      break;
+    case 'q':
+      HostSerial_SetMuted(true);
+      break;
+    case 'd':
+      dumpWrites = true;
+      break;
+    default:
+      Usage();
+      return 2;
+    }
+  }
+
+  if (syntheticFlights > 0) {
+    Replay_InitSynthetic(syntheticFlights, changePercent);
+  } else if (!Replay_Init(pagesDir)) {
+    fprintf(stderr, "no recorded pages in %s\n", pagesDir.c_str());
+    return 1;
+  }
+  Replay_SetOptions(replayOptions);
+  if (stub) {
+    // The stub sleeps in wall time, which the host clock includes
+    stubOptions.latencyMs = serverLatency;
+    stubOptions.jitterMs = serverJitter;
+    int port = Stub_Start(Replay_Handler, stubOptions);
+    if (port < 0) {
+      fprintf(stderr, "cannot start the WebDavis stub server\n");
+      return 1;
+    }
+    HostHttp_SetEndpoint("127.0.0.1", port);
+  } else {
+    HostHttp_SetHandler(Replay_Handler);
+    HostHttp_SetLatency(serverLatency);
+    HostHttp_SetJitter(serverJitter);
+  }
+  if (remote.length() > 0) {
+    int colon = remote.indexOf(':');
+    if (colon < 0) {
+      fprintf(stderr, "-R wants host:port\n");
+      return 2;
+    }
+    RtdbStub_SetRemote(remote.substring(0, colon).c_str(),
+                       remote.substring(colon + 1).toInt());
+    HostFirebase_SetHandler(RtdbStub_RemoteHandler);
+  } else {
+    RtdbStub_SetOptions(rtdbOptions);
+    HostFirebase_SetHandler(RtdbStub_Handler);
+  }
+  Status_Init();
+  Status_SetListener(CountStatusEvent);
+  FlightStore_Init();
+  Batch_Init();
+  LittleFS_Init();
+  Snapshot_Init();
+  PageCache_Init();
+  Wal_Init();
+  Health_Init();
+  Firebase_Init();
+  Trace_Init();
+
+  auto wallStart = std::chrono::steady_clock::now();
+  unsigned long virtualStart = millis();
+  for (int i = 0; i < cycles; i++) {
+    HostFirebase_SetOnline(i >= offlineCycles);
+    Health_CycleDone(Sync_RunCycle());
+    // The device would restart here; the host reports it and goes on
+    uint32_t value;
+    HealthReason reason = Health_Check(value);
+    if (reason != HEALTH_OK)
+      fprintf(stderr, "health: restart due after cycle %d (%s, value %u)\n",
+              i + 1, HEALTH_REASON_NAMES[reason], value);
+  }
+  double wallMs = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - wallStart)
+                      .count();
+
+  if (dumpWrites) {
+    for (unsigned long i = 0; i < HostFirebase_WriteCount(); i++) {
+      const HostFirebaseWrite *w = HostFirebase_GetWrite(i);
+      printf("%s %s %s\n", w->method.c_str(), w->path.c_str(),
+             w->body.c_str());
+    }
+  }
+
+  // Request counts before the tree is read, then the tree the RTDB ends up
+  // with
+  HostHttpHandler rtdb =
+      remote.length() > 0 ? RtdbStub_RemoteHandler : RtdbStub_Handler;
+  RtdbStubStats served = RtdbStub_GetStats();
+  String tree, rtdbStats;
+  if (remote.length() == 0) {
+    rtdbStats = String(served.requests) + " requests (" +
+                String(served.patches) + " PATCH, " + String(served.puts) +
+                " PUT), " + String(served.locations) + " locations, " +
+                String(served.bytes) + " bytes, " + String(served.failed) +
+                " failed, " + String(served.lost) + " answers lost, " +
+                String(served.rejected) + " rejected";
+  } else if (rtdb("GET", "/.stats", "", rtdbStats) != 200) {
+    rtdbStats = "unavailable";
+  }
+  if (treeFile.length() > 0) {
+    FILE *file = fopen(treeFile.c_str(), "w");
+    if (!file || rtdb("GET", "/.json", "", tree) != 200) {
+      fprintf(stderr, "cannot write the RTDB tree to %s\n",
+              treeFile.c_str());
+    } else {
+      fprintf(file, "%s\n", tree.c_str());
+    }
+    if (file)
+      fclose(file);
+  }
+
+  // The trace ring as /api/trace would serve it
+  if (traceFile.length() > 0) {
+    static TraceRecord records[TRACE_RING_SIZE];
+    uint32_t total;
+    size_t count = Trace_Snapshot(records, TRACE_RING_SIZE, total);
+    FILE *file = fopen(traceFile.c_str(), "w");
+    if (!file) {
+      fprintf(stderr, "cannot write the trace to %s\n", traceFile.c_str());
+    } else {
+      fprintf(file, "# ms core event a b (%u of %lu records)\n",
+              (unsigned)count, (unsigned long)total);
+      char line[80];
+      for (size_t i = 0; i < count; i++) {
+        Trace_Format(records[i], line, sizeof(line));
+        fputs(line, file);
+      }
+      fclose(file);
+    }
+  }
+
+  // What /metrics would answer after the run
+  if (metricsFile.length() > 0) {
+    static char text[METRICS_TEXT_BYTES];
+    size_t length = Metrics_Format(text, sizeof(text));
+    FILE *file = fopen(metricsFile.c_str(), "w");
+    if (!file)
+      fprintf(stderr, "cannot write the metrics to %s\n", metricsFile.c_str());
+    else
+      fwrite(text, 1, length, file);
+    if (file)
+      fclose(file);
+  }
+
+  SnapshotStats delta = Snapshot_GetStats();
+  RttStats rtt = Rtt_GetStats();
+  WalStats wal = Wal_GetStats();
+  HealthStats health = Health_GetStats();
+  PacingStats pacing = Pacing_GetStats();
+  WebDavisStats webdavis = WebDavis_GetStats();
+  PageCacheStats pages = PageCache_GetStats();
+  ReplayStats replay = Replay_GetStats();
+  fprintf(stderr,
+          "\n== host cycle summary ==\n"
+          "cycles:          %d\n"
+          "wall time:       %.1f ms\n"
+          "device time:     %lu ms (includes virtual delay())\n"
+          "http requests:   %lu\n"
+          "firebase writes: %lu (at most %lu in flight)\n"
+          "last cycle:      %u new, %u changed, %u unchanged flights\n"
+          "rtt:             srtt %u ms, p50/p90/p99 %u/%u/%u ms, timeout %u "
+          "ms, %u timeouts, %u retries\n"
+          "write-ahead log: %u bytes, %u appended, %u replayed, %u evicted\n"
+          "health:          %u failed cycles in a row, %u watchdog misses\n"
+          "webdavis:        %u requests over %u connection(s), %u session "
+          "GET(s), %u rotation(s), %u cut off\n"
+          "index.php:       %lu pages, %lu sessions, %lu rotations, %lu "
+          "expired, %lu missing\n"
+          "page pacing:     %u pages/min, last fetch %u ms (planned %u ms), "
+          "%u backoffs, %u failed pages\n"
+          "page cache:      last cycle %u unchanged, %u changed, %u forced "
+          "pages, %u rows carried over; %u/%u hits/misses in all\n"
+          "serial bytes:    %llu\n",
+          cycles, wallMs, millis() - virtualStart, HostHttp_RequestCount(),
+          HostFirebase_WriteCount(), HostFirebase_MaxInFlight(),
+          delta.flights[SNAPSHOT_NEW],
+          delta.flights[SNAPSHOT_CHANGED], delta.flights[SNAPSHOT_UNCHANGED],
+          rtt.srtt, rtt.p50, rtt.p90, rtt.p99, rtt.timeout, rtt.timeouts,
+          rtt.retries, wal.bytes, wal.appended, wal.replayed, wal.evicted,
+          health.failedCycles, health.watchdogMisses, webdavis.requests,
+          webdavis.connections, webdavis.sessions, webdavis.rotations,
+          webdavis.truncated, replay.pages, replay.sessions, replay.rotations,
+          replay.expired, replay.missing,
+          pacing.rate,
+          pacing.fetched, pacing.planned, pacing.backoffs, pacing.errors,
+          pages.hits, pages.misses, pages.forced, pages.carried,
+          pages.totalHits, pages.totalMisses,
+          HostSerial_BytesWritten());
+  fprintf(stderr, "rtdb:            %s\n", rtdbStats.c_str());
+  fprintf(stderr, "status events:   %lu status, %lu progress\n", statusEvents,
+          progressEvents);
+  if (stub) {
+    StubStats stubStats = Stub_GetStats();
+    fprintf(stderr,
+            "stub server:     %lu requests over %lu connection(s), %lu cut "
+            "off\n",
+            stubStats.requests, stubStats.connections, stubStats.truncated);
+  }
+  return 0;
+}
@@ -0,0 +1,400 @@
+// Host harness: recorded or synthetic page replay with index.php sessions
+
+#include "replay.h"
+
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ReplaySession {
+  std::string config; // base name, "" until a configs= POST
+  int page;
+  int served; // pages under the current id, for rotation
+  unsigned long usedAt;
+};
+
+static std::map<std::string, String> pages;
+static std::map<std::string, ReplaySession> sessions; // by PHPSESSID
+static std::map<std::string, int> generations; // synthetic: fetches per config
+static unsigned long sessionCounter = 0;
+static ReplayOptions options = {0, REPLAY_SESSION_IDLE_MS};
+static ReplayStats stats = {};
+static bool synthetic = false;
+static int syntheticFlights = 0;
+static int syntheticChange = 0;
+
+static bool ReadFile(const std::string &path, String &out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string data = ss.str();
+  out = String(data.c_str(), data.size());
+  return true;
+}
+
+// "configs/FREE/departure_int.cfg" -> "departure_int"
+static String ConfigBaseName(const String &config) {
+  int slash = config.lastIndexOf('/');
+  String base = config.substring(slash + 1);
+  int dot = base.lastIndexOf('.');
+  if (dot > 0 && base.endsWith(".cfg"))
+    base = base.substring(0, dot);
+  return base;
+}
+
+static String FormValue(const String &body, const String &name) {
+  int idx = body.indexOf(name + "=");
+  if (idx < 0)
+    return "";
+  idx += name.length() + 1;
+  int end = body.indexOf('&', idx);
+  return end < 0 ? body.substring(idx) : body.substring(idx, end);
+}
+
+static const String *FindPage(const String &name) {
+  auto it = pages.find(name.c_str());
+  return it == pages.end() ? nullptr : &it->second;
+}
+
+// The recorded pages carry the id of the recording session
+static void SetSessionField(std::string &page, const std::string &id) {
+  size_t field = page.find("name='PHPSESSID'");
+  if (field == std::string::npos)
+    return;
+  size_t value = page.find("value='", field);
+  if (value == std::string::npos)
+    return;
+  value += 7;
+  size_t end = page.find('\'', value);
+  if (end != std::string::npos)
+    page.replace(value, end - value, id);
+}
+
+// ============ SYNTHETIC TABLES ============
+// Same markup as corpus/gen_corpus.js. Every flight keeps its key; its
+// status fields change at a fetch when a hash of (config, flight, fetch)
+// falls under the change percentage, and stay as they are otherwise.
+
+static const char *AIRLINES[] = {"PK", "QR", "EK", "TK", "EY", "SV", "GF",
+                                 "WY", "FZ", "G9", "PA", "ER", "9P"};
+static const char *CITIES[] = {"Dubai",    "Doha",     "Jeddah", "Riyadh",
+                               "Istanbul", "Karachi",  "Lahore", "Muscat",
+                               "Skardu",   "Peshawar", "London", "Multan"};
+static const char *DEP_STATUS[] = {"Scheduled", "Check-in Open", "Boarding",
+                                   "Gate Closed", "Departed", "Delayed"};
+static const char *ARR_STATUS[] = {"Expected", "On Time", "Delayed", "Landed",
+                                   "Baggage Delivered"};
+static const char *REMARKS[] = {"", "Final Call", "Go To Gate", "New Time",
+                                "Cancelled"};
+#define COUNT(a) (sizeof(a) / sizeof(a[0]))
+
+struct SyntheticConfig {
+  const char *name;
+  int flightsNum; // share of the flight count, in quarters
+  int firstMinute;
+  bool arrival;
+};
+
+static const SyntheticConfig SYNTHETIC_CONFIGS[] = {
+    {"departure_int", 4, 0, false},
+    {"departure_dom", 3, 3, false},
+    {"arrival_int", 4, 1, true},
+    {"arrival_dom", 3, 4, true},
+};
+
+static uint32_t Mix(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+  uint32_t h = 0x9E3779B9u ^ a;
+  for (uint32_t v : {b, c, d}) {
+    h ^= v + 0x7F4A7C15u + (h << 6) + (h >> 2);
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+  }
+  return h;
+}
+
+static uint32_t ConfigSeed(const std::string &name) {
+  uint32_t hash = 2166136261u;
+  for (char c : name)
+    hash = (hash ^ (uint8_t)c) * 16777619u;
+  return hash;
+}
+
+// Fetch at which the flight's status fields last changed
+static int LastChange(uint32_t config, int flight, int generation) {
+  for (int g = generation; g > 0; g--) {
+    if ((int)(Mix(config, flight, g, 0) % 100) < syntheticChange)
+      return g;
+  }
+  return 0;
+}
+
+static std::string Iso(int minutes) {
+  char text[32]; // 19 for the minutes a synthetic table uses
+  int day = minutes / 1440;
+  snprintf(text, sizeof(text), "2026-%s-%02d %02d:%02d:00",
+           day == 0 ? "01" : "02", day == 0 ? 31 : day, (minutes / 60) % 24,
+           minutes % 60);
+  return text;
+}
+
+static void Cell(std::string &row, const char *field, const std::string &value) {
+  std::string upper = field;
+  for (char &c : upper)
+    c = toupper(c);
+  row += "      <td class='c_";
+  row += field;
+  row += "' title='Field: ";
+  row += field;
+  row += " (" + upper + ")' nowrap>Value: " + value + "</td>\n";
+}
+
+struct SyntheticFlight {
+  int minute;
+  std::string flnr;
+  std::string city;
+};
+
+static SyntheticFlight MakeFlight(const SyntheticConfig &config, int i) {
+  SyntheticFlight flight;
+  flight.minute = config.firstMinute + 7 * (i + 1);
+  uint32_t seed = Mix(ConfigSeed(config.name), i, 0, 1);
+  char flnr[16];
+  snprintf(flnr, sizeof(flnr), "%s %u", AIRLINES[seed % COUNT(AIRLINES)],
+           100 + (seed >> 8) % 900);
+  flight.flnr = flnr;
+  flight.city = CITIES[(seed >> 4) % COUNT(CITIES)];
+  return flight;
+}
+
+static std::string FlightRow(const SyntheticConfig &config, int i,
+                             int generation) {
+  SyntheticFlight flight = MakeFlight(config, i);
+  uint32_t seed = ConfigSeed(config.name);
+  uint32_t state = Mix(seed, i, LastChange(seed, i, generation), 2);
+  std::string row;
+  Cell(row, "stm", Iso(flight.minute));
+  Cell(row, "flnr", flight.flnr);
+  Cell(row, "city_lu", flight.city);
+  Cell(row, "ect", state % 5 == 0 ? Iso(flight.minute + state % 60) : "");
+  Cell(row, "prem_lu", REMARKS[(state >> 3) % COUNT(REMARKS)]);
+  if (config.arrival) {
+    Cell(row, "blt1", std::to_string(1 + (state >> 7) % 8));
+    Cell(row, "fsta_lu", ARR_STATUS[(state >> 11) % COUNT(ARR_STATUS)]);
+  } else {
+    Cell(row, "gat1", "A" + std::to_string(1 + (state >> 7) % 12));
+    Cell(row, "fsta_lu", DEP_STATUS[(state >> 11) % COUNT(DEP_STATUS)]);
+    Cell(row, "cro1", "Z" + std::to_string(1 + i % 4));
+  }
+  return row;
+}
+
+// One or two counter rows for the first 40% of international departures
+static void CheckinRows(std::vector<std::string> &rows, int generation) {
+  const SyntheticConfig &departures = SYNTHETIC_CONFIGS[0];
+  uint32_t seed = ConfigSeed("checkin");
+  for (int i = 0; i < syntheticFlights * 2 / 5; i++) {
+    SyntheticFlight flight = MakeFlight(departures, i);
+    uint32_t state = Mix(seed, i, LastChange(seed, i, generation), 2);
+    for (int counter = 0; counter <= i % 2; counter++) {
+      std::string row;
+      Cell(row, "stm", Iso(flight.minute));
+      Cell(row, "flnr", flight.flnr);
+      Cell(row, "city_lu", flight.city);
+      Cell(row, "ckco", std::to_string(10 + 3 * i + counter));
+      Cell(row, "crem", (state >> counter) & 1 ? "Business" : "Economy");
+      Cell(row, "crem_lu", (state >> (4 + counter)) & 3 ? "Open" : "Closed");
+      Cell(row, "crow", std::string(1, 'A' + (state >> 8) % 6));
+      Cell(row, "cro1", "Z" + std::to_string(1 + (10 + 3 * i + counter) % 4));
+      rows.push_back(row);
+    }
+  }
+}
+
+static bool SyntheticRows(const std::string &config, int generation,
+                          std::vector<std::string> &rows) {
+  if (config == "checkin") {
+    CheckinRows(rows, generation);
+    return true;
+  }
+  for (const SyntheticConfig &entry : SYNTHETIC_CONFIGS) {
+    if (config != entry.name)
+      continue;
+    int count = syntheticFlights * entry.flightsNum / 4;
+    for (int i = 0; i < count; i++)
+      rows.push_back(FlightRow(entry, i, generation));
+    return true;
+  }
+  return false;
+}
+
+static bool SyntheticPage(const std::string &config, int page,
+                          std::string &out) {
+  std::vector<std::string> rows;
+  if (!SyntheticRows(config, generations[config], rows))
+    return false;
+  int count = rows.size();
+  int pageCount = count ? (count + REPLAY_ROWS_PER_PAGE - 1) /
+                              REPLAY_ROWS_PER_PAGE
+                        : 1;
+  if (page > pageCount)
+    return false;
+  out = "<!DOCTYPE html>\n<html>\n<head><meta charset='utf-8'><title>"
+        "WebDavis</title></head>\n<body>\n<form method='post' "
+        "action='index.php' name='main'>\n  <input type='hidden' "
+        "name='PHPSESSID' value=''>\n  <div class='pager'>Page: " +
+        std::to_string(page) + " from " + std::to_string(pageCount) + " (" +
+        std::to_string(count) + " rows)</div>\n  <table class='grid' "
+        "cellspacing='0'>\n";
+  int first = (page - 1) * REPLAY_ROWS_PER_PAGE;
+  for (int i = first; i < count && i < first + REPLAY_ROWS_PER_PAGE; i++) {
+    out += "    <tr class='row_" + std::to_string(i % 2) + "'>\n";
+    out += rows[i];
+    out += "    </tr>\n";
+  }
+  out += "  </table>\n  <input type='submit' name='n' value='>'>\n</form>\n"
+         "</body>\n</html>\n";
+  return true;
+}
+
+// ============ INDEX.PHP ============
+bool Replay_Init(const String &pagesDir) {
+  pages.clear();
+  synthetic = false;
+  DIR *dir = opendir(pagesDir.c_str());
+  if (!dir)
+    return false;
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() < 6 || name.compare(name.size() - 5, 5, ".html") != 0)
+      continue;
+    String data;
+    if (ReadFile(std::string(pagesDir.c_str()) + "/" + name, data))
+      pages[name] = data;
+  }
+  closedir(dir);
+  return !pages.empty();
+}
+
+void Replay_InitSynthetic(int flights, int changePercent) {
+  pages.clear();
+  generations.clear();
+  synthetic = true;
+  syntheticFlights = flights;
+  syntheticChange = changePercent;
+}
+
+void Replay_SetOptions(const ReplayOptions &replayOptions) {
+  options = replayOptions;
+}
+
+static std::string NewSessionId() {
+  char id[32];
+  snprintf(id, sizeof(id), "host%020lu", ++sessionCounter);
+  return id;
+}
+
+static ReplaySession *FindSession(const std::string &id) {
+  auto it = sessions.find(id);
+  if (it == sessions.end())
+    return nullptr;
+  if (options.sessionIdleMs &&
+      millis() - it->second.usedAt > options.sessionIdleMs) {
+    sessions.erase(it);
+    return nullptr;
+  }
+  return &it->second;
+}
+
+int Replay_Handler(const String &method, const String &url, const String &body,
+                   String &response) {
+  (void)url;
+  if (method == "GET") {
+    std::string id = NewSessionId();
+    sessions[id] = {"", 0, 0, millis()};
+    stats.sessions++;
+    const String *session = FindPage("session.html");
+    std::string page =
+        session ? session->c_str()
+                : "<form method='post'>\n<input type='hidden' "
+                  "name='PHPSESSID' value=''>\n</form>\n";
+    SetSessionField(page, id);
+    response = String(page.c_str(), page.size());
+    return 200;
+  }
+
+  std::string id = FormValue(body, "PHPSESSID").c_str();
+  ReplaySession *session = FindSession(id);
+  if (!session) {
+    // index.php starts over without the form: no session, no rows
+    stats.expired++;
+    response = "<!DOCTYPE html>\n<html>\n<body>\n<div class='error'>Session "
+               "expired</div>\n</body>\n</html>\n";
+    return 200;
+  }
+  session->usedAt = millis();
+
+  String config = FormValue(body, "configs");
+  if (config.length() > 0) {
+    session->config = ConfigBaseName(config).c_str();
+    session->page = 1;
+    if (synthetic)
+      generations[session->config]++; // the board moved on since last time
+  } else {
+    session->page++;
+  }
+
+  std::string page;
+  String name = String(session->config.c_str()) + "." +
+                String(session->page) + ".html";
+  const String *recorded = synthetic ? nullptr : FindPage(name);
+  if (recorded) {
+    page = recorded->c_str();
+  } else if (!synthetic || !SyntheticPage(session->config, session->page, page)) {
+    // Terminate the page loop in Fetch() instead of spinning on a gap
+    fprintf(stderr, "replay: missing %s\n", name.c_str());
+    stats.missing++;
+    page = "<div>Page: " + std::to_string(session->page) + " from " +
+           std::to_string(session->page) + " (0 rows)</div>\n";
+  }
+  stats.pages++;
+
+  // A rotated id replaces the old one, which is gone from then on
+  if (options.rotateEvery && ++session->served >= options.rotateEvery) {
+    ReplaySession moved = *session;
+    moved.served = 0;
+    sessions.erase(id);
+    id = NewSessionId();
+    sessions[id] = moved;
+    stats.rotations++;
+  }
+  SetSessionField(page, id);
+  response = String(page.c_str(), page.size());
+  return 200;
+}
+
+ReplayStats Replay_GetStats() { return stats; }
+
+ReplayConfigStats Replay_GetConfigStats(const String &config) {
+  ReplayConfigStats stats = {0, 0, 0};
+  String base = ConfigBaseName(config);
+  for (int page = 1;; page++) {
+    const String *data = FindPage(base + "." + String(page) + ".html");
+    if (!data)
+      break;
+    stats.pages++;
+    stats.bytes += data->length();
+    for (const char *p = data->c_str(); (p = strstr(p, "<tr class='row_"));
+         p++)
+      stats.rows++;
+  }
+  return stats;
+}
+
+const String *Replay_GetPage(const String &config, int page) {
+  return FindPage(ConfigBaseName(config) + "." + String(page) + ".html");
+}
@@ -0,0 +1,52 @@
+// Host harness: replays recorded WebDavis index.php responses through the
+// HTTPClient shim. Pages are loaded into memory once so that timing runs
+// measure the firmware's parsing, not disk reads.
+//
+// Like index.php, the replay keeps sessions: a GET hands out a PHPSESSID,
+// every POST must carry a live one, and each session has its own place in
+// its config. Every page is served with the session's current id in the
+// hidden field, so rotation and expiry can be exercised. Instead of a
+// recorded directory the tables can be synthetic, changing a little with
+// every fetch of a config.
+
+#ifndef HOST_REPLAY_H
+#define HOST_REPLAY_H
+
+#include "Arduino.h"
+
+#define REPLAY_ROWS_PER_PAGE 20
+#define REPLAY_SESSION_IDLE_MS 1440000 // PHP's default session lifetime
+
+struct ReplayConfigStats {
+  int pages;
+  int rows;
+  unsigned long bytes;
+};
+
+struct ReplayOptions {
+  int rotateEvery;             // pages per session id, 0 = never rotate
+  unsigned long sessionIdleMs; // unused sessions expire, 0 = never
+};
+
+struct ReplayStats {
+  unsigned long sessions; // handed out by GET
+  unsigned long rotations;
+  unsigned long expired; // POSTs with an unknown or expired session
+  unsigned long pages;
+  unsigned long missing; // pages past the recorded ones
+};
+
+bool Replay_Init(const String &pagesDir);
+// Synthetic tables: `flights` international departures (the other configs
+// scale from it); every fetch of a config changes changePercent of its rows
+void Replay_InitSynthetic(int flights, int changePercent);
+void Replay_SetOptions(const ReplayOptions &options);
+int Replay_Handler(const String &method, const String &url, const String &body,
+                   String &response);
+ReplayStats Replay_GetStats();
+// "configs/FREE/departure_int.cfg" or "departure_int"; recorded pages only
+ReplayConfigStats Replay_GetConfigStats(const String &config);
+// Recorded body of one page (1-based), nullptr past the last page
+const String *Replay_GetPage(const String &config, int page);
+
+#endif
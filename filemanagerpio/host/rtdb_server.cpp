@@ -0,0 +1,80 @@
+// Host tool: standalone Firebase RTDB stand-in
+// Serves the in-memory RTDB of rtdb_stub.cpp over plain HTTP until
+// interrupted, for wfs_host -R or curl:
+//
+//   wfs_rtdb [-P port] [-a] [-s latency_ms] [-E fail_every]
+//            [-L lose_every] [-q]
+//
+//   curl -X PATCH -d '{"a/b":1}' http://127.0.0.1:9000/flights.json
+//   curl http://127.0.0.1:9000/.json          # the whole tree
+//   curl http://127.0.0.1:9000/.stats         # request counts
+//
+// Each request is logged unless -q is given.
+
+#include "HostTransport.h"
+#include "rtdb_stub.h"
+#include "webdavis_stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static bool quiet = false;
+
+static int LoggedHandler(const String &method, const String &url,
+                         const String &body, String &response) {
+  int code = RtdbStub_Handler(method, url, body, response);
+  if (!quiet) {
+    const RtdbStubRequest *request =
+        RtdbStub_GetRequest(RtdbStub_RequestCount() - 1);
+    fprintf(stderr, "%s %s, %u bytes, %d location(s) -> %d\n",
+            method.c_str(), url.c_str(), body.length(),
+            request ? request->locations : 0, code);
+  }
+  return code;
+}
+
+int main(int argc, char **argv) {
+  StubOptions stubOptions = {9000, false, 0, 0};
+  RtdbStubOptions rtdbOptions = {};
+  int opt;
+  while ((opt = getopt(argc, argv, "P:as:E:L:qh")) != -1) {
+    switch (opt) {
+    case 'P':
+      stubOptions.port = atoi(optarg);
+      break;
+    case 'a':
+      stubOptions.anyAddress = true;
+      break;
+    case 's':
+      stubOptions.latencyMs = strtoul(optarg, nullptr, 10);
+      break;
+    case 'E':
+      rtdbOptions.failEvery = atoi(optarg);
+      break;
+    case 'L':
+      rtdbOptions.loseEvery = atoi(optarg);
+      break;
+    case 'q':
+      quiet = true;
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-P port] [-a] [-s latency_ms] [-E fail_every] "
+              "[-L lose_every] [-q]\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  RtdbStub_SetOptions(rtdbOptions);
+  int port = Stub_Start(LoggedHandler, stubOptions);
+  if (port < 0) {
+    perror("cannot listen");
+    return 1;
+  }
+  fprintf(stderr, "RTDB stand-in on %s:%d\n",
+          stubOptions.anyAddress ? "0.0.0.0" : "127.0.0.1", port);
+  for (;;)
+    pause();
+}
@@ -0,0 +1,423 @@
+// Host harness: Firebase RTDB stand-in (JSON tree behind a REST handler)
+
+#include "rtdb_stub.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+struct RtdbNode {
+  enum Type { NUL, LEAF, OBJECT } type = NUL;
+  std::string leaf; // raw JSON: string with its quotes, number, true/false
+  std::map<std::string, RtdbNode> children;
+};
+
+static RtdbNode root;
+static RtdbStubOptions options = {};
+static RtdbStubStats stats = {};
+static std::vector<RtdbStubRequest> requests;
+static unsigned long writeCount = 0; // PUT/PATCH/DELETE, for fault injection
+static std::string remoteHost;
+static uint16_t remotePort = 0;
+static int remoteSocket = -1;
+
+// ============ JSON ============
+struct JsonReader {
+  const char *p;
+  const char *end;
+};
+
+static void SkipSpace(JsonReader &in) {
+  while (in.p < in.end && (*in.p == ' ' || *in.p == '\t' || *in.p == '\n' ||
+                           *in.p == '\r'))
+    in.p++;
+}
+
+// Raw string token, quotes included; its unescaped text in `text`
+static bool ReadString(JsonReader &in, std::string &raw, std::string &text) {
+  const char *start = in.p++;
+  text.clear();
+  while (in.p < in.end && *in.p != '"') {
+    if (*in.p == '\\') {
+      if (++in.p == in.end)
+        return false;
+      switch (*in.p) {
+      case 'n':
+        text += '\n';
+        break;
+      case 't':
+        text += '\t';
+        break;
+      case 'r':
+        text += '\r';
+        break;
+      case 'b':
+        text += '\b';
+        break;
+      case 'f':
+        text += '\f';
+        break;
+      case 'u': // kept escaped; keys in this tree are ASCII
+        text += "\\u";
+        break;
+      default:
+        text += *in.p;
+      }
+    } else {
+      text += *in.p;
+    }
+    in.p++;
+  }
+  if (in.p == in.end)
+    return false;
+  in.p++;
+  raw.assign(start, in.p - start);
+  return true;
+}
+
+static bool ReadValue(JsonReader &in, RtdbNode &node, int depth) {
+  SkipSpace(in);
+  if (in.p == in.end || depth > 32)
+    return false;
+  node = RtdbNode();
+  std::string raw, text;
+  if (*in.p == '{' || *in.p == '[') {
+    // Arrays are stored as objects with keys 0..n-1, as on the RTDB
+    bool array = *in.p == '[';
+    char close = array ? ']' : '}';
+    node.type = RtdbNode::OBJECT;
+    in.p++;
+    SkipSpace(in);
+    for (int index = 0; in.p < in.end && *in.p != close; index++) {
+      if (index > 0) {
+        if (*in.p != ',')
+          return false;
+        in.p++;
+        SkipSpace(in);
+      }
+      std::string key = std::to_string(index);
+      if (!array) {
+        if (in.p == in.end || *in.p != '"' || !ReadString(in, raw, key))
+          return false;
+        SkipSpace(in);
+        if (in.p == in.end || *in.p != ':')
+          return false;
+        in.p++;
+      }
+      if (!ReadValue(in, node.children[key], depth + 1))
+        return false;
+      SkipSpace(in);
+    }
+    if (in.p == in.end)
+      return false;
+    in.p++;
+    return true;
+  }
+  if (*in.p == '"') {
+    if (!ReadString(in, raw, text))
+      return false;
+    node.type = RtdbNode::LEAF;
+    node.leaf = raw;
+    return true;
+  }
+  const char *start = in.p;
+  while (in.p < in.end && (isalnum((unsigned char)*in.p) || *in.p == '-' ||
+                           *in.p == '+' || *in.p == '.'))
+    in.p++;
+  std::string token(start, in.p - start);
+  if (token == "null")
+    return true;
+  if (token.empty())
+    return false;
+  if (token != "true" && token != "false") {
+    char *parsed;
+    strtod(token.c_str(), &parsed);
+    if (*parsed != '\0')
+      return false;
+  }
+  node.type = RtdbNode::LEAF;
+  node.leaf = token;
+  return true;
+}
+
+static bool Parse(const String &body, RtdbNode &node) {
+  JsonReader in = {body.c_str(), body.c_str() + body.length()};
+  if (!ReadValue(in, node, 0))
+    return false;
+  SkipSpace(in);
+  return in.p == in.end;
+}
+
+static void WriteKey(std::string &out, const std::string &key) {
+  out += '"';
+  for (char c : key) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  out += '"';
+}
+
+// Keys in order; an object keyed 0..n-1 comes back as an array
+static void Write(const RtdbNode &node, std::string &out) {
+  if (node.type == RtdbNode::NUL) {
+    out += "null";
+    return;
+  }
+  if (node.type == RtdbNode::LEAF) {
+    out += node.leaf;
+    return;
+  }
+  bool array = true;
+  for (size_t i = 0; i < node.children.size() && array; i++)
+    array = node.children.count(std::to_string(i)) > 0;
+  out += array ? '[' : '{';
+  bool first = true;
+  if (array) {
+    for (size_t i = 0; i < node.children.size(); i++) {
+      if (!first)
+        out += ',';
+      first = false;
+      Write(node.children.at(std::to_string(i)), out);
+    }
+  } else {
+    for (const auto &child : node.children) {
+      if (!first)
+        out += ',';
+      first = false;
+      WriteKey(out, child.first);
+      out += ':';
+      Write(child.second, out);
+    }
+  }
+  out += array ? ']' : '}';
+}
+
+// ============ TREE ============
+static bool ValidKey(const std::string &key) {
+  return !key.empty() && key.find_first_of(".$#[]/") == std::string::npos;
+}
+
+static bool ValidTree(const RtdbNode &node) {
+  for (const auto &child : node.children)
+    if (!ValidKey(child.first) || !ValidTree(child.second))
+      return false;
+  return true;
+}
+
+// Nulls and empty objects are not stored; true when nothing is left
+static bool Prune(RtdbNode &node) {
+  if (node.type != RtdbNode::OBJECT)
+    return node.type == RtdbNode::NUL;
+  for (auto it = node.children.begin(); it != node.children.end();)
+    it = Prune(it->second) ? node.children.erase(it) : std::next(it);
+  return node.children.empty();
+}
+
+static bool SplitPath(const std::string &path, std::vector<std::string> &out) {
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t slash = path.find('/', start);
+    if (slash == std::string::npos)
+      slash = path.size();
+    std::string segment = path.substr(start, slash - start);
+    if (!segment.empty()) {
+      if (!ValidKey(segment))
+        return false;
+      out.push_back(segment);
+    }
+    start = slash + 1;
+  }
+  return true;
+}
+
+// Replaces the node at path; false when it is empty afterwards
+static bool SetAt(RtdbNode &node, const std::vector<std::string> &path,
+                  size_t depth, const RtdbNode &value) {
+  if (depth == path.size()) {
+    node = value;
+    return !Prune(node);
+  }
+  if (node.type != RtdbNode::OBJECT) {
+    node = RtdbNode();
+    node.type = RtdbNode::OBJECT;
+  }
+  if (!SetAt(node.children[path[depth]], path, depth + 1, value))
+    node.children.erase(path[depth]);
+  return !node.children.empty();
+}
+
+static void Set(const std::vector<std::string> &path, const RtdbNode &value) {
+  if (!SetAt(root, path, 0, value))
+    root = RtdbNode();
+}
+
+static const RtdbNode *Find(const std::vector<std::string> &path) {
+  const RtdbNode *node = &root;
+  for (const std::string &segment : path) {
+    if (node->type != RtdbNode::OBJECT)
+      return nullptr;
+    auto it = node->children.find(segment);
+    if (it == node->children.end())
+      return nullptr;
+    node = &it->second;
+  }
+  return node;
+}
+
+// ============ REST ============
+static String StatsJson() {
+  char text[320];
+  snprintf(text, sizeof(text),
+           "{\"requests\":%lu,\"gets\":%lu,\"puts\":%lu,\"patches\":%lu,"
+           "\"deletes\":%lu,\"locations\":%lu,\"bytes\":%lu,\"failed\":%lu,"
+           "\"lost\":%lu,\"rejected\":%lu}",
+           stats.requests, stats.gets, stats.puts, stats.patches,
+           stats.deletes, stats.locations, stats.bytes, stats.failed,
+           stats.lost, stats.rejected);
+  return text;
+}
+
+static int Reject(RtdbStubRequest &record, const char *message,
+                  String &response) {
+  stats.rejected++;
+  record.code = 400;
+  response = String("{\"error\":\"") + message + "\"}";
+  return 400;
+}
+
+void RtdbStub_SetOptions(const RtdbStubOptions &newOptions) {
+  options = newOptions;
+}
+
+int RtdbStub_Handler(const String &method, const String &url,
+                     const String &body, String &response) {
+  // http://host/a/b.json?auth=... -> a/b
+  std::string path = url.c_str();
+  size_t scheme = path.find("://");
+  if (scheme != std::string::npos)
+    path.erase(0, path.find('/', scheme + 3));
+  path = path.substr(0, path.find('?'));
+  if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0)
+    path.erase(path.size() - 5);
+
+  if (method == "GET" && path == "/.stats") {
+    response = StatsJson(); // host only; "." is not a valid key
+    return 200;
+  }
+
+  stats.requests++;
+  requests.push_back({method, path.c_str(), body.length(), 0, 200});
+  RtdbStubRequest &record = requests.back();
+  stats.bytes += body.length();
+
+  std::vector<std::string> segments;
+  if (!SplitPath(path, segments))
+    return Reject(record, "Invalid path", response);
+
+  if (method == "GET") {
+    stats.gets++;
+    response = RtdbStub_Get(path.c_str());
+    return 200;
+  }
+
+  bool write = method == "PUT" || method == "PATCH" || method == "DELETE";
+  if (!write) {
+    record.code = 405;
+    response = "{\"error\":\"Method not allowed\"}";
+    return 405;
+  }
+  writeCount++;
+  if (options.failEvery > 0 && writeCount % options.failEvery == 0) {
+    stats.failed++;
+    record.code = 503;
+    response = "{\"error\":\"host injected failure\"}";
+    return 503;
+  }
+
+  RtdbNode value;
+  if (method == "DELETE") {
+    stats.deletes++;
+    record.locations = 1;
+    Set(segments, value);
+  } else if (!Parse(body, value)) {
+    return Reject(record, "Invalid data; couldn't parse JSON", response);
+  } else if (method == "PUT") {
+    if (!ValidTree(value))
+      return Reject(record, "Invalid key", response);
+    stats.puts++;
+    record.locations = 1;
+    Set(segments, value);
+  } else {
+    // Each key is a path below the target, all checked before any is set
+    if (value.type != RtdbNode::OBJECT)
+      return Reject(record, "Invalid data; PATCH needs an object", response);
+    std::vector<std::vector<std::string>> targets;
+    for (const auto &child : value.children) {
+      targets.push_back(segments);
+      if (!SplitPath(child.first, targets.back()) ||
+          targets.back().size() == segments.size() ||
+          !ValidTree(child.second))
+        return Reject(record, "Invalid key", response);
+    }
+    stats.patches++;
+    record.locations = targets.size();
+    size_t i = 0;
+    for (const auto &child : value.children)
+      Set(targets[i++], child.second);
+  }
+  stats.locations += record.locations;
+  response = method == "DELETE" ? String("null") : body;
+
+  if (options.loseEvery > 0 && writeCount % options.loseEvery == 0) {
+    stats.lost++;
+    record.code = -1;
+    return -1;
+  }
+  return 200;
+}
+
+void RtdbStub_SetRemote(const char *host, uint16_t port) {
+  remoteHost = host;
+  remotePort = port;
+}
+
+int RtdbStub_RemoteHandler(const String &method, const String &url,
+                           const String &body, String &response) {
+  // Only the path goes over; the stand-in ignores the database host
+  std::string target = url.c_str();
+  size_t scheme = target.find("://");
+  if (scheme != std::string::npos)
+    target.erase(0, target.find('/', scheme + 3));
+  return HostHttp_Exchange(remoteSocket, remoteHost.c_str(), remotePort,
+                           method.c_str(), target.c_str(), body, response);
+}
+
+String RtdbStub_Get(const String &path) {
+  std::vector<std::string> segments;
+  const RtdbNode *node =
+      SplitPath(path.c_str(), segments) ? Find(segments) : nullptr;
+  std::string out;
+  if (node)
+    Write(*node, out);
+  else
+    out = "null";
+  return String(out.c_str(), out.size());
+}
+
+void RtdbStub_Clear() {
+  root = RtdbNode();
+  requests.clear();
+  stats = {};
+  writeCount = 0;
+}
+
+RtdbStubStats RtdbStub_GetStats() { return stats; }
+
+unsigned long RtdbStub_RequestCount() { return requests.size(); }
+
+const RtdbStubRequest *RtdbStub_GetRequest(unsigned long index) {
+  return index < requests.size() ? &requests[index] : nullptr;
+}
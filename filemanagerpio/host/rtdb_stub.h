@@ -0,0 +1,60 @@
+// Host harness: Firebase Realtime Database stand-in
+// An in-memory JSON tree behind the RTDB REST interface: GET, PUT, PATCH
+// (multi-location keys included) and DELETE on "/path.json". PUT replaces
+// the node, PATCH replaces each listed child, null deletes and empty nodes
+// vanish, as on the real database. Keys with . $ # [ ] are rejected with a
+// 400 like Firebase does.
+//
+// Every request is recorded, so a run can be checked by the tree it leaves
+// and by its round trips. Faults: every Nth write answered with a 503, and
+// every Nth write applied but its answer lost (the client times out and
+// sends it again). A handler may also forward to a stand-in in another
+// process (wfs_rtdb) over HTTP.
+
+#ifndef HOST_RTDB_STUB_H
+#define HOST_RTDB_STUB_H
+
+#include "HostTransport.h"
+
+struct RtdbStubOptions {
+  int failEvery; // every Nth write gets a 503, 0 = never
+  int loseEvery; // every Nth write is applied but not answered, 0 = never
+};
+
+struct RtdbStubStats {
+  unsigned long requests;
+  unsigned long gets;
+  unsigned long puts;
+  unsigned long patches;
+  unsigned long deletes;
+  unsigned long locations; // paths written: one per PUT, one per PATCH key
+  unsigned long bytes;     // request bodies
+  unsigned long failed;    // injected 503s
+  unsigned long lost;      // applied, answer dropped
+  unsigned long rejected;  // 400: bad JSON, bad key
+};
+
+struct RtdbStubRequest {
+  String method;
+  String path;
+  unsigned long bytes;
+  int locations;
+  int code; // -1: answer lost
+};
+
+void RtdbStub_SetOptions(const RtdbStubOptions &options);
+// REST handler for the FirebaseClient shim or the TCP stub server; returns
+// -1 when the answer is to be lost
+int RtdbStub_Handler(const String &method, const String &url,
+                     const String &body, String &response);
+// Forwards to a stand-in at host:port instead (RtdbStub_RemoteHandler)
+void RtdbStub_SetRemote(const char *host, uint16_t port);
+int RtdbStub_RemoteHandler(const String &method, const String &url,
+                           const String &body, String &response);
+String RtdbStub_Get(const String &path); // canonical JSON, "null" if absent
+void RtdbStub_Clear();
+RtdbStubStats RtdbStub_GetStats();
+unsigned long RtdbStub_RequestCount();
+const RtdbStubRequest *RtdbStub_GetRequest(unsigned long index);
+
+#endif
@@ -0,0 +1,169 @@
+// Host shim: Arduino core implementation
+
+#include "Arduino.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ============ PRINT / STREAM ============
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++))
+      n++;
+    else
+      break;
+  }
+  return n;
+}
+
+size_t Print::printf(const char *format, ...) {
+  char loc_buf[64];
+  va_list arg;
+  va_start(arg, format);
+  int len = vsnprintf(loc_buf, sizeof(loc_buf), format, arg);
+  va_end(arg);
+  if (len < 0)
+    return 0;
+  if (len < (int)sizeof(loc_buf))
+    return write((const uint8_t *)loc_buf, len);
+
+  char *temp = (char *)malloc(len + 1);
+  if (!temp)
+    return 0;
+  va_start(arg, format);
+  vsnprintf(temp, len + 1, format, arg);
+  va_end(arg);
+  len = write((const uint8_t *)temp, len);
+  free(temp);
+  return len;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0)
+      break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String ret;
+  int c = read();
+  while (c >= 0) {
+    ret += (char)c;
+    c = read();
+  }
+  return ret;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String ret;
+  int c = read();
+  while (c >= 0 && c != terminator) {
+    ret += (char)c;
+    c = read();
+  }
+  return ret;
+}
+
+// ============ SERIAL ============
+static bool serialMuted = false;
+static unsigned long long serialBytes = 0;
+
+void HostSerial_SetMuted(bool muted) { serialMuted = muted; }
+
+unsigned long long HostSerial_BytesWritten() { return serialBytes; }
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  serialBytes += size;
+  if (!serialMuted)
+    fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+// ============ TIMING ============
+static const auto clockStart = std::chrono::steady_clock::now();
+static unsigned long long virtualMicros = 0;
+
+static unsigned long long ElapsedMicros() {
+  auto now = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                               clockStart)
+             .count() +
+         virtualMicros;
+}
+
+unsigned long millis() { return (unsigned long)(ElapsedMicros() / 1000); }
+
+unsigned long micros() { return (unsigned long)ElapsedMicros(); }
+
+unsigned long long HostClock_Micros() { return ElapsedMicros(); }
+
+void HostClock_AdvanceTo(unsigned long long micros) {
+  unsigned long long now = ElapsedMicros();
+  if (micros > now)
+    virtualMicros += micros - now;
+}
+
+// Other tasks run while this one sleeps (see FreeRTOS.h)
+void delay(unsigned long ms) {
+  HostTask_SleepUntil(ElapsedMicros() + (unsigned long long)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) { virtualMicros += us; }
+
+void yield() { std::this_thread::yield(); }
+
+// ============ RANDOM ============
+static std::mt19937 randomEngine(
+    (unsigned)std::chrono::steady_clock::now().time_since_epoch().count());
+
+long random(long howbig) {
+  if (howbig <= 0)
+    return 0;
+  return std::uniform_int_distribution<long>(0, howbig - 1)(randomEngine);
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig)
+    return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) { randomEngine.seed(seed); }
+
+// ============ ESP ============
+uint32_t EspClass::getFreeHeap() { return 256 * 1024; }
+
+uint32_t EspClass::getMinFreeHeap() { return 256 * 1024; }
+
+uint32_t EspClass::getMaxAllocHeap() { return 128 * 1024; }
+
+uint32_t EspClass::getHeapSize() { return 320 * 1024; }
+
+uint32_t EspClass::getPsramSize() { return 8 * 1024 * 1024; }
+
+uint32_t EspClass::getFreePsram() { return 8 * 1024 * 1024; }
+
+esp_reset_reason_t esp_reset_reason() { return ESP_RST_POWERON; }
+
+void EspClass::restart() {
+  fflush(stdout);
+  fprintf(stderr, "ESP.restart() called on host, exiting\n");
+  exit(3);
+}
+
+void *ps_malloc(size_t size) { return malloc(size); }
+
+void *ps_calloc(size_t n, size_t size) { return calloc(n, size); }
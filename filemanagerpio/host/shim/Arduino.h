@@ -0,0 +1,150 @@
+// Host shim: Arduino core
+// Just enough of the ESP32 Arduino core (String, Print/Stream, Serial, ESP,
+// timing) to compile the scraper and sync sources as a Linux process.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "FreeRTOS.h"
+#include "WString.h"
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ============ PRINT / STREAM ============
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) {
+    return str ? write((const uint8_t *)str, strlen(str)) : 0;
+  }
+  size_t write(const char *buffer, size_t size) {
+    return write((const uint8_t *)buffer, size);
+  }
+  virtual void flush() {}
+
+  size_t printf(const char *format, ...)
+      __attribute__((format(printf, 2, 3)));
+  size_t print(const String &s) { return write(s.c_str(), s.length()); }
+  size_t print(const char *s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n, int base = 10) { return print(String(n, base)); }
+  size_t print(unsigned int n, int base = 10) {
+    return print(String(n, base));
+  }
+  size_t print(long n, int base = 10) { return print(String(n, base)); }
+  size_t print(unsigned long n, int base = 10) {
+    return print(String(n, base));
+  }
+  size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(const T &value) {
+    size_t n = print(value);
+    return n + println();
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    return readBytes((char *)buffer, length);
+  }
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  String readString();
+  String readStringUntil(char terminator);
+
+protected:
+  unsigned long _timeout = 1000;
+};
+
+// ============ SERIAL ============
+// Output goes to stdout unless muted; bytes are always counted so benchmarks
+// can report how much serial traffic a code path would have produced.
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  operator bool() const { return true; }
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+void HostSerial_SetMuted(bool muted);
+unsigned long long HostSerial_BytesWritten();
+
+// ============ TIMING ============
+// delay() advances a virtual clock instead of sleeping, so the 8.5 s page
+// pacing and Firebase wait loops cost no wall time on the host. millis() and
+// micros() are wall time plus the accumulated virtual offset.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+unsigned long long HostClock_Micros();
+void HostClock_AdvanceTo(unsigned long long micros); // never moves back
+
+// ============ RANDOM ============
+// Arduino's random(max) / random(min, max); seeded from the wall clock
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+// ============ RESET REASON ============
+// esp_system.h; the host always starts from power-on
+typedef enum {
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO
+} esp_reset_reason_t;
+esp_reset_reason_t esp_reset_reason();
+
+// ============ ESP ============
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getHeapSize();
+  uint32_t getPsramSize();
+  uint32_t getFreePsram();
+  void restart();
+};
+extern EspClass ESP;
+
+void *ps_malloc(size_t size);
+void *ps_calloc(size_t n, size_t size);
+
+#endif
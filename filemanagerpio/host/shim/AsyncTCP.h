@@ -0,0 +1,9 @@
+// Host shim: AsyncTCP is only pulled in by Global.h
+#ifndef HOST_ASYNCTCP_H
+#define HOST_ASYNCTCP_H
+
+#include "Arduino.h"
+
+class AsyncClient {};
+
+#endif
@@ -0,0 +1,18 @@
+// Host shim: ESPAsyncWebServer
+// The web server is not part of the host build; these types only exist so
+// Global.h's handler declarations compile.
+
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+#include "AsyncTCP.h"
+
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) { (void)port; }
+};
+
+#endif
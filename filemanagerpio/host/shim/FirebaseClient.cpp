@@ -0,0 +1,164 @@
+// Host shim: FirebaseClient implementation
+
+#include "FirebaseClient.h"
+
+#include <deque>
+#include <vector>
+
+struct PendingWrite {
+  HostFirebaseWrite write;
+  AsyncResultCallback cb;
+  String uid;
+  unsigned long dueMs;
+  AsyncClientClass *client;
+};
+
+static std::deque<PendingWrite> pending;
+static std::vector<HostFirebaseWrite> writes;
+static unsigned long latencyMs = 50;
+static unsigned long jitterMs = 0;
+static unsigned long bandwidth = 0;   // bytes per second, 0 = unlimited
+static unsigned long linkFreeAtMs = 0; // upstream link busy until
+static unsigned long maxInFlight = 0;
+static unsigned int failEvery = 0;
+static bool online = true;
+static unsigned long requestCount = 0;
+static unsigned long taskCounter = 0;
+static HostHttpHandler handler = nullptr;
+
+void HostFirebase_SetLatency(unsigned long ms) { latencyMs = ms; }
+
+void HostFirebase_SetJitter(unsigned long ms) { jitterMs = ms; }
+
+void HostFirebase_SetBandwidth(unsigned long bytesPerSecond) {
+  bandwidth = bytesPerSecond;
+}
+
+void HostFirebase_SetFailEvery(unsigned int n) { failEvery = n; }
+
+void HostFirebase_SetOnline(bool isOnline) { online = isOnline; }
+
+void HostFirebase_SetHandler(HostHttpHandler newHandler) {
+  handler = newHandler;
+}
+
+unsigned long HostFirebase_MaxInFlight() { return maxInFlight; }
+
+unsigned long HostFirebase_WriteCount() { return writes.size(); }
+
+const HostFirebaseWrite *HostFirebase_GetWrite(unsigned long index) {
+  return index < writes.size() ? &writes[index] : nullptr;
+}
+
+void HostFirebase_ClearWrites() { writes.clear(); }
+
+void initializeApp(AsyncClientClass &aClient, FirebaseApp &app,
+                   user_auth_data &auth, AsyncResultCallback cb,
+                   const String &uid) {
+  (void)aClient;
+  (void)auth;
+  app.isReady = true;
+  if (cb) {
+    AsyncResult result;
+    result.taskUid = uid;
+    cb(result);
+  }
+}
+
+bool FirebaseApp::ready() const { return isReady && online; }
+
+void FirebaseApp::loop() {
+  if (database)
+    database->loop();
+}
+
+void RealtimeDatabase::enqueue(AsyncClientClass &aClient, const char *method,
+                               const String &path, const char *body,
+                               AsyncResultCallback cb, const String &uid) {
+  PendingWrite p;
+  p.write.method = method;
+  p.write.path = path;
+  p.write.body = body;
+  p.cb = cb;
+  p.uid = uid.length() > 0 ? uid : "task_" + String(++taskCounter);
+  p.client = &aClient;
+
+  // The client starts once its previous request is answered; the body then
+  // shares the link with whatever the other clients are sending
+  unsigned long now = millis();
+  unsigned long start = max(now, aClient.busyUntilMs);
+  unsigned long sendMs =
+      bandwidth ? (unsigned long)((strlen(body) + path.length() + 200) *
+                                  1000ULL / bandwidth)
+                : 0;
+  linkFreeAtMs = max(start, linkFreeAtMs) + sendMs;
+  p.dueMs = linkFreeAtMs + latencyMs + (jitterMs ? random(jitterMs + 1) : 0);
+  aClient.busyUntilMs = p.dueMs;
+
+  pending.push_back(p);
+  maxInFlight = max(maxInFlight, (unsigned long)pending.size());
+}
+
+void RealtimeDatabase::loop() {
+  // Answer everything that is due, earliest first
+  for (;;) {
+    auto next = pending.end();
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+      if (it->client->stuckUid.length() == 0 &&
+          (long)(millis() - it->dueMs) >= 0 &&
+          (next == pending.end() || (long)(it->dueMs - next->dueMs) < 0))
+        next = it;
+    }
+    if (next == pending.end())
+      break;
+    PendingWrite p = *next;
+    pending.erase(next);
+
+    AsyncResult result;
+    result.taskUid = p.uid;
+    requestCount++;
+    if (!online) {
+      result.err = FirebaseError(-1, "host offline");
+    } else if (failEvery > 0 && requestCount % failEvery == 0) {
+      result.err = FirebaseError(-118, "host injected failure");
+    } else {
+      String response = p.write.body;
+      int code = handler ? handler(p.write.method, p.write.path + ".json",
+                                   p.write.body, response)
+                         : 200;
+      if (code < 0) {
+        p.client->stuckUid = p.uid; // the caller times out
+        continue;
+      }
+      if (code == 200) {
+        writes.push_back(p.write);
+        result.data = response;
+        result.hasPayload = true;
+      } else {
+        result.err = FirebaseError(code, "HTTP " + String(code));
+      }
+    }
+    if (p.cb)
+      p.cb(result);
+  }
+}
+
+void AsyncClientClass::stopAsync(const String &uid) {
+  for (auto it = pending.begin(); it != pending.end();) {
+    if (it->client == this && it->uid == uid)
+      it = pending.erase(it);
+    else
+      ++it;
+  }
+  if (stuckUid != uid)
+    return;
+  // New connection: what is still queued goes out from now on
+  stuckUid = "";
+  busyUntilMs = millis();
+  for (PendingWrite &p : pending) {
+    if (p.client != this)
+      continue;
+    p.dueMs = max(p.dueMs, millis()) + latencyMs;
+    busyUntilMs = max(busyUntilMs, p.dueMs);
+  }
+}
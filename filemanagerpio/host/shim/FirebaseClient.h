@@ -0,0 +1,157 @@
+// Host shim: FirebaseClient
+// A stand-in Realtime Database that accepts set/update calls, answers them
+// through the normal AsyncResult callback after a configurable latency, and
+// keeps a log of every write for the host harness to inspect. Like the real
+// library, each AsyncClientClass works through its requests one at a time;
+// separate clients overlap, sharing one link of configurable bandwidth.
+// With a handler installed each request is answered by it, RTDB REST style
+// (see rtdb_stub.h); without one every write succeeds. A request the
+// handler drops leaves its client stuck, as a real connection that never
+// gets its response is, until stopAsync() cancels it.
+
+#ifndef HOST_FIREBASECLIENT_H
+#define HOST_FIREBASECLIENT_H
+
+#include "HostTransport.h"
+#include "WiFiClientSecure.h"
+
+class AsyncResult;
+typedef void (*AsyncResultCallback)(AsyncResult &aResult);
+
+class FirebaseError {
+public:
+  FirebaseError(int code = 0, const String &message = "")
+      : errCode(code), errMessage(message) {}
+  int code() const { return errCode; }
+  String message() const { return errMessage; }
+
+private:
+  int errCode;
+  String errMessage;
+};
+
+class AsyncResult {
+public:
+  bool isError() const { return err.code() != 0; }
+  bool available() const { return hasPayload; }
+  bool isEvent() const { return false; }
+  bool isDebug() const { return false; }
+  const FirebaseError &error() const { return err; }
+  const char *c_str() const { return data.c_str(); }
+  String payload() const { return data; }
+  String uid() const { return taskUid; }
+
+  // Filled in by the shim before the callback runs.
+  String taskUid;
+  String data;
+  bool hasPayload = false;
+  FirebaseError err;
+};
+
+class object_t {
+public:
+  object_t() {}
+  object_t(const String &o) : json(o) {}
+  const char *c_str() const { return json.c_str(); }
+  size_t printTo(Print &p) const { return p.print(json); }
+
+private:
+  String json;
+};
+
+struct user_auth_data {};
+
+class UserAuth {
+public:
+  UserAuth(const String &apiKey, const String &email, const String &password,
+           size_t expire = 3600) {
+    (void)apiKey;
+    (void)email;
+    (void)password;
+    (void)expire;
+  }
+  user_auth_data &get() { return data; }
+
+private:
+  user_auth_data data;
+};
+
+inline user_auth_data &getAuth(UserAuth &auth) { return auth.get(); }
+
+class AsyncClientClass {
+public:
+  explicit AsyncClientClass(WiFiClientSecure &client) { (void)client; }
+
+  // Drops the request with this uid; if the client was waiting for its
+  // answer, the connection is closed and the next request starts afresh
+  void stopAsync(const String &uid);
+
+  // Host side: when this client's last queued request completes
+  unsigned long busyUntilMs = 0;
+  // Host side: a request whose answer never came; the client waits for it
+  // and answers nothing else until it is stopped
+  String stuckUid;
+};
+
+class RealtimeDatabase {
+public:
+  void url(const String &databaseUrl) { dbUrl = databaseUrl; }
+  String url() const { return dbUrl; }
+
+  template <typename T>
+  void set(AsyncClientClass &aClient, const String &path, const T &value,
+           AsyncResultCallback cb, const String &uid = "") {
+    enqueue(aClient, "PUT", path, value.c_str(), cb, uid);
+  }
+
+  template <typename T>
+  void update(AsyncClientClass &aClient, const String &path, const T &value,
+              AsyncResultCallback cb, const String &uid = "") {
+    enqueue(aClient, "PATCH", path, value.c_str(), cb, uid);
+  }
+
+  void loop();
+
+private:
+  void enqueue(AsyncClientClass &aClient, const char *method,
+               const String &path, const char *body, AsyncResultCallback cb,
+               const String &uid);
+  String dbUrl;
+};
+
+class FirebaseApp {
+public:
+  void loop();
+  bool ready() const;
+  template <typename T> void getApp(T &service) { database = &service; }
+
+  // Set by initializeApp().
+  bool isReady = false;
+  RealtimeDatabase *database = nullptr;
+};
+
+void initializeApp(AsyncClientClass &aClient, FirebaseApp &app,
+                   user_auth_data &auth, AsyncResultCallback cb,
+                   const String &uid = "");
+
+// ============ HOST CONTROLS ============
+struct HostFirebaseWrite {
+  String method; // "PUT" or "PATCH"
+  String path;
+  String body;
+};
+
+void HostFirebase_SetLatency(unsigned long ms);
+void HostFirebase_SetJitter(unsigned long ms); // extra 0..ms per request
+void HostFirebase_SetBandwidth(unsigned long bytesPerSecond); // 0 = unlimited
+void HostFirebase_SetFailEvery(unsigned int n); // 0 = never fail
+void HostFirebase_SetOnline(bool online); // offline: not ready, writes fail
+// Answers each due request ("PATCH", "/path.json", body); a status other
+// than 200 fails it with that code, a negative one leaves it unanswered
+void HostFirebase_SetHandler(HostHttpHandler handler);
+unsigned long HostFirebase_WriteCount();
+const HostFirebaseWrite *HostFirebase_GetWrite(unsigned long index);
+void HostFirebase_ClearWrites();
+unsigned long HostFirebase_MaxInFlight(); // most requests outstanding at once
+
+#endif
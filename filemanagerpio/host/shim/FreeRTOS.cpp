@@ -0,0 +1,183 @@
+// Host shim: FreeRTOS implementation (see FreeRTOS.h)
+
+#include "Arduino.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define WAKE_NEVER 0xFFFFFFFFFFFFFFFFULL
+
+struct HostTask {
+  TaskFunction_t code;
+  void *parameters;
+  std::string name;
+  BaseType_t core;
+  bool running;
+  unsigned long long wakeAt; // WAKE_NEVER: waiting for a notification
+  unsigned long long order;  // FIFO among equal wake-up times
+  uint32_t notifications;
+};
+
+struct HostSemaphore {
+  HostTask *owner;
+  int depth;
+};
+
+// Never destroyed: tasks that never end (a watchdog) still wait on them
+// while the process exits
+static std::mutex &schedulerLock = *new std::mutex;
+static std::condition_variable &schedulerChanged = *new std::condition_variable;
+static std::vector<HostTask *> tasks;
+static HostTask loopTask = {nullptr, nullptr, "loopTask", ARDUINO_RUNNING_CORE,
+                            true, 0, 0, 0};
+static thread_local HostTask *currentTask = nullptr;
+static unsigned long long wakeOrder = 0;
+
+static HostTask *Current() {
+  if (!currentTask) {
+    currentTask = &loopTask;
+    tasks.push_back(&loopTask);
+  }
+  return currentTask;
+}
+
+// Runs the task that wakes up first, once nobody holds the CPU
+static void Dispatch() {
+  HostTask *next = nullptr;
+  for (HostTask *task : tasks) {
+    if (task->running)
+      return;
+    if (task->wakeAt != WAKE_NEVER &&
+        (!next || task->wakeAt < next->wakeAt ||
+         (task->wakeAt == next->wakeAt && task->order < next->order)))
+      next = task;
+  }
+  if (!next) {
+    fprintf(stderr, "host scheduler: every task waits for a notification\n");
+    abort();
+  }
+  HostClock_AdvanceTo(next->wakeAt);
+  next->running = true;
+  schedulerChanged.notify_all();
+}
+
+static void Yield(std::unique_lock<std::mutex> &lock, HostTask *self,
+                  unsigned long long wakeAt) {
+  self->running = false;
+  self->wakeAt = wakeAt;
+  self->order = ++wakeOrder;
+  Dispatch();
+  schedulerChanged.wait(lock, [self] { return self->running; });
+}
+
+void HostTask_SleepUntil(unsigned long long micros) {
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  Yield(lock, Current(), micros);
+}
+
+static void RunTask(HostTask *task) {
+  currentTask = task;
+  {
+    std::unique_lock<std::mutex> lock(schedulerLock);
+    schedulerChanged.wait(lock, [task] { return task->running; });
+  }
+  task->code(task->parameters);
+
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  tasks.erase(std::find(tasks.begin(), tasks.end(), task));
+  task->running = false;
+  Dispatch();
+  delete task;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name,
+                                   uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t core) {
+  (void)stackDepth;
+  (void)priority;
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  Current();
+  HostTask *task = new HostTask{code,        parameters,   name, core, false,
+                                HostClock_Micros(), ++wakeOrder, 0};
+  tasks.push_back(task);
+  if (created)
+    *created = task;
+  std::thread(RunTask, task).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Only self-deletion is used; RunTask() cleans up when the code returns
+  (void)task;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  return Current();
+}
+
+BaseType_t xPortGetCoreID() {
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  return Current()->core;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  task->notifications++;
+  // A waiting task becomes ready now; it runs once this one yields
+  if (!task->running)
+    task->wakeAt = std::min(task->wakeAt, HostClock_Micros());
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  HostTask *self = Current();
+  if (self->notifications == 0 && ticksToWait > 0) {
+    Yield(lock, self,
+          ticksToWait == portMAX_DELAY
+              ? WAKE_NEVER
+              : HostClock_Micros() + ticksToWait * portTICK_PERIOD_MS * 1000ULL);
+  }
+  uint32_t count = self->notifications;
+  if (count)
+    self->notifications = clearOnExit ? 0 : count - 1;
+  return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return new HostSemaphore{nullptr, 0};
+}
+
+// The holder may be sleeping, so waiting means letting other tasks run
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t wait) {
+  for (TickType_t waited = 0;; waited++) {
+    {
+      std::unique_lock<std::mutex> lock(schedulerLock);
+      HostTask *self = Current();
+      if (!mutex->owner || mutex->owner == self) {
+        mutex->owner = self;
+        mutex->depth++;
+        return pdTRUE;
+      }
+    }
+    if (wait != portMAX_DELAY && waited >= wait)
+      return pdFALSE;
+    delay(1);
+  }
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+  std::unique_lock<std::mutex> lock(schedulerLock);
+  if (mutex->owner != Current())
+    return pdFALSE;
+  if (--mutex->depth == 0)
+    mutex->owner = nullptr;
+  return pdTRUE;
+}
@@ -0,0 +1,50 @@
+// Host shim: FreeRTOS tasks, task notifications and recursive mutexes
+// Tasks are std::threads, but only one of them runs at a time: a task keeps
+// the CPU until it calls delay(), waits for a notification or ends, and then
+// the task with the earliest wake-up time runs next, with the virtual clock
+// moved forward to that time. Two tasks that each sleep through their own
+// delays therefore overlap in device time exactly as they would on two
+// cores, and runs stay deterministic.
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct HostTask *TaskHandle_t;
+typedef struct HostSemaphore *SemaphoreHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define ARDUINO_RUNNING_CORE 1 // loop() task
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name,
+                                   uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task); // NULL: the task returns right after
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t wait);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex);
+
+// Used by delay(): sleep until the virtual clock reaches `micros`
+void HostTask_SleepUntil(unsigned long long micros);
+
+#endif
@@ -0,0 +1,362 @@
+// Host shim: HTTPClient and WiFi implementation
+
+#include "HTTPClient.h"
+#include "WiFiClientSecure.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+WiFiClass WiFi;
+
+static HostHttpHandler httpHandler = nullptr;
+static unsigned long httpRequests = 0;
+static unsigned long httpLatency = 0; // ms
+static unsigned long httpJitter = 0;  // ms
+static int httpFailEvery = 0;
+static String endpointHost = ""; // socket transport when set
+static uint16_t endpointPort = 0;
+static unsigned long httpConnections = 0;
+
+void HostHttp_SetHandler(HostHttpHandler handler) { httpHandler = handler; }
+
+unsigned long HostHttp_RequestCount() { return httpRequests; }
+
+void HostHttp_SetLatency(unsigned long ms) { httpLatency = ms; }
+
+void HostHttp_SetJitter(unsigned long ms) { httpJitter = ms; }
+
+void HostHttp_SetFailEvery(int every) { httpFailEvery = every; }
+
+// ============ WIFICLIENT ============
+int WiFiClient::connect(const char *host, uint16_t port) {
+  (void)host;
+  (void)port;
+  open = true;
+  rx = "";
+  rxPos = 0;
+  tx = "";
+  return 1;
+}
+
+void WiFiClient::stop() {
+  if (sock >= 0)
+    close(sock);
+  sock = -1;
+  open = false;
+  rx = "";
+  rxPos = 0;
+}
+
+uint8_t WiFiClient::connected() {
+  return sock >= 0 || open || available() > 0;
+}
+
+void WiFiClient::hostLoad(String payload, bool closed) {
+  rx = std::move(payload);
+  rxPos = 0;
+  open = !closed;
+  if (closed && sock >= 0) {
+    close(sock);
+    sock = -1;
+  }
+}
+
+int WiFiClient::available() { return rx.length() - rxPos; }
+
+int WiFiClient::read() {
+  if (rxPos >= rx.length())
+    return -1;
+  return (uint8_t)rx[rxPos++];
+}
+
+int WiFiClient::peek() {
+  if (rxPos >= rx.length())
+    return -1;
+  return (uint8_t)rx[rxPos];
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+  return readBytes((char *)buf, size);
+}
+
+size_t WiFiClient::readBytes(char *buffer, size_t length) {
+  size_t n = rx.length() - rxPos;
+  if (n > length)
+    n = length;
+  memcpy(buffer, rx.c_str() + rxPos, n);
+  rxPos += n;
+  return n;
+}
+
+size_t WiFiClient::write(uint8_t c) { return write(&c, 1); }
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+  if (!open)
+    return 0;
+  tx.concat((const char *)buf, size);
+  return size;
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port) {
+  WiFiClient::connect(host, port);
+  hostLoad("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{}");
+  return 1;
+}
+
+// ============ HTTPCLIENT ============
+// ============ SOCKET TRANSPORT ============
+void HostHttp_SetEndpoint(const char *host, uint16_t port) {
+  endpointHost = host;
+  endpointPort = port;
+}
+
+unsigned long HostHttp_ConnectionCount() { return httpConnections; }
+
+static bool SendAll(int fd, const char *data, size_t length) {
+  while (length > 0) {
+    ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+    if (n <= 0)
+      return false;
+    data += n;
+    length -= n;
+  }
+  return true;
+}
+
+// The server may have closed an idle keep-alive connection
+static bool PeerClosed(int fd) {
+  char c;
+  ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+static int Connect(const char *host, uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, host, &addr.sin_addr);
+  if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  httpConnections++;
+  return fd;
+}
+
+// Status line and headers, then exactly Content-Length bytes (or everything
+// up to the close when there is none). A body cut short by the close is
+// kept; length stays what the server announced.
+static int ReadResponse(int fd, String &body, bool &keepAlive, long &length) {
+  std::string data;
+  char buf[4096];
+  size_t headerEnd;
+  while ((headerEnd = data.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      return HTTPC_ERROR_CONNECTION_LOST;
+    data.append(buf, n);
+  }
+  std::string head = data.substr(0, headerEnd);
+  data.erase(0, headerEnd + 4);
+
+  int code = 0;
+  if (sscanf(head.c_str(), "HTTP/1.%*d %d", &code) != 1)
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  keepAlive = head.compare(0, 8, "HTTP/1.1") == 0;
+  length = -1;
+  size_t pos = 0;
+  while ((pos = head.find("\r\n", pos)) != std::string::npos) {
+    pos += 2;
+    const char *line = head.c_str() + pos;
+    if (strncasecmp(line, "Content-Length:", 15) == 0)
+      length = strtol(line + 15, nullptr, 10);
+    else if (strncasecmp(line, "Connection:", 11) == 0)
+      keepAlive = strncasecmp(line + 11 + strspn(line + 11, " "), "close",
+                              5) != 0;
+  }
+
+  while (length < 0 || (long)data.size() < length) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      break;
+    data.append(buf, n);
+  }
+  if (length < 0 || (long)data.size() < length)
+    keepAlive = false; // the close ended the body
+  body = String(data.c_str(), data.size());
+  return code;
+}
+
+static int SocketRequest(WiFiClient &stream, const String &url,
+                         const char *type, const String &headers,
+                         const String &payload, bool reuse, String &body,
+                         bool &keepAlive, long &length) {
+  // http://host[:port]/path -> Host header and request target
+  int hostStart = url.indexOf("://") + 3;
+  int pathStart = url.indexOf('/', hostStart);
+  String host = url.substring(hostStart, pathStart < 0 ? url.length()
+                                                       : pathStart);
+  String path = pathStart < 0 ? String("/") : url.substring(pathStart);
+
+  String request = String(type) + " " + path + " HTTP/1.1\r\nHost: " + host +
+                   "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: " +
+                   (reuse ? "keep-alive" : "close") + "\r\n" + headers;
+  if (strcmp(type, "GET") != 0)
+    request += "Content-Length: " + String(payload.length()) + "\r\n";
+  request += "\r\n" + payload;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = stream.hostSocket() >= 0;
+    if (reused && PeerClosed(stream.hostSocket()))
+      stream.stop();
+    if (stream.hostSocket() < 0) {
+      int fd = Connect(endpointHost.c_str(), endpointPort);
+      if (fd < 0)
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+      stream.hostSetSocket(fd);
+      reused = false;
+    }
+    int code = SendAll(stream.hostSocket(), request.c_str(), request.length())
+                   ? ReadResponse(stream.hostSocket(), body, keepAlive, length)
+                   : HTTPC_ERROR_SEND_HEADER_FAILED;
+    if (code > 0 || !reused)
+      return code;
+    stream.stop(); // stale keep-alive connection: once more on a new one
+  }
+  return HTTPC_ERROR_CONNECTION_LOST;
+}
+
+int HostHttp_Exchange(int &fd, const char *host, uint16_t port,
+                      const char *method, const char *target,
+                      const String &body, String &response) {
+  if (fd >= 0 && PeerClosed(fd)) {
+    close(fd);
+    fd = -1;
+  }
+  if (fd < 0 && (fd = Connect(host, port)) < 0)
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  String request = String(method) + " " + target + " HTTP/1.1\r\nHost: " +
+                   host + "\r\nConnection: keep-alive\r\nContent-Length: " +
+                   String(body.length()) + "\r\n\r\n" + body;
+  bool keepAlive = false;
+  long length = -1;
+  // Not sent again on failure: the server may have applied it
+  int code = SendAll(fd, request.c_str(), request.length())
+                 ? ReadResponse(fd, response, keepAlive, length)
+                 : HTTPC_ERROR_SEND_HEADER_FAILED;
+  if (code > 0 && length > (long)response.length())
+    code = HTTPC_ERROR_CONNECTION_LOST;
+  if (code <= 0 || !keepAlive) {
+    close(fd);
+    fd = -1;
+  }
+  return code;
+}
+
+// ============ HTTPCLIENT ============
+bool HTTPClient::begin(const String &requestUrl) {
+  url = requestUrl;
+  external = nullptr;
+  headers = "";
+  return true;
+}
+
+bool HTTPClient::begin(WiFiClient &stream, const String &requestUrl) {
+  url = requestUrl;
+  external = &stream;
+  headers = "";
+  return true;
+}
+
+// Like the ESP32 client: the connection stays open for the next begin()
+// only when reuse was asked for and the server agreed
+void HTTPClient::end() {
+  if (!(reuse && canReuse))
+    stream()->stop();
+  size = -1;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+  headers += name + ": " + value + "\r\n";
+}
+
+int HTTPClient::GET() { return sendRequest("GET", ""); }
+
+int HTTPClient::POST(const String &payload) {
+  return sendRequest("POST", payload);
+}
+
+int HTTPClient::sendRequest(const char *type, const String &payload) {
+  if (!httpHandler && endpointHost.length() == 0)
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  httpRequests++;
+  delay(httpLatency + (httpJitter ? random(httpJitter + 1) : 0));
+  // An empty 500 before the handler sees it, so the replay does not advance
+  if (httpFailEvery > 0 && httpRequests % httpFailEvery == 0) {
+    size = 0;
+    stream()->hostLoad("");
+    return HTTP_CODE_INTERNAL_SERVER_ERROR;
+  }
+
+  String body;
+  int code;
+  long length = -1;
+  if (endpointHost.length() > 0) {
+    code = SocketRequest(*stream(), url, type, headers, payload, reuse, body,
+                         canReuse, length);
+  } else {
+    code = httpHandler(type, url, payload, body);
+    canReuse = true; // nothing to connect to; keep-alive is free
+  }
+  if (code > 0) {
+    // Cut off: the firmware sees the announced size and a closed connection
+    bool cut = length > (long)body.length();
+    size = cut ? length : body.length();
+    stream()->hostLoad(std::move(body), cut);
+  } else {
+    canReuse = false;
+  }
+  return code;
+}
+
+bool HTTPClient::connected() { return stream()->connected(); }
+
+String HTTPClient::getString() { return stream()->readString(); }
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+  case HTTPC_ERROR_CONNECTION_REFUSED:
+    return "connection refused";
+  case HTTPC_ERROR_SEND_HEADER_FAILED:
+    return "send header failed";
+  case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+    return "send payload failed";
+  case HTTPC_ERROR_NOT_CONNECTED:
+    return "not connected";
+  case HTTPC_ERROR_CONNECTION_LOST:
+    return "connection lost";
+  case HTTPC_ERROR_NO_STREAM:
+    return "no stream";
+  case HTTPC_ERROR_NO_HTTP_SERVER:
+    return "no HTTP server";
+  case HTTPC_ERROR_TOO_LESS_RAM:
+    return "too less ram";
+  case HTTPC_ERROR_ENCODING:
+    return "Transfer-Encoding not supported";
+  case HTTPC_ERROR_STREAM_WRITE:
+    return "Stream write error";
+  case HTTPC_ERROR_READ_TIMEOUT:
+    return "read Timeout";
+  default:
+    return String();
+  }
+}
@@ -0,0 +1,60 @@
+// Host shim: HTTPClient
+
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include "HostTransport.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+} t_http_codes;
+
+class HTTPClient {
+public:
+  bool begin(const String &url);
+  bool begin(WiFiClient &client, const String &url);
+  void end();
+  void setTimeout(uint16_t timeout) { (void)timeout; }
+  void setReuse(bool reuse) { this->reuse = reuse; }
+  void addHeader(const String &name, const String &value);
+
+  int GET();
+  int POST(const String &payload);
+  int sendRequest(const char *type, const String &payload);
+
+  bool connected();
+  WiFiClient *getStreamPtr() { return stream(); }
+  WiFiClient &getStream() { return *stream(); }
+  String getString();
+  int getSize() { return size; }
+
+  static String errorToString(int error);
+
+private:
+  WiFiClient *stream() { return external ? external : &client; }
+
+  String url;
+  WiFiClient client;
+  WiFiClient *external = nullptr; // begin(client, url)
+  String headers;                 // addHeader() lines for this request
+  int size = -1;
+  bool reuse = false;
+  bool canReuse = false; // the server keeps the connection
+};
+
+#endif
@@ -0,0 +1,70 @@
+// Host shim: heap accounting (glibc)
+
+#include "HostHeap.h"
+
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+static HostHeapStats stats = {0, 0, 0, 0};
+
+static void Track(void *ptr) {
+  if (!ptr)
+    return;
+  stats.allocations++;
+  stats.liveBytes += malloc_usable_size(ptr);
+  if (stats.liveBytes > stats.peakBytes)
+    stats.peakBytes = stats.liveBytes;
+}
+
+static void Untrack(void *ptr) {
+  if (!ptr)
+    return;
+  stats.frees++;
+  stats.liveBytes -= malloc_usable_size(ptr);
+}
+
+extern "C" void *malloc(size_t size) {
+  void *ptr = __libc_malloc(size);
+  Track(ptr);
+  return ptr;
+}
+
+extern "C" void *calloc(size_t n, size_t size) {
+  void *ptr = __libc_calloc(n, size);
+  Track(ptr);
+  return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+  if (!ptr)
+    return malloc(size);
+  if (size == 0) {
+    Untrack(ptr);
+    __libc_free(ptr);
+    return nullptr;
+  }
+  // Growing a String counts as an allocation, like it would on the device
+  size_t before = malloc_usable_size(ptr);
+  void *moved = __libc_realloc(ptr, size);
+  if (moved) {
+    stats.liveBytes -= before;
+    stats.frees++;
+    Track(moved);
+  }
+  return moved;
+}
+
+extern "C" void free(void *ptr) {
+  Untrack(ptr);
+  __libc_free(ptr);
+}
+
+HostHeapStats HostHeap_GetStats() { return stats; }
+
+void HostHeap_ResetPeak() { stats.peakBytes = stats.liveBytes; }
@@ -0,0 +1,21 @@
+// Host shim: heap accounting
+// malloc/calloc/realloc/free are wrapped (see HostHeap.cpp) so every heap
+// allocation made by the firmware code, String and ArduinoJson included, is
+// counted. ESP.getFreeHeap() reports against these numbers too.
+
+#ifndef HOST_HEAP_H
+#define HOST_HEAP_H
+
+#include <cstddef>
+
+struct HostHeapStats {
+  unsigned long long allocations; // malloc/calloc + realloc that moved or grew
+  unsigned long long frees;
+  size_t liveBytes;
+  size_t peakBytes;
+};
+
+HostHeapStats HostHeap_GetStats();
+void HostHeap_ResetPeak();
+
+#endif
@@ -0,0 +1,33 @@
+// Host shim: HTTP transport hook
+// HTTPClient hands every request to the installed handler instead of the
+// network. The handler fills the response body and returns the HTTP status
+// (or a negative HTTPC_ERROR_* code), which lets the host harness replay
+// recorded WebDavis pages straight through the firmware's parsing path.
+//
+// With an endpoint set, plain HTTP requests go over real TCP to that address
+// instead (whatever host the URL names), speaking HTTP/1.1 with keep-alive.
+// That is how the harness talks to the local WebDavis stub server.
+// HostHttp_Exchange() is the same transport for other host-side clients.
+
+#ifndef HOST_TRANSPORT_H
+#define HOST_TRANSPORT_H
+
+#include "Arduino.h"
+
+typedef int (*HostHttpHandler)(const String &method, const String &url,
+                               const String &body, String &response);
+
+void HostHttp_SetHandler(HostHttpHandler handler);
+unsigned long HostHttp_RequestCount();
+void HostHttp_SetLatency(unsigned long ms); // every request, virtual time
+void HostHttp_SetJitter(unsigned long ms);  // extra 0..ms per request
+void HostHttp_SetFailEvery(int every);      // every Nth request gets a 500
+void HostHttp_SetEndpoint(const char *host, uint16_t port);
+unsigned long HostHttp_ConnectionCount(); // TCP connections opened
+// One plain HTTP/1.1 request to host:port on a kept-alive socket (fd, -1 =
+// none yet); the status, or a negative HTTPC_ERROR_* with fd closed
+int HostHttp_Exchange(int &fd, const char *host, uint16_t port,
+                      const char *method, const char *target,
+                      const String &body, String &response);
+
+#endif
@@ -0,0 +1,112 @@
+// Host shim: LittleFS implementation
+
+#include "LittleFS.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+LittleFSFS LittleFS;
+
+static String rootDir = "out/littlefs";
+
+#define HOST_LITTLEFS_TOTAL_BYTES 0x170000 // littlefs partition in partitions.csv
+
+void HostLittleFS_SetRoot(const String &dir) { rootDir = dir; }
+
+static String HostPath(const String &path) {
+  mkdir(rootDir.c_str(), 0755);
+  return path.startsWith("/") ? rootDir + path : rootDir + "/" + path;
+}
+
+// ============ FILE ============
+File::File(FILE *f, const String &path) : fp(f, fclose), path(path) {}
+
+size_t File::size() const {
+  if (!fp)
+    return 0;
+  struct stat st;
+  fflush(fp.get());
+  return fstat(fileno(fp.get()), &st) == 0 ? st.st_size : 0;
+}
+
+size_t File::position() const { return fp ? ftell(fp.get()) : 0; }
+
+bool File::seek(size_t pos) {
+  return fp && fseek(fp.get(), pos, SEEK_SET) == 0;
+}
+
+void File::close() { fp.reset(); }
+
+int File::available() {
+  return fp ? (int)(size() - position()) : 0;
+}
+
+int File::read() {
+  return fp ? fgetc(fp.get()) : -1;
+}
+
+int File::peek() {
+  if (!fp)
+    return -1;
+  int c = fgetc(fp.get());
+  if (c >= 0)
+    ungetc(c, fp.get());
+  return c;
+}
+
+size_t File::read(uint8_t *buf, size_t size) {
+  return fp ? fread(buf, 1, size, fp.get()) : 0;
+}
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+size_t File::write(const uint8_t *buf, size_t size) {
+  return fp ? fwrite(buf, 1, size, fp.get()) : 0;
+}
+
+// ============ FILESYSTEM ============
+bool LittleFSFS::begin(bool formatOnFail, const char *basePath,
+                       uint8_t maxOpenFiles, const char *partitionLabel) {
+  (void)formatOnFail;
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  mkdir(rootDir.c_str(), 0755);
+  return true;
+}
+
+File LittleFSFS::open(const String &path, const char *mode) {
+  String fileMode = String(mode) + "b";
+  FILE *f = fopen(HostPath(path).c_str(), fileMode.c_str());
+  return f ? File(f, path) : File();
+}
+
+bool LittleFSFS::exists(const String &path) {
+  struct stat st;
+  return stat(HostPath(path).c_str(), &st) == 0;
+}
+
+bool LittleFSFS::remove(const String &path) {
+  return ::remove(HostPath(path).c_str()) == 0;
+}
+
+bool LittleFSFS::rename(const String &from, const String &to) {
+  return ::rename(HostPath(from).c_str(), HostPath(to).c_str()) == 0;
+}
+
+size_t LittleFSFS::totalBytes() { return HOST_LITTLEFS_TOTAL_BYTES; }
+
+size_t LittleFSFS::usedBytes() {
+  size_t used = 0;
+  DIR *dir = opendir(rootDir.c_str());
+  if (!dir)
+    return 0;
+  while (struct dirent *entry = readdir(dir)) {
+    struct stat st;
+    String path = rootDir + "/" + entry->d_name;
+    if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+      used += st.st_size;
+  }
+  closedir(dir);
+  return used;
+}
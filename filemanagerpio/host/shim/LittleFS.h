@@ -0,0 +1,53 @@
+// Host shim: LittleFS
+// Files live in a directory on the host (HostLittleFS_SetRoot, default
+// "out/littlefs"), so state the firmware persists survives between runs the
+// way it survives ESP.restart() on the device.
+
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "Arduino.h"
+
+#include <memory>
+
+class File : public Stream {
+public:
+  File() {}
+  File(FILE *f, const String &path);
+
+  operator bool() const { return (bool)fp; }
+  size_t size() const;
+  size_t position() const;
+  bool seek(size_t pos);
+  const char *name() const { return path.c_str(); }
+  void close();
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t *buf, size_t size);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+
+private:
+  std::shared_ptr<FILE> fp;
+  String path;
+};
+
+class LittleFSFS {
+public:
+  bool begin(bool formatOnFail = false, const char *basePath = "",
+             uint8_t maxOpenFiles = 10, const char *partitionLabel = nullptr);
+  File open(const String &path, const char *mode = "r");
+  bool exists(const String &path);
+  bool remove(const String &path);
+  bool rename(const String &from, const String &to);
+  size_t totalBytes();
+  size_t usedBytes();
+};
+extern LittleFSFS LittleFS;
+
+void HostLittleFS_SetRoot(const String &dir);
+
+#endif
@@ -0,0 +1,49 @@
+// Host shim: Preferences implementation (see Preferences.h)
+
+#include "Preferences.h"
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+static std::map<std::string, std::vector<uint8_t>> store; // "space/key"
+
+bool Preferences::begin(const char *name, bool readOnly) {
+  space = name;
+  this->readOnly = readOnly;
+  open = true;
+  return true;
+}
+
+void Preferences::end() { open = false; }
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+  uint32_t value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value
+                                                               : defaultValue;
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+  return putBytes(key, &value, sizeof(value));
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  auto it = store.find(space + "/" + key);
+  return open && it != store.end() ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  auto it = store.find(space + "/" + key);
+  if (!open || it == store.end() || it->second.size() > maxLen)
+    return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  if (!open || readOnly)
+    return 0;
+  const uint8_t *bytes = (const uint8_t *)value;
+  store[space + "/" + key].assign(bytes, bytes + len);
+  return len;
+}
@@ -0,0 +1,28 @@
+// Host shim: Preferences (NVS key/value store)
+// Namespaces live in memory for the life of the process, which is one boot.
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+
+#include <string>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end();
+
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+  size_t putUInt(const char *key, uint32_t value);
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t putBytes(const char *key, const void *value, size_t len);
+
+private:
+  std::string space;
+  bool readOnly = true;
+  bool open = false;
+};
+
+#endif
@@ -0,0 +1,2 @@
+// Host shim: Print lives in Arduino.h
+#include "Arduino.h"
@@ -0,0 +1,2 @@
+// Host shim: Stream lives in Arduino.h
+#include "Arduino.h"
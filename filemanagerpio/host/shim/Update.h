@@ -0,0 +1,9 @@
+// Host shim: OTA updates are device-only
+#ifndef HOST_UPDATE_H
+#define HOST_UPDATE_H
+
+#include "Arduino.h"
+
+#define U_FLASH 0
+
+#endif
@@ -0,0 +1,493 @@
+// Host shim: Arduino String implementation
+
+#include "WString.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+static void FormatInteger(char *buf, size_t size, unsigned long long value,
+                          bool negative, unsigned char base) {
+  char tmp[72];
+  int pos = 0;
+  if (base < 2)
+    base = 10;
+  do {
+    unsigned digit = value % base;
+    tmp[pos++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value > 0 && pos < (int)sizeof(tmp) - 1);
+  size_t out = 0;
+  if (negative && out + 1 < size)
+    buf[out++] = '-';
+  while (pos > 0 && out + 1 < size)
+    buf[out++] = tmp[--pos];
+  buf[out] = '\0';
+}
+
+static void FormatSigned(char *buf, size_t size, long long value,
+                         unsigned char base) {
+  if (value < 0 && base == 10) {
+    FormatInteger(buf, size, (unsigned long long)(-(value + 1)) + 1, true,
+                  base);
+  } else {
+    FormatInteger(buf, size, (unsigned long long)value, false, base);
+  }
+}
+
+String::String(const char *cstr) {
+  if (cstr)
+    copy(cstr, strlen(cstr));
+}
+
+String::String(const char *cstr, unsigned int length) {
+  if (cstr)
+    copy(cstr, length);
+}
+
+String::String(const String &value) { *this = value; }
+
+String::String(String &&rval) { move(rval); }
+
+String::String(char c) {
+  char buf[2] = {c, 0};
+  *this = buf;
+}
+
+String::String(unsigned char value, unsigned char base) {
+  char buf[9];
+  FormatInteger(buf, sizeof(buf), value, false, base);
+  *this = buf;
+}
+
+String::String(int value, unsigned char base) {
+  char buf[34];
+  FormatSigned(buf, sizeof(buf), value, base);
+  *this = buf;
+}
+
+String::String(unsigned int value, unsigned char base) {
+  char buf[33];
+  FormatInteger(buf, sizeof(buf), value, false, base);
+  *this = buf;
+}
+
+String::String(long value, unsigned char base) {
+  char buf[66];
+  FormatSigned(buf, sizeof(buf), value, base);
+  *this = buf;
+}
+
+String::String(unsigned long value, unsigned char base) {
+  char buf[66];
+  FormatInteger(buf, sizeof(buf), value, false, base);
+  *this = buf;
+}
+
+String::String(long long value, unsigned char base) {
+  char buf[66];
+  FormatSigned(buf, sizeof(buf), value, base);
+  *this = buf;
+}
+
+String::String(unsigned long long value, unsigned char base) {
+  char buf[66];
+  FormatInteger(buf, sizeof(buf), value, false, base);
+  *this = buf;
+}
+
+String::String(float value, unsigned int decimalPlaces) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, (double)value);
+  *this = buf;
+}
+
+String::String(double value, unsigned int decimalPlaces) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+  *this = buf;
+}
+
+String::~String() { invalidate(); }
+
+void String::invalidate() {
+  free(buffer);
+  buffer = nullptr;
+  capacity = len = 0;
+}
+
+bool String::reserve(unsigned int size) {
+  if (buffer && capacity >= size)
+    return true;
+  if (changeBuffer(size)) {
+    if (len == 0)
+      buffer[0] = 0;
+    return true;
+  }
+  return false;
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+  char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
+  if (!newbuffer)
+    return false;
+  buffer = newbuffer;
+  capacity = maxStrLen;
+  return true;
+}
+
+String &String::copy(const char *cstr, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  len = length;
+  memmove(buffer, cstr, length);
+  buffer[len] = 0;
+  return *this;
+}
+
+void String::move(String &rhs) {
+  if (this != &rhs) {
+    free(buffer);
+    buffer = rhs.buffer;
+    capacity = rhs.capacity;
+    len = rhs.len;
+    rhs.buffer = nullptr;
+    rhs.capacity = rhs.len = 0;
+  }
+}
+
+String &String::operator=(const String &rhs) {
+  if (this == &rhs)
+    return *this;
+  if (rhs.buffer)
+    copy(rhs.buffer, rhs.len);
+  else
+    invalidate();
+  return *this;
+}
+
+String &String::operator=(String &&rval) {
+  move(rval);
+  return *this;
+}
+
+String &String::operator=(const char *cstr) {
+  if (cstr)
+    copy(cstr, strlen(cstr));
+  else
+    invalidate();
+  return *this;
+}
+
+bool String::concat(const String &s) {
+  if (&s == this) {
+    unsigned int oldLen = len;
+    if (!reserve(len * 2))
+      return false;
+    memcpy(buffer + oldLen, buffer, oldLen);
+    len = oldLen * 2;
+    buffer[len] = 0;
+    return true;
+  }
+  return concat(s.c_str(), s.len);
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+  if (!cstr)
+    return false;
+  if (length == 0)
+    return true;
+  unsigned int newlen = len + length;
+  if (!reserve(newlen))
+    return false;
+  memcpy(buffer + len, cstr, length);
+  len = newlen;
+  buffer[len] = 0;
+  return true;
+}
+
+bool String::concat(const char *cstr) {
+  if (!cstr)
+    return false;
+  return concat(cstr, strlen(cstr));
+}
+
+bool String::concat(char c) { return concat(&c, 1); }
+
+bool String::concat(unsigned char num) { return concat(String(num)); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(long long num) { return concat(String(num)); }
+bool String::concat(unsigned long long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+StringSumHelper &operator+(const StringSumHelper &lhs, const String &rhs) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(rhs);
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, const char *cstr) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(cstr);
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, char c) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(c);
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, int num) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, unsigned int num) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, long num) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, unsigned long num) {
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  a.concat(num);
+  return a;
+}
+
+int String::compareTo(const String &s) const {
+  if (!buffer || !s.buffer) {
+    if (s.buffer && s.len > 0)
+      return 0 - *(unsigned char *)s.buffer;
+    if (buffer && len > 0)
+      return *(unsigned char *)buffer;
+    return 0;
+  }
+  return strcmp(buffer, s.buffer);
+}
+
+bool String::equals(const String &s2) const {
+  return len == s2.len && compareTo(s2) == 0;
+}
+
+bool String::equals(const char *cstr) const {
+  if (len == 0)
+    return (cstr == nullptr || *cstr == 0);
+  if (cstr == nullptr)
+    return buffer[0] == 0;
+  return strcmp(buffer, cstr) == 0;
+}
+
+bool String::equalsIgnoreCase(const String &s2) const {
+  if (len != s2.len)
+    return false;
+  for (unsigned int i = 0; i < len; i++) {
+    if (tolower((unsigned char)buffer[i]) !=
+        tolower((unsigned char)s2.buffer[i]))
+      return false;
+  }
+  return true;
+}
+
+bool String::startsWith(const String &s2) const {
+  if (len < s2.len)
+    return false;
+  return startsWith(s2, 0);
+}
+
+bool String::startsWith(const String &s2, unsigned int offset) const {
+  if (offset > len - s2.len || !buffer || !s2.buffer)
+    return false;
+  return strncmp(&buffer[offset], s2.buffer, s2.len) == 0;
+}
+
+bool String::endsWith(const String &s2) const {
+  if (len < s2.len || !buffer || !s2.buffer)
+    return false;
+  return strcmp(&buffer[len - s2.len], s2.buffer) == 0;
+}
+
+char String::charAt(unsigned int loc) const { return operator[](loc); }
+
+void String::setCharAt(unsigned int loc, char c) {
+  if (loc < len)
+    buffer[loc] = c;
+}
+
+char &String::operator[](unsigned int index) {
+  static char dummy_writable_char;
+  if (index >= len || !buffer) {
+    dummy_writable_char = 0;
+    return dummy_writable_char;
+  }
+  return buffer[index];
+}
+
+char String::operator[](unsigned int index) const {
+  if (index >= len || !buffer)
+    return 0;
+  return buffer[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize,
+                      unsigned int index) const {
+  if (!bufsize || !buf)
+    return;
+  if (index >= len) {
+    buf[0] = 0;
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > len - index)
+    n = len - index;
+  memcpy(buf, buffer + index, n);
+  buf[n] = 0;
+}
+
+int String::indexOf(char c) const { return indexOf(c, 0); }
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len)
+    return -1;
+  const char *temp = strchr(buffer + fromIndex, ch);
+  if (temp == nullptr)
+    return -1;
+  return temp - buffer;
+}
+
+int String::indexOf(const String &s2) const { return indexOf(s2, 0); }
+
+int String::indexOf(const String &s2, unsigned int fromIndex) const {
+  if (fromIndex >= len)
+    return -1;
+  const char *found = strstr(buffer + fromIndex, s2.c_str());
+  if (found == nullptr)
+    return -1;
+  return found - buffer;
+}
+
+int String::lastIndexOf(char theChar) const {
+  return lastIndexOf(theChar, len - 1);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len)
+    return -1;
+  for (int i = fromIndex; i >= 0; i--) {
+    if (buffer[i] == ch)
+      return i;
+  }
+  return -1;
+}
+
+int String::lastIndexOf(const String &s2) const {
+  if (s2.len == 0 || s2.len > len)
+    return -1;
+  for (int i = len - s2.len; i >= 0; i--) {
+    if (strncmp(buffer + i, s2.buffer, s2.len) == 0)
+      return i;
+  }
+  return -1;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+  if (left > right) {
+    unsigned int temp = right;
+    right = left;
+    left = temp;
+  }
+  String out;
+  if (left >= len)
+    return out;
+  if (right > len)
+    right = len;
+  out.copy(buffer + left, right - left);
+  return out;
+}
+
+void String::replace(char find, char replace) {
+  if (!buffer)
+    return;
+  for (char *p = buffer; *p; p++) {
+    if (*p == find)
+      *p = replace;
+  }
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (len == 0 || find.len == 0)
+    return;
+  String out;
+  unsigned int i = 0;
+  bool changed = false;
+  while (i < len) {
+    const char *hit = strstr(buffer + i, find.c_str());
+    if (!hit) {
+      if (!changed)
+        return;
+      out.concat(buffer + i, len - i);
+      break;
+    }
+    changed = true;
+    out.concat(buffer + i, hit - (buffer + i));
+    out.concat(replace);
+    i = (hit - buffer) + find.len;
+  }
+  *this = out;
+}
+
+void String::remove(unsigned int index) { remove(index, (unsigned int)-1); }
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= len)
+    return;
+  if (count > len - index)
+    count = len - index;
+  memmove(buffer + index, buffer + index + count, len - index - count);
+  len -= count;
+  buffer[len] = 0;
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len; i++)
+    buffer[i] = tolower((unsigned char)buffer[i]);
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len; i++)
+    buffer[i] = toupper((unsigned char)buffer[i]);
+}
+
+void String::trim() {
+  if (!buffer || len == 0)
+    return;
+  char *begin = buffer;
+  while (isspace((unsigned char)*begin))
+    begin++;
+  char *end = buffer + len - 1;
+  while (isspace((unsigned char)*end) && end >= begin)
+    end--;
+  len = end + 1 - begin;
+  if (begin > buffer)
+    memmove(buffer, begin, len);
+  buffer[len] = 0;
+}
+
+long String::toInt() const { return buffer ? atol(buffer) : 0; }
+
+float String::toFloat() const { return buffer ? (float)atof(buffer) : 0; }
+
+double String::toDouble() const { return buffer ? atof(buffer) : 0; }
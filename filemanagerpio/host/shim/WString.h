@@ -0,0 +1,152 @@
+// Host shim: Arduino String
+// Mirrors the subset of the ESP32 core's WString API used by the firmware.
+// Storage grows through realloc() exactly like the core does, so allocation
+// counts measured on the host track what the device sees.
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class StringSumHelper;
+
+class String {
+public:
+  String(const char *cstr = "");
+  String(const char *cstr, unsigned int length);
+  String(const String &str);
+  String(String &&rval);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+  ~String();
+
+  bool reserve(unsigned int size);
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+  const char *c_str() const { return buffer ? buffer : ""; }
+  char *begin() { return buffer; }
+  char *end() { return buffer + len; }
+
+  String &operator=(const String &rhs);
+  String &operator=(const char *cstr);
+  String &operator=(String &&rval);
+
+  bool concat(const String &str);
+  bool concat(const char *cstr);
+  bool concat(const char *cstr, unsigned int length);
+  bool concat(char c);
+  bool concat(unsigned char num);
+  bool concat(int num);
+  bool concat(unsigned int num);
+  bool concat(long num);
+  bool concat(unsigned long num);
+  bool concat(long long num);
+  bool concat(unsigned long long num);
+  bool concat(float num);
+  bool concat(double num);
+
+  template <typename T> String &operator+=(const T &rhs) {
+    concat(rhs);
+    return *this;
+  }
+
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,
+                                    const String &rhs);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,
+                                    const char *cstr);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, char c);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,
+                                    unsigned int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs,
+                                    unsigned long num);
+
+  int compareTo(const String &s) const;
+  bool equals(const String &s) const;
+  bool equals(const char *cstr) const;
+  bool operator==(const String &rhs) const { return equals(rhs); }
+  bool operator==(const char *cstr) const { return equals(cstr); }
+  bool operator!=(const String &rhs) const { return !equals(rhs); }
+  bool operator!=(const char *cstr) const { return !equals(cstr); }
+  bool operator<(const String &rhs) const { return compareTo(rhs) < 0; }
+  bool equalsIgnoreCase(const String &s) const;
+  bool startsWith(const String &prefix) const;
+  bool startsWith(const String &prefix, unsigned int offset) const;
+  bool endsWith(const String &suffix) const;
+
+  char charAt(unsigned int index) const;
+  void setCharAt(unsigned int index, char c);
+  char operator[](unsigned int index) const;
+  char &operator[](unsigned int index);
+  void getBytes(unsigned char *buf, unsigned int bufsize,
+                unsigned int index = 0) const;
+  void toCharArray(char *buf, unsigned int bufsize,
+                   unsigned int index = 0) const {
+    getBytes((unsigned char *)buf, bufsize, index);
+  }
+
+  int indexOf(char ch) const;
+  int indexOf(char ch, unsigned int fromIndex) const;
+  int indexOf(const String &str) const;
+  int indexOf(const String &str, unsigned int fromIndex) const;
+  int lastIndexOf(char ch) const;
+  int lastIndexOf(char ch, unsigned int fromIndex) const;
+  int lastIndexOf(const String &str) const;
+  String substring(unsigned int beginIndex) const {
+    return substring(beginIndex, len);
+  }
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replace);
+  void replace(const String &find, const String &replace);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+protected:
+  char *buffer = nullptr;
+  unsigned int capacity = 0;
+  unsigned int len = 0;
+
+  void invalidate();
+  bool changeBuffer(unsigned int maxStrLen);
+  String &copy(const char *cstr, unsigned int length);
+  void move(String &rhs);
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String &s) : String(s) {}
+  StringSumHelper(const char *p) : String(p) {}
+  StringSumHelper(char c) : String(c) {}
+  StringSumHelper(int num) : String(num) {}
+  StringSumHelper(unsigned int num) : String(num) {}
+  StringSumHelper(long num) : String(num) {}
+  StringSumHelper(unsigned long num) : String(num) {}
+};
+
+inline bool operator==(const char *lhs, const String &rhs) {
+  return rhs.equals(lhs);
+}
+inline bool operator!=(const char *lhs, const String &rhs) {
+  return !rhs.equals(lhs);
+}
+
+#endif
@@ -0,0 +1,63 @@
+// Host shim: WiFi
+// The station link is always "connected"; WiFiClient is a byte stream whose
+// receive side is filled by the HTTP transport (see HostTransport.h). With
+// the socket transport it also holds the TCP connection to the endpoint.
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClient : public Stream {
+public:
+  virtual ~WiFiClient() {}
+  virtual int connect(const char *host, uint16_t port);
+  virtual void stop();
+  virtual uint8_t connected();
+  operator bool() { return connected(); }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(uint8_t *buf, size_t size);
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+
+  // Host side: bytes the "server" sends back, and bytes the firmware sent.
+  void hostLoad(String payload, bool closed = false); // closed: peer gone
+  const String &hostSent() const { return tx; }
+  int hostSocket() const { return sock; }
+  void hostSetSocket(int fd) { sock = fd; }
+
+protected:
+  int sock = -1;
+  String rx;
+  unsigned int rxPos = 0;
+  String tx;
+  bool open = false;
+};
+
+class WiFiClass {
+public:
+  wl_status_t status() { return connectedState ? WL_CONNECTED : WL_DISCONNECTED; }
+  bool isConnected() { return connectedState; }
+  void hostSetConnected(bool connected) { connectedState = connected; }
+
+private:
+  bool connectedState = true;
+};
+extern WiFiClass WiFi;
+
+#endif
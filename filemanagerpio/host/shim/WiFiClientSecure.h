@@ -0,0 +1,16 @@
+// Host shim: WiFiClientSecure
+// TLS is not emulated. connect() succeeds and answers every request with a
+// bare "200 OK", which is all Firebase_VerifyUser() looks for.
+
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+  int connect(const char *host, uint16_t port) override;
+};
+
+#endif
@@ -0,0 +1,120 @@
+// Host tool: standalone WebDavis stand-in
+// Serves the recorded corpus (or synthetic tables) the way index.php does,
+// for a device on the bench or curl, until interrupted. Point the host in
+// websraper.cpp's url at this machine to run the firmware against it.
+//
+//   wfs_webdavis [-p corpus_dir | -g synthetic_flights] [-c change_percent]
+//                [-P port] [-a] [-s latency_ms] [-J jitter_ms]
+//                [-u truncate_every]
+//                [-z rotate_every] [-i session_idle_s] [-q]
+//
+// -a listens on every interface instead of loopback only. Each request is
+// logged with its session and page unless -q is given.
+
+#include "HostTransport.h"
+#include "replay.h"
+#include "webdavis_stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static bool quiet = false;
+
+// The replay with one line per request
+static int LoggedHandler(const String &method, const String &url,
+                         const String &body, String &response) {
+  int code = Replay_Handler(method, url, body, response);
+  if (!quiet) {
+    int marker = response.indexOf("Page: ");
+    String page = marker >= 0
+                      ? response.substring(marker, response.indexOf('(', marker))
+                      : String("no pager");
+    fprintf(stderr, "%s %s [%s] -> %d, %u bytes, %s\n", method.c_str(),
+            url.c_str(), body.substring(0, 60).c_str(), code,
+            response.length(), page.c_str());
+  }
+  return code;
+}
+
+int main(int argc, char **argv) {
+  String pagesDir = "corpus";
+  StubOptions stubOptions = {8080, false, 0, 0, 0};
+  ReplayOptions replayOptions = {0, REPLAY_SESSION_IDLE_MS};
+  int syntheticFlights = 0;
+  int changePercent = 10;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:g:c:P:as:J:u:z:i:qh")) != -1) {
+    switch (opt) {
+    case 'p':
+      pagesDir = optarg;
+      break;
+    case 'g':
+      syntheticFlights = atoi(optarg);
+      break;
+    case 'c':
+      changePercent = atoi(optarg);
+      break;
+    case 'P':
+      stubOptions.port = atoi(optarg);
+      break;
+    case 'a':
+      stubOptions.anyAddress = true;
+      break;
+    case 's':
+      stubOptions.latencyMs = strtoul(optarg, nullptr, 10);
+      break;
+    case 'J':
+      stubOptions.jitterMs = strtoul(optarg, nullptr, 10);
+      break;
+    case 'u':
+      stubOptions.truncateEvery = atoi(optarg);
+      break;
+    case 'z':
+      replayOptions.rotateEvery = atoi(optarg);
+      break;
+    case 'i':
+      replayOptions.sessionIdleMs = strtoul(optarg, nullptr, 10) * 1000;
+      break;
+    case 'q':
+      quiet = true;
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-p corpus_dir | -g synthetic_flights] "
+              "[-c change_percent] [-P port] [-a] [-s latency_ms] "
+              "[-J jitter_ms] "
+              "[-u truncate_every] [-z rotate_every] [-i session_idle_s] "
+              "[-q]\n",
+              argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  if (syntheticFlights > 0) {
+    Replay_InitSynthetic(syntheticFlights, changePercent);
+  } else if (!Replay_Init(pagesDir)) {
+    fprintf(stderr, "no recorded pages in %s\n", pagesDir.c_str());
+    return 1;
+  }
+  Replay_SetOptions(replayOptions);
+  int port = Stub_Start(LoggedHandler, stubOptions);
+  if (port < 0) {
+    perror("cannot listen");
+    return 1;
+  }
+  fprintf(stderr, "WebDavis stand-in on %s:%d, serving %s\n",
+          stubOptions.anyAddress ? "0.0.0.0" : "127.0.0.1", port,
+          syntheticFlights > 0 ? "synthetic tables" : pagesDir.c_str());
+
+  for (;;) {
+    sleep(60);
+    StubStats served = Stub_GetStats();
+    ReplayStats replay = Replay_GetStats();
+    fprintf(stderr,
+            "%lu requests over %lu connection(s), %lu cut off; %lu pages, "
+            "%lu sessions, %lu rotations, %lu expired\n",
+            served.requests, served.connections, served.truncated,
+            replay.pages, replay.sessions, replay.rotations, replay.expired);
+  }
+}
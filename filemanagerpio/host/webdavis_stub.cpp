@@ -0,0 +1,162 @@
+// Host harness: WebDavis stub server
+
+#include "webdavis_stub.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+static HostHttpHandler stubHandler = nullptr;
+static std::mutex &handlerLock = *new std::mutex; // the replay is not shared
+static std::atomic<unsigned long> stubConnections(0);
+static std::atomic<unsigned long> stubRequests(0);
+static std::atomic<unsigned long> stubTruncated(0);
+static unsigned long stubPosts = 0; // under handlerLock
+static StubOptions stubOptions = {};
+
+static bool SendAll(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+      return false;
+    sent += n;
+  }
+  return true;
+}
+
+static const char *HeaderValue(const std::string &head, const char *name) {
+  size_t length = strlen(name);
+  for (size_t pos = head.find("\r\n"); pos != std::string::npos;
+       pos = head.find("\r\n", pos + 2)) {
+    const char *line = head.c_str() + pos + 2;
+    if (strncasecmp(line, name, length) == 0 && line[length] == ':')
+      return line + length + 1 + strspn(line + length + 1, " ");
+  }
+  return nullptr;
+}
+
+// One connection, any number of requests until either side closes it
+static void Serve(int fd) {
+  std::string data;
+  char buf[4096];
+  for (;;) {
+    size_t headerEnd;
+    while ((headerEnd = data.find("\r\n\r\n")) == std::string::npos) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        close(fd);
+        return;
+      }
+      data.append(buf, n);
+    }
+    std::string head = data.substr(0, headerEnd);
+    data.erase(0, headerEnd + 4);
+
+    const char *lengthValue = HeaderValue(head, "Content-Length");
+    size_t length = lengthValue ? strtoul(lengthValue, nullptr, 10) : 0;
+    while (data.size() < length) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        close(fd);
+        return;
+      }
+      data.append(buf, n);
+    }
+    std::string body = data.substr(0, length);
+    data.erase(0, length);
+
+    std::string method = head.substr(0, head.find(' '));
+    size_t targetStart = method.size() + 1;
+    std::string target =
+        head.substr(targetStart, head.find(' ', targetStart) - targetStart);
+    const char *connection = HeaderValue(head, "Connection");
+    bool keepAlive = !connection || strncasecmp(connection, "close", 5) != 0;
+
+    String response;
+    int code;
+    bool truncate = false;
+    {
+      std::lock_guard<std::mutex> lock(handlerLock);
+      stubRequests++;
+      code = stubHandler(method.c_str(), target.c_str(),
+                         String(body.c_str(), body.size()), response);
+      truncate = method == "POST" && stubOptions.truncateEvery > 0 &&
+                 ++stubPosts % stubOptions.truncateEvery == 0;
+    }
+    if (code < 0) {
+      close(fd); // no answer at all
+      return;
+    }
+    unsigned long wait = stubOptions.latencyMs +
+                         (stubOptions.jitterMs ? random(stubOptions.jitterMs + 1)
+                                               : 0);
+    if (wait)
+      std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+    std::string reply = "HTTP/1.1 " + std::to_string(code) +
+                        (code == 200 ? " OK" : " Error") +
+                        "\r\nContent-Type: text/html\r\nContent-Length: " +
+                        std::to_string(response.length()) + "\r\nConnection: " +
+                        (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+    if (truncate) {
+      // The server went away mid-page
+      stubTruncated++;
+      reply.append(response.c_str(), response.length() / 2);
+      SendAll(fd, reply);
+      close(fd);
+      return;
+    }
+    reply.append(response.c_str(), response.length());
+    if (!SendAll(fd, reply) || !keepAlive) {
+      close(fd);
+      return;
+    }
+  }
+}
+
+int Stub_Start(HostHttpHandler handler) {
+  return Stub_Start(handler, StubOptions());
+}
+
+int Stub_Start(HostHttpHandler handler, const StubOptions &options) {
+  stubHandler = handler;
+  stubOptions = options;
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  if (listener < 0)
+    return -1;
+  int on = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(options.anyAddress ? INADDR_ANY
+                                                  : INADDR_LOOPBACK);
+  addr.sin_port = htons(options.port);
+  socklen_t size = sizeof(addr);
+  if (bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(listener, 8) < 0 ||
+      getsockname(listener, (sockaddr *)&addr, &size) < 0) {
+    close(listener);
+    return -1;
+  }
+  std::thread([listener] {
+    for (;;) {
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd < 0)
+        continue;
+      stubConnections++;
+      std::thread(Serve, fd).detach();
+    }
+  }).detach();
+  return ntohs(addr.sin_port);
+}
+
+StubStats Stub_GetStats() {
+  return {stubConnections.load(), stubRequests.load(), stubTruncated.load()};
+}
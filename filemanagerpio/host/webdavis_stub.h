@@ -0,0 +1,35 @@
+// Host harness: WebDavis stand-in on a local TCP port
+// A small HTTP/1.1 server on 127.0.0.1 (or every interface) that answers
+// with a handler (the page replay) and counts the connections and requests
+// it gets.
+// Connections are kept alive unless the client asks for "Connection: close".
+// Faults are injected at the transport: a delay (plus random jitter) before
+// every answer, and
+// every Nth page cut off halfway with the connection closed, its
+// Content-Length still the full one. A handler returning a negative code
+// gets the connection closed without an answer.
+
+#ifndef HOST_WEBDAVIS_STUB_H
+#define HOST_WEBDAVIS_STUB_H
+
+#include "HostTransport.h"
+
+struct StubOptions {
+  uint16_t port;          // 0 = any free port
+  bool anyAddress;        // listen on every interface, not only loopback
+  unsigned long latencyMs; // wall time before every answer
+  unsigned long jitterMs;  // plus 0..jitterMs, drawn per answer
+  int truncateEvery;      // every Nth POST answer is cut off, 0 = never
+};
+
+struct StubStats {
+  unsigned long connections; // accepted
+  unsigned long requests;
+  unsigned long truncated;
+};
+
+int Stub_Start(HostHttpHandler handler); // loopback, any port; -1 on failure
+int Stub_Start(HostHttpHandler handler, const StubOptions &options);
+StubStats Stub_GetStats();
+
+#endif
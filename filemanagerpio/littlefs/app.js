@@ -518,6 +518,68 @@ setInterval(() => {
 // ============ ESP32 STATUS MONITORING (DIRECT FROM ESP32) ============
 
 let statusMonitorInterval = null;
+let statusEvents = null;
+let statusSeq = 0; // last status shown; two tasks' events can cross
+
+// Seconds since boot as "1d 2h", "3h 4m" or "5m 6s"
+function formatUptime(seconds) {
+    const minutes = Math.floor(seconds / 60);
+    const hours = Math.floor(minutes / 60);
+    const days = Math.floor(hours / 24);
+    if (days > 0) return `${days}d ${hours % 24}h`;
+    if (hours > 0) return `${hours}h ${minutes % 60}m`;
+    return `${minutes}m ${seconds % 60}s`;
+}
+
+// Status changes, progress and a heartbeat pushed by the ESP32 (SSE); the
+// browser reconnects by itself and gets the current status again
+function startStatusEvents() {
+    if (!window.EventSource) return false;
+    statusEvents = new EventSource('/api/events');
+
+    // A (re)connect starts with the current status, also after a reboot
+    statusEvents.onopen = () => { statusSeq = 0; };
+
+    statusEvents.addEventListener('status', (event) => {
+        const data = JSON.parse(event.data);
+        if (data.seq < statusSeq) return;
+        statusSeq = data.seq;
+        updateEventDisplay({
+            icon: data.icon || '⏳',
+            message: data.message || 'No status',
+            time: new Date().toLocaleTimeString(),
+            status: 'connected'
+        });
+    });
+
+    statusEvents.addEventListener('progress', (event) => {
+        const data = JSON.parse(event.data);
+        const syncProgress = document.getElementById('syncProgress');
+        if (syncProgress) {
+            syncProgress.textContent = data.stage === 'upload'
+                ? `${data.done} chunk(s) sent, ${data.total} flights queued`
+                : `page ${data.done} of ${data.total}`;
+        }
+    });
+
+    statusEvents.addEventListener('heartbeat', (event) => {
+        const data = JSON.parse(event.data);
+        const uptimeValue = document.getElementById('uptimeValue');
+        const freeMemory = document.getElementById('freeMemory');
+        if (uptimeValue) uptimeValue.textContent = formatUptime(data.uptime);
+        if (freeMemory) freeMemory.textContent = Math.floor(data.freeHeap / 1024) + ' KB';
+    });
+
+    statusEvents.onerror = () => {
+        updateEventDisplay({
+            icon: '❌',
+            message: 'Lost connection to ESP32, retrying...',
+            time: new Date().toLocaleTimeString(),
+            status: 'error'
+        });
+    };
+    return true;
+}
 
 // Fetch and display ESP32 status directly from ESP32
 async function fetchESP32Status() {
@@ -542,10 +604,30 @@ async function fetchESP32Status() {
         const lastSyncTime = document.getElementById('lastSyncTime');
         const uptimeValue = document.getElementById('uptimeValue');
         const freeMemory = document.getElementById('freeMemory');
+        const deltaStats = document.getElementById('deltaStats');
+        const rttStats = document.getElementById('rttStats');
+        const restartStats = document.getElementById('restartStats');
 
         if (lastSyncTime) lastSyncTime.textContent = data.timestamp || '--';
         if (uptimeValue) uptimeValue.textContent = data.uptime || '--';
         if (freeMemory) freeMemory.textContent = data.freeMemory || '--';
+        if (deltaStats && data.delta) {
+            deltaStats.textContent = `${data.delta.changed} changed, ` +
+                `${data.delta.unchanged} unchanged, ${data.delta.new} new`;
+        }
+        if (rttStats && data.rtt) {
+            rttStats.textContent = data.rtt.samples
+                ? `p50 ${data.rtt.p50} / p99 ${data.rtt.p99} ms, ` +
+                  `timeout ${(data.rtt.timeout / 1000).toFixed(1)} s`
+                : '--';
+        }
+        if (restartStats && data.health) {
+            const last = data.health.history[0];
+            restartStats.textContent = last
+                ? `${last.reason} after ${last.cycles} cycles ` +
+                  `(${data.health.restarts} total)`
+                : 'none recorded';
+        }
 
     } catch (error) {
         console.error('Error fetching ESP32 status:', error);
@@ -587,14 +669,17 @@ function updateEventDisplay(data) {
 
     function startMonitoring() {
         setTimeout(() => {
-            // Initial fetch
+            // Initial fetch: sync and restart statistics
             fetchESP32Status();
 
-            // Fetch every 10 seconds
+            // Status comes as events; the statistics change once a cycle.
+            // Without EventSource, poll every 10 seconds as before
+            const pushed = startStatusEvents();
             if (statusMonitorInterval) {
                 clearInterval(statusMonitorInterval);
             }
-            statusMonitorInterval = setInterval(fetchESP32Status, 10000);
+            statusMonitorInterval = setInterval(fetchESP32Status,
+                                                pushed ? 60000 : 10000);
         }, 1000);
     }
 })();
@@ -604,4 +689,7 @@ window.addEventListener('beforeunload', () => {
     if (statusMonitorInterval) {
         clearInterval(statusMonitorInterval);
     }
+    if (statusEvents) {
+        statusEvents.close();
+    }
 });
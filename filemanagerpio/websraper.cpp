@@ -5,36 +5,29 @@
 // Flight numbers can only have ONE space - second space indicates garbage data
 // Example: "QR 345 2015" should become "QR 345" (remove everything after 2nd
 // space)
-String SanitizeFlightNumber(String flnr) {
-  String cleaned = "";
+// Works in place on the cell's buffer and returns the new length; the value
+// only gets shorter, so nothing is allocated.
+size_t SanitizeFlightNumber(char *flnr, size_t len) {
+  size_t used = 0;
   int spaceCount = 0;
 
   // Only keep alphanumeric characters, spaces, and hyphens
   // Stop at second space (garbage data starts there)
-  for (int i = 0; i < flnr.length(); i++) {
+  for (size_t i = 0; i < len; i++) {
     char c = flnr[i];
 
-    // Check for space
-    if (c == ' ') {
+    // A dash is replaced with a space and counts as one
+    if (c == ' ' || c == '-') {
       spaceCount++;
       if (spaceCount >= 2) {
-        // Second space found - this is where garbage starts, stop here
+        // Second separator found - this is where garbage starts, stop here
         break;
       }
-      cleaned += ' ';
-    }
-    // Replace dash with space (but count it as a space)
-    else if (c == '-') {
-      spaceCount++;
-      if (spaceCount >= 2) {
-        // Second separator found - stop here
-        break;
-      }
-      cleaned += ' ';
+      flnr[used++] = ' ';
     }
     // Keep alphanumeric characters
-    else if (isalnum(c)) {
-      cleaned += c;
+    else if (isalnum((uint8_t)c)) {
+      flnr[used++] = c;
     }
     // Stop at any other invalid character
     else {
@@ -42,124 +35,178 @@ String SanitizeFlightNumber(String flnr) {
     }
   }
 
-  cleaned.trim();
-  return cleaned;
-}
-
-// Helper function to normalize flight key to YYMMDDHHMM_FLNR format
-String NormalizeFlightKey(String keySTM, String flnr) {
-  // Handle both YYMMDDHHMM (10 digits) and YYYYMMDDHHMM (12 digits) formats
-  if (keySTM.length() == 12) {
-    // Convert YYYYMMDDHHMM to YYMMDDHHMM (remove first 2 digits of year)
-    keySTM = keySTM.substring(2);
-    Serial.printf("🔧 Converted 4-digit year format: %s -> %s\n", keySTM.c_str() + 2, keySTM.c_str());
-  }
-  else if (keySTM.length() != 10) {
-    // Try to extract digits from the string
-    String cleanSTM = "";
-    for (int i = 0; i < keySTM.length() && cleanSTM.length() < 12; i++) {
-      if (isdigit(keySTM[i])) {
-        cleanSTM += keySTM[i];
-      }
-    }
-
-    // Handle 12-digit format first
-    if (cleanSTM.length() == 12) {
-      keySTM = cleanSTM.substring(2); // Convert YYYYMMDDHHMM to YYMMDDHHMM
-      Serial.printf("🔧 Extracted and converted 4-digit year: %s -> %s\n", cleanSTM.c_str(), keySTM.c_str());
-    }
-    else if (cleanSTM.length() == 10) {
-      keySTM = cleanSTM;
-    }
-    else {
-      Serial.printf(
-          "⚠️ Invalid STM format: '%s' (length: %d), cannot normalize\n",
-          keySTM.c_str(), keySTM.length());
-      return ""; // Return empty to skip this flight
-    }
-  }
-
-  // Clean flight number
-  flnr.trim();
-
-  String key = keySTM + "_" + flnr;
-  key.replace(" ", "");
-
-  // Final validation
-  if (key.length() < 12) {
-    Serial.printf("⚠️ Invalid key format: '%s' (too short)\n", key.c_str());
-    return "";
-  }
-
-  return key;
+  // Trim, as String::trim() did
+  while (used > 0 && flnr[used - 1] == ' ')
+    used--;
+  size_t start = 0;
+  while (start < used && flnr[start] == ' ')
+    start++;
+  memmove(flnr, flnr + start, used - start);
+  used -= start;
+  flnr[used] = '\0';
+  return used;
 }
 
 // Helper function to convert keySTM format (YYMMDDHHmm) to Unix timestamp
 time_t ParseKeySTMTime(String keySTM) {
-  if (keySTM.length() != 10)
-    return 0;
-
-  struct tm timeinfo = {0};
-  timeinfo.tm_year =
-      (keySTM.substring(0, 2).toInt() + 2000) - 1900;   // Year since 1900
-  timeinfo.tm_mon = keySTM.substring(2, 4).toInt() - 1; // Month (0-11)
-  timeinfo.tm_mday = keySTM.substring(4, 6).toInt();    // Day
-  timeinfo.tm_hour = keySTM.substring(6, 8).toInt();    // Hour
-  timeinfo.tm_min = keySTM.substring(8, 10).toInt();    // Minute
-  timeinfo.tm_sec = 0;
-
-  return mktime(&timeinfo);
+  return DateTime_MinutesToEpoch(
+      DateTime_CompactMinutes(keySTM.c_str(), keySTM.length()));
 }
 
 // Define the flight data state machine variable (declared extern in Global.h)
 FlightDataState flightDataState = IDLE;
 
-// Increased JSON document sizes for more flight data capacity
-StaticJsonDocument<32768> allData; // 32KB - temporary scratchpad
 const char *url = "http://172.17.16.4/isb/maxcs/WebDavis/index.php";
 int Page = -1;
 int Pages = -1;
 String phpSessionID = ""; // Will store captured PHPSESSID
 bool SessoinIdFound = false;
 
+// One keep-alive connection to WebDavis for every page and config. The
+// session is fetched once and then follows the server: every page carries
+// the current PHPSESSID, and CheckSession() picks up a rotated one.
+static WiFiClient webdavisClient;
+static HTTPClient webdavis;
+static unsigned long sessionUsedAt = 0; // millis(), 0 = no valid session
+static WebDavisStats webdavisStats = {};
+
+// Reuses the open connection when the server kept it alive
+static void WebDavis_Begin() {
+  if (!webdavisClient.connected())
+    webdavisStats.connections++;
+  webdavis.setReuse(true);
+  webdavis.setTimeout(10000); // 10 second timeout
+  webdavis.begin(webdavisClient, url);
+  webdavisStats.requests++;
+}
+
+// A response of unknown length was read up to an idle gap, so whatever is
+// left on the connection cannot be trusted for the next request
+static void WebDavis_End(bool lengthKnown) {
+  webdavis.end();
+  if (!lengthKnown)
+    webdavisClient.stop();
+}
+
+// A new session only when there is none, the server may have expired it
+// (idle too long), or the last page came back without one
+static bool WebDavis_EnsureSession() {
+  if (sessionUsedAt && phpSessionID.length() > 0 &&
+      millis() - sessionUsedAt < WEBDAVIS_SESSION_IDLE_MS)
+    return true;
+  phpSessionID = "";
+  fetchPHPSESSID();
+  if (phpSessionID.length() == 0)
+    return false;
+  webdavisStats.sessions++;
+  sessionUsedAt = millis();
+  return true;
+}
+
+WebDavisStats WebDavis_GetStats() { return webdavisStats; }
+
+enum PageParseMode {
+  PAGE_STREAM, // parsed while read: pager, session and rows
+  PAGE_SCAN,   // held in the page cache: pager and session, rows hashed
+  PAGE_ROWS    // held page the cache wants parsed: rows only
+};
+
+struct PageParseContext {
+  const String *category;
+  const String *subCategory;
+  PageParseMode mode;
+};
+
+static void ParseHeldPage(const char *body, size_t len, void *context);
+
 void Fetch(String line, String category, String subCategory) {
 
   Page = -1;
   Pages = -1;
-  fetchPHPSESSID();
-  if (phpSessionID.length() > 0) {
-    do {
-      postRequest(line, Page, Pages, category, subCategory);
-      delay(8500); // ~8.5 second delay between pages (35 pages over 5 min =
-                   // 300s/35 = ~8.5s per page)
-    } while (Page < Pages);
-
-    Serial.println("✅ Fetch complete.");
+  if (!WebDavis_EnsureSession()) {
+    Serial.println("❌ No WebDavis session, skipping this config");
+    return;
   }
+
+  Pacing_Begin(line.c_str());
+  // Check-in counters of one flight are spread over several pages
+  PageCache_BeginConfig(line.c_str(), category == "CheckIn");
+  int restarts = 0;
+  bool more;
+  do {
+    // A new session loses the server's place in the config
+    uint32_t sessions = webdavisStats.sessions;
+    if (!WebDavis_EnsureSession()) {
+      Serial.println("❌ WebDavis session lost, skipping the rest");
+      break;
+    }
+    if (webdavisStats.sessions != sessions && Page != -1) {
+      Serial.println("🔁 New WebDavis session, starting the config over");
+      Page = -1;
+      Pages = -1;
+    }
+
+    String sessionBefore = phpSessionID;
+    unsigned long started = millis();
+    int httpCode = postRequest(line, Page, Pages, category, subCategory);
+    bool ok = httpCode == HTTP_CODE_OK && SessoinIdFound;
+    if (ok) {
+      sessionUsedAt = millis();
+      if (phpSessionID != sessionBefore)
+        webdavisStats.rotations++;
+    } else if (httpCode == HTTP_CODE_OK) {
+      Serial.println("⚠️ Page without a session, requesting a new one");
+      sessionUsedAt = 0;
+    }
+    Sync_PageParsed(); // uploads start while the next page is fetched
+    if (httpCode == HTTPC_ERROR_CONNECTION_LOST &&
+        restarts < WEBDAVIS_MAX_RESTARTS) {
+      // The rest of the page is gone and the server has moved past it
+      restarts++;
+      Serial.println("🔁 Page cut off, starting the config over");
+      Page = -1;
+      Pages = -1;
+    }
+
+    uint32_t wait;
+    if (!Pacing_PageDone(millis() - started, ok, wait)) {
+      Serial.printf("❌ %d failed pages in a row, skipping the rest of %s\n",
+                    PACING_MAX_ERRORS, line.c_str());
+      break;
+    }
+    // A failed first request leaves Page at -1; send it again
+    more = Page < Pages || (!ok && Page == -1);
+    if (more)
+      delay(wait);
+  } while (more);
+  Pacing_End(Page);
+  PageParseContext context = {&category, &subCategory, PAGE_ROWS};
+  PageCache_EndConfig(ParseHeldPage, &context);
+
+  Serial.println("✅ Fetch complete.");
 }
 void fetchPHPSESSID() {
   if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    http.setTimeout(10000); // 10 second timeout
-    http.begin(url);
+    WebDavis_Begin();
 
-    int httpCode = http.GET();
+    int httpCode = webdavis.GET();
 
+    SessoinIdFound = false;
     if (httpCode > 0 && httpCode == HTTP_CODE_OK) {
-      WiFiClient *stream = http.getStreamPtr();
+      WiFiClient *stream = webdavis.getStreamPtr();
       bool found = false;
 
-      while (http.connected() && stream->available() && !found) {
+      while (webdavis.connected() && stream->available() && !found) {
         String line = stream->readStringUntil('\n');
 
         found = CheckSession(line);
       }
     } else {
       Serial.printf("GET request failed, error: %s\n",
-                    http.errorToString(httpCode).c_str());
+                    webdavis.errorToString(httpCode).c_str());
     }
 
-    http.end();
+    WebDavis_End(webdavis.getSize() >= 0);
   } else {
     Serial.println("WiFi not connected!");
   }
@@ -172,7 +219,7 @@ bool extractPageInfo(String line) {
 
   // Extract current page
   p1 += 5; // move past "Page:"
-  while (p1 < line.length() && line[p1] == ' ')
+  while (p1 < (int)line.length() && line[p1] == ' ')
     p1++; // skip spaces
 
   int pFrom = line.indexOf("from", p1);
@@ -185,7 +232,7 @@ bool extractPageInfo(String line) {
 
   // Extract total pages
   pFrom += 4; // skip "from"
-  while (pFrom < line.length() && line[pFrom] == ' ')
+  while (pFrom < (int)line.length() && line[pFrom] == ' ')
     pFrom++;
 
   int pParen = line.indexOf("(", pFrom);
@@ -222,190 +269,289 @@ bool CheckSession(String line) {
   return SessoinIdFound;
 }
 
-void ExtractTDInfoJSON(String trHtml, JsonDocument &doc, String Category,
-                       String subCategory) {
-  bool Checkin = false;
-  if (Category == "CheckIn") {
-    Checkin = true;
-    Category = "Departure";
-  }
+static bool IsBlankChar(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
 
-  int pos = 0;
-  String keySTM = "";
-  String flnr = "";
-  StaticJsonDocument<1024> rowTemp;
-  String cremVal = "";
-  String cremLuVal = "";
-  if (!Checkin) {
-    rowTemp["SubCat"] = subCategory;
-  }
+static bool MatchAt(const char *p, const char *end, const char *lit,
+                    size_t litLen) {
+  return (size_t)(end - p) >= litLen && memcmp(p, lit, litLen) == 0;
+}
 
-  while (true) {
-    int tdStart = trHtml.indexOf("<td", pos);
-    if (tdStart == -1)
+// Single forward pass over one "<td ...>...</td>" view from the tokenizer.
+// The field name comes from title='Field: name (...)' and the value is the
+// text after "Value:" up to the next tag. Nothing outside the cell is read and
+// nothing is allocated; returns false when the cell has no usable name/value.
+bool ExtractCellField(const char *cell, size_t len, CellField &out) {
+  enum { SCAN, TITLE, NAME_LEAD, NAME, TITLE_REST, VALUE_LEAD, VALUE } state =
+      SCAN;
+  const char *p = cell;
+  const char *end = cell + len;
+  bool titleSeen = false;
+  bool valueSeen = false;
+  bool nameOverflow = false;
+  out.nameLen = 0;
+  out.valueLen = 0;
+  out.truncated = false;
+
+  while (p < end) {
+    char c = *p;
+    switch (state) {
+    case SCAN:
+      if (c == 't' && !titleSeen && MatchAt(p, end, "title='", 7)) {
+        titleSeen = true;
+        state = TITLE;
+        p += 7;
+        continue;
+      }
+      if (c == 'V' && !valueSeen && MatchAt(p, end, "Value:", 6)) {
+        valueSeen = true;
+        state = VALUE_LEAD;
+        p += 6;
+        continue;
+      }
       break;
-
-    int tdEnd = trHtml.indexOf("</td>", tdStart);
-    if (tdEnd == -1)
+    case TITLE:
+      if (c == '\'') {
+        state = SCAN;
+      } else if (c == 'F' && MatchAt(p, end, "Field:", 6)) {
+        state = NAME_LEAD;
+        p += 6;
+        continue;
+      }
       break;
-
-    int titleStart = trHtml.indexOf("title='", tdStart);
-    String fieldName = "";
-
-    if (titleStart >= 0 && titleStart < tdEnd) {
-      titleStart += 7;
-      int titleEnd = trHtml.indexOf("'", titleStart);
-      if (titleEnd > titleStart) {
-        String title = trHtml.substring(titleStart, titleEnd);
-        int fIndex = title.indexOf("Field:");
-        if (fIndex >= 0) {
-          fieldName = title.substring(fIndex + 6);
-          fieldName.trim();
-          int sp = fieldName.indexOf(' ');
-          if (sp > 0)
-            fieldName = fieldName.substring(0, sp);
-        }
+    case NAME_LEAD:
+      if (IsBlankChar(c))
+        break;
+      state = NAME;
+      continue;
+    case NAME:
+      if (c == '\'') {
+        state = SCAN;
+      } else if (IsBlankChar(c)) {
+        state = TITLE_REST; // "Field: flnr (Flight)" -> "flnr"
+      } else if (out.nameLen < CELL_NAME_MAX - 1) {
+        out.name[out.nameLen++] = c;
+      } else {
+        nameOverflow = true;
+      }
+      break;
+    case TITLE_REST:
+      if (c == '\'')
+        state = SCAN;
+      break;
+    case VALUE_LEAD:
+      if (IsBlankChar(c))
+        break;
+      state = VALUE;
+      continue;
+    case VALUE:
+      if (c == '<') {
+        state = SCAN;
+      } else if (out.valueLen < CELL_VALUE_MAX - 1) {
+        out.value[out.valueLen++] = c;
+      } else {
+        out.truncated = true;
       }
+      break;
     }
+    p++;
+  }
 
-    int valueIndex = trHtml.indexOf("Value:", tdStart);
-    String value = "";
+  while (out.valueLen > 0 && IsBlankChar(out.value[out.valueLen - 1]))
+    out.valueLen--;
+  if (nameOverflow)
+    out.nameLen = 0;
+  out.name[out.nameLen] = '\0';
+  out.value[out.valueLen] = '\0';
+  return out.nameLen > 0 && out.valueLen > 0;
+}
 
-    if (valueIndex >= 0 && valueIndex < tdEnd) {
-      valueIndex += 6;
-      int valueEnd = trHtml.indexOf("<", valueIndex);
-      if (valueEnd > valueIndex) {
-        value = trHtml.substring(valueIndex, valueEnd);
-        value.trim();
-      }
-    }
+// Text of an optional slot ("" when the row did not have that cell)
+static const char *SlotText(const CellField *f) { return f ? f->value : ""; }
 
-    if (fieldName.length() == 0 || value.length() == 0) {
-      pos = tdEnd + 5;
-      continue;
-    }
+// Normalizes one parsed row and writes it into the flight store. Check-in
+// rows land on the matching departure and add a ckco entry per counter.
+void CommitRowFields(RowFields &row, const String &category,
+                     const String &subCategory) {
+  bool Checkin = category == "CheckIn";
+  FlightCategory Category = category == "Arrival" ? CATEGORY_ARRIVAL
+                                                  : CATEGORY_DEPARTURE;
 
-    if (value.length() == 19 && value[4] == '-' && value[7] == '-' &&
-        value[10] == ' ' && value[13] == ':' && value[16] == ':') {
-      value = value.substring(2, 4) + value.substring(5, 7) +
-              value.substring(8, 10) + value.substring(11, 13) +
-              value.substring(14, 16);
-    }
+  // Without both key fields the row cannot be stored; skip the work below
+  const FieldMask keyFields = FIELD_BIT(FIELD_STM) | FIELD_BIT(FIELD_FLNR);
+  if ((row.present & keyFields) != keyFields)
+    return;
 
-    if (fieldName == "stm") {
+  CellField *keySTM = nullptr;
+  CellField *flnr = nullptr;
+  CellField *crem = nullptr;
+  CellField *cremLu = nullptr;
+  uint32_t keyMinutes = DATETIME_INVALID;
+
+  // Normalize values in place; slots that fail are dropped from the mask
+  for (uint8_t i = 0; i < row.count; i++) {
+    CellField &f = row.cells[i];
+    bool isSTM = f.id == FIELD_STM;
+    DateTimeShape shape = DateTime_Normalize(f.value, f.valueLen, isSTM,
+                                             isSTM ? &keyMinutes : nullptr);
+
+    switch (f.id) {
+    case FIELD_STM:
       // Ensure stm is in YYMMDDHHMM format (10 digits)
-      // If it's in ISO format (YYYY-MM-DD HH:MM:SS), convert it
-      if (value.length() == 19 && value[4] == '-' && value[7] == '-' &&
-          value[10] == ' ' && value[13] == ':' && value[16] == ':') {
-        // Extract: 2026-01-31 08:10:00 -> 2601310810
-        value = value.substring(2, 4) + value.substring(5, 7) +
-                value.substring(8, 10) + value.substring(11, 13) +
-                value.substring(14, 16);
+      if (shape == DATETIME_BAD) {
+        LOG_WARN("⚠️ Invalid STM format, skipping: %s\n", f.value);
+        f.id = FIELD_UNKNOWN;
+        continue;
       }
-      // If format has extra digits, handle 4-digit year (YYYYMMDDHHMM -> YYMMDDHHMM)
-      else if (value.length() == 12 && value.substring(0, 4).toInt() > 1999) {
-        // Extract last 10 digits from 4-digit year format
-        value = value.substring(2);
-        Serial.printf("🔧 Converted 4-digit year STM: %s\n", value.c_str());
-      }
-      // If format is wrong, try alternative patterns
-      else if (value.length() > 10) {
-        // Handle other date formats - extract numbers only
-        String cleanValue = "";
-        for (int i = 0; i < value.length() && cleanValue.length() < 12; i++) {
-          if (isdigit(value[i])) {
-            cleanValue += value[i];
-          }
-        }
-        // Handle 12-digit format (YYYYMMDDHHMM)
-        if (cleanValue.length() == 12) {
-          value = cleanValue.substring(2); // Convert to YYMMDDHHMM
-          Serial.printf("🔧 Extracted and converted STM: %s\n", value.c_str());
-        }
-        else if (cleanValue.length() == 10) {
-          value = cleanValue;
-        }
-        else {
-          Serial.printf("⚠️ Invalid STM format, skipping: %s\n", value.c_str());
-          pos = tdEnd + 5;
-          continue;
-        }
-      }
-      keySTM = value;
-    } else if (fieldName == "flnr") {
+      if (shape == DATETIME_FROM_YEAR4)
+        LOG_VERBOSE("🔧 Converted 4-digit year STM: %s\n", f.value);
+      else if (shape == DATETIME_FROM_DIGITS12)
+        LOG_VERBOSE("🔧 Extracted and converted STM: %s\n", f.value);
+      keySTM = &f;
+      break;
+    case FIELD_FLNR: {
       // Sanitize flight number to remove any garbage characters
-      flnr = SanitizeFlightNumber(value);
-      Serial.printf("  🧹 Cleaned flnr: '%s' (original: '%s')\n", flnr.c_str(),
-                    value.c_str());
-      // Update value to use cleaned version
-      value = flnr;
+      size_t original = f.valueLen;
+      f.valueLen = SanitizeFlightNumber(f.value, f.valueLen);
+      LOG_VERBOSE("  🧹 Cleaned flnr: '%s' (%u bytes dropped)\n", f.value,
+                  (unsigned)(original - f.valueLen));
+      flnr = &f;
+      break;
+    }
+    case FIELD_CREM:
+      crem = &f;
+      break;
+    case FIELD_CREM_LU:
+      cremLu = &f;
+      break;
+    default:
+      break;
     }
-
-    rowTemp[fieldName] = value;
-    if (fieldName == "crem")
-      cremVal = value;
-    if (fieldName == "crem_lu")
-      cremLuVal = value;
-
-    pos = tdEnd + 5;
   }
 
-  if (keySTM.isEmpty() || flnr.isEmpty())
+  if (!keySTM || !flnr || flnr->valueLen == 0)
     return;
 
-  // Normalize and validate the flight key
-  String key = NormalizeFlightKey(keySTM, flnr);
-  if (key.isEmpty()) {
-    Serial.printf(
-        "[SKIP] Flight key normalization failed: stm='%s', flnr='%s'\n",
-        keySTM.c_str(), flnr.c_str());
+  // Pack and validate the flight key
+  FlightKey key = FlightKey_Make(keyMinutes, flnr->value);
+  if (key == FLIGHT_KEY_NONE) {
+    LOG_WARN("[SKIP] Flight key normalization failed: stm='%s', flnr='%s'\n",
+             keySTM->value, flnr->value);
     return;
   }
 
-  key.replace(" ", "");
-
-  if (!allData.containsKey(Category))
-    allData.createNestedObject(Category);
-
-  JsonObject categoryObj = allData[Category].as<JsonObject>();
-
-  JsonObject targetRow;
-  if (categoryObj.containsKey(key))
-    targetRow = categoryObj[key].as<JsonObject>();
-  else
-    targetRow = categoryObj.createNestedObject(key);
-
-  for (JsonPair kv : rowTemp.as<JsonObject>()) {
-    String k = kv.key().c_str();
-    String v = kv.value().as<String>();
-
-    if (k == "ckco") {
+  // The uploader task reads the store meanwhile
+  FlightStore_Lock();
+  int rec = FlightStore_FindOrAdd(Category, key);
+  if (rec < 0) {
+    FlightStore_Unlock();
+    return; // store full, counted in FlightStore_GetStats()
+  }
+  PageCache_NoteFlight(Category, key);
 
-      if (!targetRow.containsKey("ckco"))
-        targetRow.createNestedObject("ckco");
+  if (!Checkin) {
+    FlightStore_SetField(rec, FIELD_SUBCAT, subCategory.c_str(),
+                         subCategory.length());
+  }
 
-      if (!targetRow["ckco"].containsKey(v))
-        targetRow["ckco"].createNestedArray(v);
+  for (uint8_t i = 0; i < row.count; i++) {
+    const CellField &f = row.cells[i];
 
-      JsonArray arr = targetRow["ckco"][v].as<JsonArray>();
-      // arr.clear();
+    if (f.id == FIELD_CKCO) {
+      FlightStore_AddCounter(rec, f.value, SlotText(crem), SlotText(cremLu));
+    } else if (f.id != FIELD_UNKNOWN && f.id != FIELD_CREM &&
+               f.id != FIELD_CREM_LU) // ❗ block them here
+    {
+      FlightStore_SetField(rec, f.id, f.value, f.valueLen);
+    }
+  }
+  FlightStore_Unlock();
+}
 
-      arr.add(cremVal);
+// Page tokenizer and row slots live outside the loop task's stack (they hold
+// a full row each)
+static RowTokenizer pageTokenizer;
+static RowFields pageRow;
+
+static void OnPageToken(TokenizerEvent event, const char *data, size_t len,
+                        void *context) {
+  PageParseContext *page = (PageParseContext *)context;
+
+  if (page->mode == PAGE_SCAN) {
+    if (event == TOKEN_ROW_END || event == TOKEN_ROW_DROPPED)
+      PageCache_HashRow(data, len);
+    if (event != TOKEN_LINE)
+      return;
+  } else if (page->mode == PAGE_ROWS && event == TOKEN_LINE) {
+    return; // seen by the scan already
+  }
 
-      arr.add(cremLuVal);
-    } else if (k != "crem" && k != "crem_lu") // ❗ block them here
-    {
-      targetRow[k] = kv.value();
+  if (event == TOKEN_LINE) {
+    // Only the pager and the hidden session input matter outside rows; skip
+    // building a String for every other line
+    if (strstr(data, "Page:") && extractPageInfo(String(data, len))) {
+      // UPDATE STATUS with detailed page progress
+      char pageStatus[STATUS_MESSAGE_MAX];
+      bool sub = page->subCategory->length() > 0;
+      snprintf(pageStatus, sizeof(pageStatus), "%s%s%s%s - Page %d of %d",
+               page->category->c_str(), sub ? " (" : "",
+               page->subCategory->c_str(), sub ? ")" : "", Page, Pages);
+      Status_Set("📥", pageStatus);
+      Status_Progress("fetch", Page, Pages);
+
+      LOG_DEBUG("%d Out of %d\n", Page, Pages);
+    }
+    if (!SessoinIdFound && strstr(data, "PHPSESSID")) {
+      CheckSession(String(data, len));
     }
+  } else if (event == TOKEN_ROW_BEGIN) {
+    pageRow.count = 0;
+    pageRow.present = 0;
+  } else if (event == TOKEN_CELL) {
+    if (pageRow.count >= ROW_MAX_CELLS) {
+      LOG_WARN("⚠️ Row has more than %d cells, extra cell ignored\n",
+               ROW_MAX_CELLS);
+      return;
+    }
+    CellField &cell = pageRow.cells[pageRow.count];
+    if (!ExtractCellField(data, len, cell))
+      return;
+    // Fields the ESP32 does not manage are never uploaded; drop them here
+    cell.id = Field_Lookup(cell.name, cell.nameLen);
+    if (cell.id == FIELD_UNKNOWN)
+      return;
+    if (cell.truncated)
+      LOG_WARN("⚠️ %s value cut to %d chars\n", cell.name,
+               CELL_VALUE_MAX - 1);
+    pageRow.present |= FIELD_BIT(cell.id);
+    pageRow.count++;
+  } else if (event == TOKEN_ROW_END) {
+    Metrics_Add(METRIC_ROWS, 1);
+    CommitRowFields(pageRow, *page->category, *page->subCategory);
+  } else if (event == TOKEN_ROW_DROPPED) {
+    LOG_WARN("⚠️ Dropped incomplete/oversized row (%u bytes kept)\n",
+             (unsigned)len);
   }
 }
 
-void postRequest(String cnfg, int pg, int pgs, String category,
-                 String subCategory) {
+// Page cache parser: the rows of a page body held in the arena
+static void ParseHeldPage(const char *body, size_t len, void *context) {
+  PageParseContext rows = *(PageParseContext *)context;
+  rows.mode = PAGE_ROWS;
+  unsigned long parseStart = micros();
+  Tokenizer_Begin(pageTokenizer, OnPageToken, &rows);
+  Tokenizer_Feed(pageTokenizer, body, len);
+  Tokenizer_End(pageTokenizer);
+  Metrics_Observe(METRIC_PAGE_PARSE, micros() - parseStart);
+}
+
+int postRequest(String cnfg, int pg, int pgs, String category,
+                String subCategory) {
+  int httpCode = HTTPC_ERROR_NOT_CONNECTED;
   if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    http.setTimeout(10000); // 10 second timeout
-    http.begin(url);
+    HTTPClient &http = webdavis;
+    WebDavis_Begin();
     http.addHeader("Content-Type", "application/x-www-form-urlencoded");
     String postData = "PHPSESSID=" + phpSessionID;
 
@@ -415,59 +561,103 @@ void postRequest(String cnfg, int pg, int pgs, String category,
       postData += "&n=>";
     }
 
-    int httpCode = http.POST(postData);
+    httpCode = http.POST(postData);
     SessoinIdFound = false;
     if (httpCode > 0 && httpCode == HTTP_CODE_OK) {
       WiFiClient *stream = http.getStreamPtr();
-      bool inRow = false;
-      String rowData = "";
-
-      while (http.connected() && stream->available()) {
-        String line = stream->readStringUntil('\n');
-        if (extractPageInfo(line)) {
-          // UPDATE STATUS with detailed page progress
-          String pageStatus = category;
-          if (subCategory.length() > 0) {
-            pageStatus += " (" + subCategory + ")";
-          }
-          pageStatus += " - Page " + String(Page) + " of " + String(Pages);
-          esp32Status = pageStatus;
-          esp32StatusIcon = "📥";
-
-          Serial.print(Page);
-          Serial.print(" Out of ");
-          Serial.println(Pages);
-        }
-        if (!SessoinIdFound) {
-          CheckSession(line);
-        }
-
-        line.trim();
-        if (line.length() == 0)
+      // The body goes to the page cache arena when it has room; the cache
+      // decides after the scan whether the rows are parsed
+      size_t room = 0;
+      size_t held = 0;
+      char *body = PageCache_Reserve(room);
+      PageParseContext context = {&category, &subCategory, PAGE_STREAM};
+      if (!body)
+        Tokenizer_Begin(pageTokenizer, OnPageToken, &context);
+
+      // Raw chunks straight from the socket; -1 means no Content-Length
+      char chunk[TOKENIZER_CHUNK_SIZE];
+      int remaining = http.getSize();
+      unsigned long lastData = millis();
+      unsigned long tokenizerUs = 0; // rows parsed while read, not waits
+
+      while (remaining != 0 && (http.connected() || stream->available())) {
+        size_t avail = stream->available();
+        if (avail == 0) {
+          if (millis() - lastData > 1000)
+            break; // same idle budget readStringUntil() used to allow
+          delay(1);
           continue;
+        }
 
-        if (!inRow && (line.indexOf("<tr class='row_1'>") >= 0 ||
-                       line.indexOf("<tr class='row_0'>") >= 0)) {
-          inRow = true;
-          rowData = line;
-          continue;
+        if (body && held == room) {
+          // Too large to hold: parse what came so far, the rest as it comes
+          PageCache_Overflow(ParseHeldPage, &context);
+          unsigned long parseStart = micros();
+          Tokenizer_Begin(pageTokenizer, OnPageToken, &context);
+          Tokenizer_Feed(pageTokenizer, body, held);
+          tokenizerUs += micros() - parseStart;
+          body = nullptr;
         }
 
-        if (inRow) {
-          rowData += " " + line;
-          if (line.indexOf("</tr>") >= 0) {
-            inRow = false;
-            ExtractTDInfoJSON(rowData, allData, category, subCategory);
-            rowData = "";
-          }
+        size_t want = body ? min(avail, room - held) : min(avail, sizeof(chunk));
+        if (remaining > 0)
+          want = min(want, (size_t)remaining);
+
+        int n = stream->readBytes(body ? body + held : chunk, want);
+        if (n <= 0)
+          break;
+        if (body) {
+          held += n;
+        } else {
+          unsigned long parseStart = micros();
+          Tokenizer_Feed(pageTokenizer, chunk, n);
+          tokenizerUs += micros() - parseStart;
         }
+
+        if (remaining > 0)
+          remaining -= n;
+        lastData = millis();
+      }
+
+      unsigned long parseStart = micros();
+      if (body) {
+        context.mode = PAGE_SCAN;
+        Tokenizer_Begin(pageTokenizer, OnPageToken, &context);
+        Tokenizer_Feed(pageTokenizer, body, held);
+      }
+      Tokenizer_End(pageTokenizer);
+      tokenizerUs += micros() - parseStart;
+      // A held page's rows are timed when the cache has them parsed
+      Metrics_Observe(body ? METRIC_PAGE_SCAN : METRIC_PAGE_PARSE, tokenizerUs);
+
+      // The connection closed before Content-Length bytes: the rows that
+      // arrived are kept, but the page fails and is never cached
+      bool cut = remaining > 0;
+      Metrics_Add(cut ? METRIC_PAGE_ERRORS : METRIC_PAGES, 1);
+      if (cut) {
+        webdavisStats.truncated++;
+        TRACE(TRACE_PAGE_CUT, remaining, http.getSize());
+        LOG_WARN("⚠️ Page cut off, %d of %d bytes missing\n", remaining,
+                 http.getSize());
+      } else {
+        TRACE(TRACE_PAGE, Page, http.getSize());
+      }
+      // A page without a pager cannot be told apart from the one before
+      PageCache_AddPage(Page != pg && !cut ? Page : 0, held, ParseHeldPage,
+                        &context);
+      if (cut) {
+        WebDavis_End(false);
+        return HTTPC_ERROR_CONNECTION_LOST;
       }
     } else {
-      Serial.printf("POST request failed, error: %s\n",
-                    http.errorToString(httpCode).c_str());
+      Metrics_Add(METRIC_PAGE_ERRORS, 1);
+      TRACE(TRACE_PAGE_FAILED, httpCode, pg);
+      LOG_ERROR("POST request failed, error: %s\n",
+                http.errorToString(httpCode).c_str());
     }
-    http.end();
+    WebDavis_End(http.getSize() >= 0);
   } else {
     Serial.println("WiFi not connected!");
   }
+  return httpCode;
 }